@@ -0,0 +1,142 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include "benchmark.h"
+#include "../common/engine/databases/database-sqlite3.h"
+#include "../common/engine/databases/databasereadpool.h"
+#include "../common/engine/generators.h"
+#include "../common/engine/solarsystemcache.h"
+#include "../common/engine/space.h"
+#include "../common/jobsystem.h"
+
+namespace spacel {
+namespace benchmarks {
+
+class DatabaseBenchmarks
+{
+public:
+	static void Run(BenchmarkRunner &runner)
+	{
+		using namespace engine;
+		static const uint32_t SOLAR_SYSTEMS = 100 * 1000;
+		// The database setup is skipped when every benchmark is filtered out
+		bool selected = false;
+		for (const char *name: { "sqlite_bulk_write_100k", "sqlite_load_100k",
+			"sqlite_load_one_10k", "sqlite_prefetch_10k", "sqlite_prefetch_10k_pool" }) {
+			selected = selected || runner.IsSelected(name);
+		}
+
+		if (!selected) {
+			return;
+		}
+
+		UniverseGenerator::SetSeed(180);
+		UniverseGenerator::SetBackend(UNIVGEN_BACKEND_COUNTER);
+		Universe universe;
+		Galaxy *galaxy = universe.CreateGalaxy(SOLAR_SYSTEMS, 1);
+
+		// Same statements as the server universe generation, database opening included
+		runner.Run("sqlite_bulk_write_100k", SOLAR_SYSTEMS, [galaxy] {
+			const std::string path = CreateTempDir();
+			{
+				DatabaseSQLite3 db(path);
+				db.BeginBulkLoad();
+				db.BeginTransaction();
+				db.CreateGalaxy(galaxy);
+				db.CreateSolarSystems(galaxy, 0, galaxy->solar_systems.size());
+				db.CommitTransaction();
+				db.EndBulkLoad();
+			}
+			RemoveTempDir(path);
+		}, 3);
+
+		const std::string path = CreateTempDir();
+		{
+			DatabaseSQLite3 db(path);
+			db.BeginTransaction();
+			db.CreateGalaxy(galaxy);
+			db.CreateSolarSystems(galaxy, 0, galaxy->solar_systems.size());
+			db.CommitTransaction();
+
+			runner.Run("sqlite_load_100k", SOLAR_SYSTEMS, [&db] {
+				Galaxy *loaded = db.LoadGalaxy(1);
+				db.LoadSolarSystemsForGalaxy(loaded);
+				do_not_optimize(loaded->solar_systems.size());
+				delete loaded;
+			});
+
+			runner.Run("sqlite_load_one_10k", 10 * 1000, [&db, galaxy] {
+				const std::vector<uint64_t> &ids = galaxy->solar_systems.GetIds();
+				SolarSystem ss;
+				for (uint32_t i = 0; i < 10 * 1000; i++) {
+					db.LoadSolarSystem(galaxy, ids[(i * 7919) % ids.size()], &ss);
+				}
+				do_not_optimize(ss);
+			});
+
+			// Cold cache paging, on one connection then on the job system with a read pool
+			std::vector<uint64_t> prefetch_ids;
+			const std::vector<uint64_t> &ids = galaxy->solar_systems.GetIds();
+			for (uint32_t i = 0; i < 10 * 1000; i++) {
+				prefetch_ids.push_back(ids[(i * 7919) % ids.size()]);
+			}
+
+			runner.Run("sqlite_prefetch_10k", prefetch_ids.size(), [&] {
+				SolarSystemCache cache(&db, galaxy, 64 * 1024 * 1024);
+				do_not_optimize(cache.Prefetch(prefetch_ids));
+			});
+
+			DatabaseReadPool pool(path);
+			runner.Run("sqlite_prefetch_10k_pool", prefetch_ids.size(), [&] {
+				SolarSystemCache cache(&db, galaxy, 64 * 1024 * 1024);
+				cache.SetReadPool(&pool, JobSystem::instance());
+				do_not_optimize(cache.Prefetch(prefetch_ids));
+			});
+		}
+		RemoveTempDir(path);
+	}
+
+private:
+	static std::string CreateTempDir()
+	{
+		char path[] = "/tmp/spacelbench.XXXXXX";
+		if (!mkdtemp(path)) {
+			std::cerr << "Unable to create a temporary directory" << std::endl;
+			std::exit(1);
+		}
+		return path;
+	}
+
+	static void RemoveTempDir(const std::string &path)
+	{
+		for (const char *file: { "universe.db", "universe.db-journal", "universe.db-wal",
+			"universe.db-shm" }) {
+			std::remove((path + "/" + file).c_str());
+		}
+		rmdir(path.c_str());
+	}
+};
+
+}
+}
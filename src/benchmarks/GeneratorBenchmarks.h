@@ -0,0 +1,130 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "benchmark.h"
+#include "../common/engine/generators.h"
+#include "../common/engine/space.h"
+
+namespace spacel {
+namespace benchmarks {
+
+class GeneratorBenchmarks
+{
+public:
+	static void Run(BenchmarkRunner &runner)
+	{
+		using namespace engine;
+		static const GalaxyShape galaxy_shape;
+
+		UniverseGenerator::SetSeed(180);
+		const UniverseGeneratorBackend backends[] = {
+			UNIVGEN_BACKEND_MT19937,
+			UNIVGEN_BACKEND_COUNTER,
+		};
+		const char *backend_names[] = { "mt19937", "counter" };
+		// The legacy backend reseeds its generator on each call, it is much slower
+		const uint64_t backend_calls[] = { 100 * 1000, 1000 * 1000 };
+
+		for (uint8_t b = 0; b < 2; b++) {
+			UniverseGenerator::SetBackend(backends[b]);
+			const std::string prefix = std::string("univgen_") + backend_names[b] + "_";
+			const uint64_t calls = backend_calls[b];
+
+			runner.Run(prefix + "solarsystem_type", calls, [calls] {
+				uint64_t sum = 0;
+				for (uint64_t id = 1; id <= calls; id++) {
+					sum += UnivGen->generate_solarsystem_type(id);
+				}
+				do_not_optimize(sum);
+			});
+
+			runner.Run(prefix + "solarsystem_radius", calls, [calls] {
+				double sum = 0.0;
+				for (uint64_t id = 1; id <= calls; id++) {
+					sum += UnivGen->generate_solarsystem_radius(id);
+				}
+				do_not_optimize(sum);
+			});
+
+			runner.Run(prefix + "solarsystem_galaxypos", calls, [calls] {
+				double sum = 0.0, x, y, z;
+				for (uint64_t id = 1; id <= calls; id++) {
+					UnivGen->generate_solarsystem_galaxypos(id, galaxy_shape, x, y, z);
+					sum += x + y + z;
+				}
+				do_not_optimize(sum);
+			});
+
+			runner.Run(prefix + "solarsystem_name", calls / 10, [calls] {
+				size_t length = 0;
+				for (uint64_t id = 1; id <= calls / 10; id++) {
+					length += UnivGen->generate_solarsystem_name(id).size();
+				}
+				do_not_optimize(length);
+			});
+
+			runner.Run(prefix + "planet_type", calls, [calls] {
+				uint64_t sum = 0;
+				for (uint64_t id = 1; id <= calls; id++) {
+					sum += UnivGen->generate_planet_type(id);
+				}
+				do_not_optimize(sum);
+			});
+
+			runner.Run(prefix + "planet_radius", calls, [calls] {
+				double sum = 0.0;
+				for (uint64_t id = 1; id <= calls; id++) {
+					sum += UnivGen->generate_planet_radius(id, id % 4);
+				}
+				do_not_optimize(sum);
+			});
+		}
+
+		// Macrobenchmarks, on one thread to be comparable between machines
+		UniverseGenerator::SetBackend(UNIVGEN_BACKEND_COUNTER);
+		const struct
+		{
+			const char *name;
+			uint64_t solar_systems;
+			uint32_t repetitions;
+		} galaxies[] = {
+			{ "galaxy_create_10k", 10 * 1000, 0 },
+			{ "galaxy_create_100k", 100 * 1000, 0 },
+			{ "galaxy_create_1M", 1000 * 1000, 3 },
+		};
+
+		for (const auto &galaxy: galaxies) {
+			const uint64_t solar_systems = galaxy.solar_systems;
+			runner.Run(galaxy.name, solar_systems, [solar_systems] {
+				Universe universe;
+				do_not_optimize(universe.CreateGalaxy(solar_systems, 1));
+			}, galaxy.repetitions);
+		}
+
+		runner.Run("galaxy_create_1M_parallel", 1000 * 1000, [] {
+			Universe universe;
+			do_not_optimize(universe.CreateGalaxy(1000 * 1000, 0));
+		}, 3);
+	}
+};
+
+}
+}
@@ -0,0 +1,99 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "benchmark.h"
+#include "../common/engine/inventory.h"
+#include "../common/engine/objectmanager.h"
+
+namespace spacel {
+namespace benchmarks {
+
+class ObjectBenchmarks
+{
+public:
+	static void Run(BenchmarkRunner &runner)
+	{
+		using namespace engine;
+		static const uint32_t ITEMS = 10 * 1000;
+
+		runner.Run("objectmgr_register_10k", ITEMS, [] {
+			ObjectMgr objmgr;
+			for (uint32_t id = 1; id <= ITEMS; id++) {
+				objmgr.RegisterItem(CreateItemDef(id));
+			}
+			do_not_optimize(objmgr);
+		});
+
+		// Stacks query the global object manager
+		if (ObjectMgr::instance()->GetRegisteredItemsCount() == 0) {
+			for (uint32_t id = 1; id <= ITEMS; id++) {
+				ObjectMgr::instance()->RegisterItem(CreateItemDef(id));
+			}
+		}
+
+		runner.Run("objectmgr_lookup_1M", 1000 * 1000, [] {
+			uint64_t sum = 0;
+			for (uint32_t i = 0; i < 1000 * 1000; i++) {
+				sum += ObjectMgr::instance()->GetItem(1 + (i * 7919) % ITEMS)->stack_max;
+			}
+			do_not_optimize(sum);
+		});
+
+		runner.Run("inventory_fill_1k", 1000, [] {
+			Inventory inventory(1000);
+			for (uint32_t i = 0; i < 1000; i++) {
+				inventory.AddItemIntoFirstAvailableSlot(std::make_shared<ItemStack>(1 + i, 1));
+			}
+			do_not_optimize(inventory);
+		});
+
+		runner.Run("inventory_stack_100k", 100 * 1000, [] {
+			Inventory inventory(64);
+			for (uint16_t slot = 0; slot < 64; slot++) {
+				inventory.AddItem(slot, std::make_shared<ItemStack>(1 + slot, 0));
+			}
+
+			// Full stacks send the overflow back
+			uint64_t overflow = 0;
+			for (uint32_t i = 0; i < 100 * 1000; i++) {
+				const uint16_t slot = i % 64;
+				ItemStackPtr added = std::make_shared<ItemStack>(1 + slot, 1);
+				inventory.AddItem(slot, added);
+				overflow += added->GetItemCount();
+			}
+			do_not_optimize(overflow);
+		});
+	}
+
+private:
+	static engine::ItemDefPtr CreateItemDef(const uint32_t id)
+	{
+		engine::ItemDefPtr def = std::make_shared<engine::ItemDef>();
+		def->id = id;
+		def->type = engine::ITEMTYPE_RESOURCE;
+		def->name = "item_" + std::to_string(id);
+		def->stack_max = 1000;
+		return def;
+	}
+};
+
+}
+}
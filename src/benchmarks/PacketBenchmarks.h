@@ -0,0 +1,79 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "benchmark.h"
+#include "../common/engine/network/networkprotocol.h"
+
+namespace spacel {
+namespace benchmarks {
+
+class PacketBenchmarks
+{
+public:
+	static void Run(BenchmarkRunner &runner)
+	{
+		// Same layout as the legacy SMSG_GALAXY_SYSTEMS dump of a 1M solar systems galaxy:
+		// 7 writes per solar system
+		static const uint32_t SOLAR_SYSTEMS = 1000 * 1000;
+		runner.Run("packet_write_galaxy", SOLAR_SYSTEMS * 7, [] {
+			engine::network::NetworkPacket packet(engine::network::SMSG_GALAXY_SYSTEMS);
+			packet.WriteUInt(SOLAR_SYSTEMS);
+			for (uint32_t i = 0; i < SOLAR_SYSTEMS; i++) {
+				packet.WriteUInt64(i);
+				packet.WriteUByte(i % 9);
+				packet.WriteDouble(i * 1000.0);
+				packet.WriteDouble(i * 0.1);
+				packet.WriteDouble(i * 0.2);
+				packet.WriteDouble(i * 0.3);
+				packet.WriteString("Solar system");
+			}
+			do_not_optimize(packet);
+		});
+
+		engine::network::NetworkPacket packet(engine::network::SMSG_GALAXY_SYSTEMS);
+		for (uint32_t i = 0; i < SOLAR_SYSTEMS; i++) {
+			packet.WriteUInt64(i);
+			packet.WriteDouble(i * 0.1);
+		}
+
+		runner.Run("packet_read_fixed", SOLAR_SYSTEMS * 2, [&packet] {
+			packet.Seek(2);
+			double sum = 0.0;
+			for (uint32_t i = 0; i < SOLAR_SYSTEMS; i++) {
+				sum += packet.ReadUInt64();
+				sum += packet.ReadDouble();
+			}
+			do_not_optimize(sum);
+		});
+
+		runner.Run("packet_write_bytes", SOLAR_SYSTEMS, [] {
+			static const char data[32] = {};
+			engine::network::NetworkPacket packet(engine::network::SMSG_GALAXY_SYSTEMS);
+			for (uint32_t i = 0; i < SOLAR_SYSTEMS; i++) {
+				packet.Write(data, 1 + i % 32);
+			}
+			do_not_optimize(packet);
+		});
+	}
+};
+
+}
+}
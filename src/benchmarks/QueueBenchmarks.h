@@ -0,0 +1,93 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <thread>
+#include "benchmark.h"
+#include "../common/threadsafe_utils.h"
+
+namespace spacel {
+namespace benchmarks {
+
+class QueueBenchmarks
+{
+public:
+	static void Run(BenchmarkRunner &runner)
+	{
+		static const uint64_t ITEMS = 1000 * 1000;
+
+		// Producers and one consumer fighting for the queue mutex
+		for (const uint32_t producers: { 1, 4 }) {
+			runner.Run("safequeue_contention_" + std::to_string(producers) + "p", ITEMS,
+				[producers] {
+					SafeQueue<uint64_t> queue;
+					std::vector<std::thread> threads;
+					for (uint32_t p = 0; p < producers; p++) {
+						threads.emplace_back([&queue, producers] {
+							// 0 is returned by pop_front on an empty queue, push from 1
+							for (uint64_t i = 1; i <= ITEMS / producers; i++) {
+								queue.push_back(i);
+							}
+						});
+					}
+
+					uint64_t popped = 0, sum = 0;
+					while (popped < ITEMS / producers * producers) {
+						const uint64_t value = queue.pop_front();
+						if (value == 0) {
+							std::this_thread::yield();
+							continue;
+						}
+						sum += value;
+						popped++;
+					}
+
+					for (auto &thread: threads) {
+						thread.join();
+					}
+					do_not_optimize(sum);
+				});
+		}
+
+		runner.Run("spsc_queue_throughput", ITEMS, [] {
+			std::unique_ptr<SPSCQueue<uint64_t, 4096>> queue(new SPSCQueue<uint64_t, 4096>());
+			std::thread producer([&queue] {
+				for (uint64_t i = 0; i < ITEMS; i++) {
+					queue->push_back(i);
+				}
+			});
+
+			uint64_t values[64], popped = 0, sum = 0;
+			while (popped < ITEMS) {
+				const size_t count = queue->pop_front(values, 64);
+				for (size_t i = 0; i < count; i++) {
+					sum += values[i];
+				}
+				popped += count;
+			}
+
+			producer.join();
+			do_not_optimize(sum);
+		});
+	}
+};
+
+}
+}
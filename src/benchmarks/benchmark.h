@@ -0,0 +1,145 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <json/json.h>
+#include "project_defines.h"
+
+namespace spacel {
+namespace benchmarks {
+
+struct BenchmarkResult
+{
+	std::string name;
+	// Work done by one run, used to report the time per operation
+	uint64_t operations;
+	uint32_t repetitions;
+	double best_seconds;
+	double mean_seconds;
+	double worst_seconds;
+};
+
+/*
+ * Runs each benchmark several times and keeps the best, mean and worst run times.
+ * Benchmarks should use fixed seeds and inputs so results can be compared between builds
+ */
+class BenchmarkRunner
+{
+public:
+	BenchmarkRunner(const uint32_t repetitions): m_repetitions(repetitions) {}
+
+	// Only run the benchmarks whose name contains filter
+	void SetFilter(const std::string &filter) { m_filter = filter; }
+	// Benchmarks should skip their expensive setups when they are filtered out
+	const bool IsSelected(const std::string &name) const
+	{
+		return name.find(m_filter) != std::string::npos;
+	}
+
+	/*
+	 * Run fn repetitions times, 0 means the runner default. Long macrobenchmarks can
+	 * lower their repetitions
+	 */
+	template <typename Fn>
+	void Run(const std::string &name, const uint64_t operations, Fn fn,
+		const uint32_t repetitions = 0)
+	{
+		if (!IsSelected(name)) {
+			return;
+		}
+
+		BenchmarkResult result = { name, operations,
+			repetitions ? std::min(repetitions, m_repetitions) : m_repetitions, 0.0, 0.0, 0.0 };
+		for (uint32_t i = 0; i < result.repetitions; i++) {
+			const auto start = std::chrono::steady_clock::now();
+			fn();
+			const double seconds = std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start).count();
+			result.best_seconds = i == 0 ? seconds : std::min(result.best_seconds, seconds);
+			result.worst_seconds = std::max(result.worst_seconds, seconds);
+			result.mean_seconds += seconds / result.repetitions;
+		}
+
+		std::cout << name << ": best " << result.best_seconds * 1000.0 << " ms, mean " <<
+			result.mean_seconds * 1000.0 << " ms, " <<
+			result.best_seconds * 1e9 / std::max<uint64_t>(operations, 1) << " ns/op" <<
+			std::endl;
+		m_results.push_back(result);
+	}
+
+	const std::vector<BenchmarkResult> &GetResults() const { return m_results; }
+
+	// Results with the build version, to be compared between releases
+	void WriteJSON(std::ostream &os) const
+	{
+		Json::Value root;
+		root["version_patch"] = PROJECT_VERSION_PATCH;
+		root["protocol_version"] = PROTOCOL_VERSION;
+		root["compiler"] = __VERSION__;
+		root["timestamp"] = (Json::UInt64) std::time(nullptr);
+		root["repetitions"] = m_repetitions;
+
+		Json::Value results(Json::arrayValue);
+		for (const BenchmarkResult &result: m_results) {
+			Json::Value json_result;
+			json_result["name"] = result.name;
+			json_result["operations"] = (Json::UInt64) result.operations;
+			json_result["repetitions"] = result.repetitions;
+			json_result["best_ns"] = result.best_seconds * 1e9;
+			json_result["mean_ns"] = result.mean_seconds * 1e9;
+			json_result["worst_ns"] = result.worst_seconds * 1e9;
+			json_result["ns_per_op"] = result.best_seconds * 1e9 /
+				std::max<uint64_t>(result.operations, 1);
+			results.append(json_result);
+		}
+		root["benchmarks"] = results;
+
+		Json::StreamWriterBuilder builder;
+		builder["indentation"] = "\t";
+		std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+		writer->write(root, &os);
+		os << std::endl;
+	}
+
+private:
+	uint32_t m_repetitions;
+	std::string m_filter = "";
+	std::vector<BenchmarkResult> m_results;
+};
+
+/*
+ * Keep the compiler from optimizing benchmarked work away
+ */
+template <typename T>
+inline void do_not_optimize(const T &value)
+{
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+}
+}
@@ -0,0 +1,88 @@
+#include <getopt.h>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <common/engine/generators.h>
+#include <common/engine/objectmanager.h>
+#include <common/engine/space.h>
+#include "benchmark.h"
+#include "DatabaseBenchmarks.h"
+#include "GeneratorBenchmarks.h"
+#include "ObjectBenchmarks.h"
+#include "PacketBenchmarks.h"
+#include "QueueBenchmarks.h"
+
+namespace spacel {
+
+// Init singletons
+engine::Universe *engine::Universe::s_universe = nullptr;
+engine::ObjectMgr *engine::ObjectMgr::s_objmgr = nullptr;
+engine::UniverseGenerator *engine::UniverseGenerator::s_univgen = nullptr;
+uint64_t engine::UniverseGenerator::s_seed = 0;
+engine::UniverseGeneratorBackend engine::UniverseGenerator::s_backend =
+	engine::UNIVGEN_BACKEND_COUNTER;
+
+}
+
+static void print_usage(const char *program)
+{
+	std::cout << "Usage: " << program << " [options]" << std::endl
+		<< "  --json PATH          Also write the results to this JSON file" << std::endl
+		<< "  --filter TEXT        Only run the benchmarks whose name contains TEXT" << std::endl
+		<< "  --repetitions N      Runs of each benchmark, the best one is kept (default: 5)" << std::endl
+		<< "  --help               Show this help" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+	static const option long_options[] = {
+		{ "json", required_argument, nullptr, 'j' },
+		{ "filter", required_argument, nullptr, 'f' },
+		{ "repetitions", required_argument, nullptr, 'r' },
+		{ "help", no_argument, nullptr, 'h' },
+		{ nullptr, 0, nullptr, 0 },
+	};
+
+	std::string json_path = "", filter = "";
+	uint32_t repetitions = 5;
+	int opt;
+	while ((opt = getopt_long(argc, argv, "j:f:r:h", long_options, nullptr)) != -1) {
+		switch (opt) {
+			case 'j': json_path = optarg; break;
+			case 'f': filter = optarg; break;
+			case 'r': repetitions = strtoul(optarg, nullptr, 10); break;
+			case 'h':
+				print_usage(argv[0]);
+				return 0;
+			default:
+				print_usage(argv[0]);
+				return 1;
+		}
+	}
+
+	if (repetitions == 0) {
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	spacel::benchmarks::BenchmarkRunner runner(repetitions);
+	runner.SetFilter(filter);
+
+	std::cout << "Running the benchmarks." << std::endl;
+	spacel::benchmarks::GeneratorBenchmarks::Run(runner);
+	spacel::benchmarks::PacketBenchmarks::Run(runner);
+	spacel::benchmarks::QueueBenchmarks::Run(runner);
+	spacel::benchmarks::DatabaseBenchmarks::Run(runner);
+	spacel::benchmarks::ObjectBenchmarks::Run(runner);
+
+	if (!json_path.empty()) {
+		std::ofstream json_file(json_path);
+		if (!json_file.good()) {
+			std::cerr << "Unable to write the results to " << json_path << std::endl;
+			return 1;
+		}
+		runner.WriteJSON(json_file);
+	}
+
+	return 0;
+}
@@ -22,19 +22,27 @@
 #include "project_defines.h"
 #include "player.h"
 #include <Urho3D/IO/Log.h>
+#include <common/engine/generators.h>
+#include <common/engine/network/localmessages.h>
+#include <common/engine/network/packetpool.h>
 #include <common/engine/server.h>
-#include <thread>
 #include <cassert>
+#include <fstream>
+#include <sstream>
+#include <thread>
 
 namespace spacel {
 
 using namespace engine::network;
 
-#define CLIENT_LOOP_TIME 0.025f
+#define CLIENT_TICK_RATE 40
+#define CLIENT_PACKET_BATCH_SIZE 64
 
-Client::Client()
+Client::Client():
+	m_tick_scheduler(CLIENT_TICK_RATE)
 {
 	m_loading_step = CLIENTLOADINGSTEP_NOT_STARTED;
+	m_server_loading_progress = 0.0f;
 }
 
 Client::~Client()
@@ -53,29 +61,18 @@ void Client::ThreadFunction()
 		return;
 	}
 
-	float dtime = 0.0f;
+	const float dtime = m_tick_scheduler.GetTickInterval();
+	uint64_t dropped_ticks = 0;
 	while (shouldRun_) {
-		const auto prev_time = std::chrono::system_clock::now();
+		// Notified on received packets and UI events, they are handled without waiting
+		// for the next tick
+		m_tick_scheduler.Wait();
 		Step(dtime);
-		const auto step_time = std::chrono::system_clock::now().time_since_epoch() -
-				prev_time.time_since_epoch();
-
-		// runtime is a float sec time
-		float runtime =
-			std::chrono::duration_cast<std::chrono::milliseconds>(step_time).count() /
-			1000.0f;
-
-		// If step runtime < LOOP TIME, sleep for the diff time
-		if (runtime < CLIENT_LOOP_TIME) {
-			// Convert back to ms from s
-			std::this_thread::sleep_for(std::chrono::milliseconds(
-				(uint32_t) ((CLIENT_LOOP_TIME - runtime) * 1000.0f)));
-			dtime = CLIENT_LOOP_TIME;
-		}
-		else {
-			URHO3D_LOGWARNINGF("Server thread lagging. Runtime %f > %f",
-							   runtime, CLIENT_LOOP_TIME);
-			dtime = runtime;
+
+		if (m_tick_scheduler.GetDroppedTicks() != dropped_ticks) {
+			URHO3D_LOGWARNINGF("Client thread lagging, %d ticks dropped",
+				(int) (m_tick_scheduler.GetDroppedTicks() - dropped_ticks));
+			dropped_ticks = m_tick_scheduler.GetDroppedTicks();
 		}
 	}
 
@@ -88,10 +85,13 @@ bool Client::InitClient()
 
 	if (m_singleplayer_mode) {
 		m_server = new engine::Server(m_gamedata_path, m_data_path, m_universe_name);
+		m_server->SetPacketListener([this] { m_tick_scheduler.Notify(); });
+		m_server->SetSinglePlayerMode(true);
 		m_server->Run();
 
 		// Wait for server to be up
 		while (m_server->GetLoadingStep() < engine::SERVERLOADINGSTEP_STARTED) {
+			m_server_loading_progress = m_server->GetLoadingProgress();
 			std::this_thread::sleep_for(std::chrono::milliseconds(10));
 		}
 
@@ -114,29 +114,45 @@ bool Client::InitClient()
  */
 void Client::Step(const float dtime)
 {
+	PROFILE_SCOPE(m_profiler, "client_step");
+	m_profiler.RecordCounter("receive_queue_depth", m_packet_receive_queue.size());
+
+	NetworkPacket *packets[CLIENT_PACKET_BATCH_SIZE];
+	size_t packet_count;
 	// Singleplayer mode read server queue instead of client receive queue
+	const uint64_t drain_start = m_profiler.GetTime();
 	if (m_singleplayer_mode) {
 		assert(m_server);
 
-		while (!m_server->IsSendingQueueEmpty()) {
-			std::unique_ptr<NetworkPacket> pkt(m_server->PopSendingQueue());
-			pkt->Seek(2);
-			ProcessPacket(pkt.get());
+		while ((packet_count = m_server->PopSendingQueue(packets,
+			CLIENT_PACKET_BATCH_SIZE)) > 0) {
+			for (size_t i = 0; i < packet_count; i++) {
+				NetworkPacketPtr pkt(packets[i]);
+				pkt->Seek(2);
+				ProcessPacket(pkt.get());
+			}
 		}
 	}
 	else {
-		while (!m_packet_receive_queue.empty()) {
-			std::unique_ptr<NetworkPacket> pkt(m_packet_receive_queue.pop_front());
-			ProcessPacket(pkt.get());
+		while ((packet_count = m_packet_receive_queue.pop_front(packets,
+			CLIENT_PACKET_BATCH_SIZE)) > 0) {
+			for (size_t i = 0; i < packet_count; i++) {
+				NetworkPacketPtr pkt(packets[i]);
+				ProcessPacket(pkt.get());
+			}
 		}
 	}
 
+	m_profiler.RecordScope("packet_drain", drain_start, m_profiler.GetTime());
+
 	{
+		PROFILE_SCOPE(m_profiler, "ui_events");
 		static const uint8_t MAX_CLIENT_UI_EVENT_TO_PROCESS = 20;
-		uint8_t i = 0;
-		while (!m_clientui_event_queue.empty() && i < MAX_CLIENT_UI_EVENT_TO_PROCESS) {
-			i++;
-			ClientUIEventPtr event = m_clientui_event_queue.pop_front();
+		ClientUIEventPtr events[MAX_CLIENT_UI_EVENT_TO_PROCESS];
+		const size_t event_count = m_clientui_event_queue.pop_front(events,
+			MAX_CLIENT_UI_EVENT_TO_PROCESS);
+		for (size_t i = 0; i < event_count; i++) {
+			const ClientUIEventPtr &event = events[i];
 			assert(event->id < CLIENT_UI_EVENT_MAX);
 
 			const ClientUIEventHandler &eventHandler = ClientUIEventHandlerTable[event->id];
@@ -164,7 +180,11 @@ void Client::ProcessPacket(NetworkPacket *packet)
 inline void Client::RoutePacket(NetworkPacket *packet)
 {
 	const CMsgHandler &opHandle = cmsgHandlerTable[packet->GetOpcode()];
+	const uint64_t start = m_profiler.GetTime();
 	(this->*opHandle.handler)(packet);
+	const uint64_t end = m_profiler.GetTime();
+	m_profiler.RecordScope(opHandle.name, start, end);
+	m_router_metrics.Record(packet->GetOpcode(), opHandle.name, packet->GetSize(), end - start);
 }
 
 void Client::SendPacket(NetworkPacket *packet)
@@ -176,6 +196,47 @@ void Client::SendPacket(NetworkPacket *packet)
 	// @TODO network else
 }
 
+void Client::DumpProfiles(const std::string &path_prefix) const
+{
+	struct ProfileDump
+	{
+		const char *name;
+		const Profiler *profiler;
+	};
+
+	const ProfileDump dumps[] = {
+		{ "client", &m_profiler },
+		{ "server", m_server ? &m_server->GetProfiler() : nullptr },
+	};
+
+	for (const ProfileDump &dump: dumps) {
+		if (!dump.profiler) {
+			continue;
+		}
+
+		const std::string path = path_prefix + dump.name + ".json";
+		std::ofstream trace_file(path, std::ofstream::binary);
+		if (!trace_file.good()) {
+			URHO3D_LOGERRORF("Unable to write the %s trace to %s", dump.name, path.c_str());
+			continue;
+		}
+		dump.profiler->WriteChromeTrace(trace_file);
+
+		std::ostringstream stats;
+		dump.profiler->WriteStats(stats);
+		URHO3D_LOGINFOF("%s profile written to %s\n%s", dump.name, path.c_str(),
+			stats.str().c_str());
+	}
+
+	std::ostringstream report;
+	m_router_metrics.WriteReport(report);
+	if (m_server) {
+		report << "Server" << std::endl;
+		m_server->GetRouterMetrics().WriteReport(report);
+	}
+	URHO3D_LOGINFOF("Packets routed by the client\n%s", report.str().c_str());
+}
+
 void Client::handlePacket_Hello(NetworkPacket *packet)
 {
 	uint8_t major_version = packet->ReadUByte(),
@@ -184,9 +245,27 @@ void Client::handlePacket_Hello(NetworkPacket *packet)
 	URHO3D_LOGINFOF("Server version %d.%d.%d (proto %d) respond us hello",
 		major_version, minor_version, patch_version, protocol_version);
 
+	// Older servers don't send the derived names flag
+	if (!packet->IsEof() && packet->ReadBool()) {
+		const uint64_t seed = packet->ReadUInt64();
+		const uint8_t backend = packet->ReadUByte();
+		if (backend >= engine::UNIVGEN_BACKEND_COUNT) {
+			URHO3D_LOGERRORF("Server uses an unknown universe generator (%d)", backend);
+			m_loading_step = CLIENTLOADINGSTEP_FAILED;
+			return;
+		}
+
+		engine::UniverseGenerator::SetSeed(seed);
+		engine::UniverseGenerator::SetBackend((engine::UniverseGeneratorBackend) backend);
+	}
+
 	m_loading_step = CLIENTLOADINGSTEP_CONNECTED;
 
-	NetworkPacket *resp_packet = new NetworkPacket(CMSG_AUTH);
+	// New session, the server streams the galaxy again
+	m_solar_systems.Clear();
+	m_galaxy_names.Clear();
+
+	NetworkPacket *resp_packet = PacketPool::instance()->Acquire(CMSG_AUTH);
 	resp_packet->WriteString("singleplayer");
 	resp_packet->WriteString("singleplayer_default");
 	SendPacket(resp_packet);
@@ -204,26 +283,65 @@ void Client::handlePacket_Chat(NetworkPacket *packet)
 
 void Client::handlePacket_GalaxySystems(NetworkPacket *packet)
 {
-	// When receive this packet we should clear received solar systems
-	for (auto &ss: m_solar_systems) {
-		delete ss.second;
+	// Server streams solar systems around the player, add them to the known ones
+	if (const GalaxySystemsMessage *message = packet->GetLocalMessage<GalaxySystemsMessage>()) {
+		for (const GalaxySystemEntry &entry: message->systems) {
+			uint32_t row;
+			if (!m_solar_systems.Find(entry.id, row)) {
+				row = m_solar_systems.Add(entry.id);
+			}
+
+			m_solar_systems.Set(row, entry.type, entry.radius, entry.pos_x, entry.pos_y,
+				entry.pos_z);
+			m_solar_systems.SetName(row, entry.name);
+		}
+
+		URHO3D_LOGDEBUGF("Received %d solar systems from local server",
+			(int) message->systems.size());
+		return;
+	}
+
+	uint32_t ss_number = packet->ReadUInt();
+	for (uint32_t i = 0; i < ss_number; i++) {
+		const uint64_t ss_id = packet->ReadUInt64();
+		uint32_t row;
+		if (!m_solar_systems.Find(ss_id, row)) {
+			row = m_solar_systems.Add(ss_id);
+		}
+
+		const engine::SolarType type = (engine::SolarType) packet->ReadUByte();
+		const double radius = packet->ReadDouble();
+		const double pos_x = packet->ReadDouble();
+		const double pos_y = packet->ReadDouble();
+		const double pos_z = packet->ReadDouble();
+		m_solar_systems.Set(row, type, radius, pos_x, pos_y, pos_z);
+		m_solar_systems.SetName(row, std::string(packet->ReadString().CString()));
+	}
+
+	URHO3D_LOGDEBUGF("Received %d solar systems from server", ss_number);
+}
+
+void Client::handlePacket_GalaxySystemsRemove(NetworkPacket *packet)
+{
+	if (const GalaxySystemsRemoveMessage *message =
+		packet->GetLocalMessage<GalaxySystemsRemoveMessage>()) {
+		for (const uint64_t &id: message->ids) {
+			m_solar_systems.Remove(id);
+		}
+		return;
 	}
-	m_solar_systems.clear();
 
 	uint32_t ss_number = packet->ReadUInt();
 	for (uint32_t i = 0; i < ss_number; i++) {
-		engine::SolarSystem *ss = new engine::SolarSystem();
-		ss->id = packet->ReadUInt64();
-		ss->type = (engine::SolarType) packet->ReadUByte();
-		ss->radius = packet->ReadDouble();
-		ss->pos_x = packet->ReadDouble();
-		ss->pos_y = packet->ReadDouble();
-		ss->pos_z = packet->ReadDouble();
-		ss->name = std::string(packet->ReadString().CString());
-		m_solar_systems[ss->id] = ss;
+		m_solar_systems.Remove(packet->ReadUInt64());
 	}
+}
 
-	URHO3D_LOGINFOF("Received %d solar systems from server", ss_number);
+void Client::handlePacket_GalaxySystemsCompact(NetworkPacket *packet)
+{
+	const uint32_t ss_number = read_galaxy_systems_compact(packet, m_solar_systems,
+		m_galaxy_names);
+	URHO3D_LOGDEBUGF("Received %d compact solar systems from server", ss_number);
 }
 
 void Client::handlePacket_CharacterList(NetworkPacket *packet)
@@ -264,7 +382,7 @@ void Client::handlePacket_Kick(NetworkPacket *packet)
 
 void Client::SendInitPacket()
 {
-	NetworkPacket *pkt = new NetworkPacket(CMSG_HELLO);
+	NetworkPacket *pkt = PacketPool::instance()->Acquire(CMSG_HELLO);
 	pkt->WriteUByte(0);
 	pkt->WriteUByte(0);
 	pkt->WriteUByte(PROJECT_VERSION_PATCH);
@@ -277,20 +395,39 @@ void Client::handleClientUiEvent_ChararacterAdd(ClientUIEventPtr event)
 	ClientUIEvent_CharacterAdd *r_event = dynamic_cast<ClientUIEvent_CharacterAdd *>(event.get());
 	assert(r_event);
 
-	NetworkPacket *pkt = new NetworkPacket(CMSG_CHARACTER_CREATE);
+	NetworkPacket *pkt = PacketPool::instance()->Acquire(CMSG_CHARACTER_CREATE);
 	pkt->WriteUByte(r_event->race);
 	pkt->WriteUByte(r_event->sex);
 	pkt->WriteString(r_event->name);
 	SendPacket(pkt);
 }
 
+void Client::handleClientUiEvent_GalaxyPosition(ClientUIEventPtr event)
+{
+	ClientUIEvent_GalaxyPosition *r_event = dynamic_cast<ClientUIEvent_GalaxyPosition *>(event.get());
+	assert(r_event);
+
+	if (m_singleplayer_mode) {
+		SendPacket(make_local_packet(CMSG_PLAYER_POSITION, std::make_shared<PlayerPositionMessage>(
+			r_event->pos_x, r_event->pos_y, r_event->pos_z)));
+		return;
+	}
+
+	NetworkPacket *pkt = PacketPool::instance()->Acquire(CMSG_PLAYER_POSITION);
+	pkt->WriteDouble(r_event->pos_x);
+	pkt->WriteDouble(r_event->pos_y);
+	pkt->WriteDouble(r_event->pos_z);
+	SendPacket(pkt);
+}
+
 void Client::handleClientUiEvent_ChararacterRemove(ClientUIEventPtr event)
 {
 	ClientUIEvent_CharacterRemove *r_event = dynamic_cast<ClientUIEvent_CharacterRemove *>(event.get());
 	assert(r_event);
 
-	NetworkPacket *pkt = new NetworkPacket(CMSG_CHARACTER_REMOVE);
+	NetworkPacket *pkt = PacketPool::instance()->Acquire(CMSG_CHARACTER_REMOVE);
 	pkt->WriteUInt64(r_event->guid);
+	SendPacket(pkt);
 }
 
 }
@@ -22,8 +22,12 @@
 #include <atomic>
 #include <Urho3D/Core/Thread.h>
 #include <queue>
+#include <common/profiler.h>
 #include <common/threadsafe_utils.h>
+#include <common/time_utils.h>
+#include <common/engine/network/galaxyencoding.h>
 #include <common/engine/network/networkprotocol.h>
+#include <common/engine/network/opcodemetrics.h>
 #include <common/engine/space.h>
 #include "spacelgame.h"
 
@@ -31,6 +35,9 @@ namespace spacel {
 
 using namespace engine::network;
 
+// Packet queues capacity, producers wait when a queue is full
+#define CLIENT_PACKET_QUEUE_SIZE 1024
+
 enum ClientLoadingStep {
 	CLIENTLOADINGSTEP_NOT_STARTED = 0,
 	CLIENTLOADINGSTEP_BEGIN_START,
@@ -51,6 +58,8 @@ public:
 
 	void ThreadFunction();
 	inline const ClientLoadingStep GetLoadingStep() const { return m_loading_step; }
+	// Progression of the singleplayer server loading step, between 0 and 1
+	inline const float GetServerLoadingProgress() const { return m_server_loading_progress; }
 	bool InitClient();
 
 	inline static Client *instance()
@@ -76,15 +85,25 @@ public:
 	void SetDataPath(const std::string &data_path) { m_data_path = data_path; }
 	void SetUIEventHandler(SpacelGame *event_handler) { m_ui_event_handler = event_handler; }
 
+	/*
+	 * Write the Chrome traces of the client and of the singleplayer server as
+	 * <path_prefix>client.json and <path_prefix>server.json, and log their stats and
+	 * packet router metrics
+	 */
+	void DumpProfiles(const std::string &path_prefix) const;
+
 	void ReceivePacket(NetworkPacket *packet)
 	{
 		m_packet_receive_queue.push_back(packet);
+		m_tick_scheduler.Notify();
 	}
 
 	void handlePacket_Null(engine::network::NetworkPacket *packet) {}
 	void handlePacket_Hello(engine::network::NetworkPacket *packet);
 	void handlePacket_Chat(engine::network::NetworkPacket *packet);
 	void handlePacket_GalaxySystems(engine::network::NetworkPacket *packet);
+	void handlePacket_GalaxySystemsRemove(engine::network::NetworkPacket *packet);
+	void handlePacket_GalaxySystemsCompact(engine::network::NetworkPacket *packet);
 	void handlePacket_Auth(engine::network::NetworkPacket *packet);
 	void handlePacket_CharacterList(engine::network::NetworkPacket *packet);
 	void handlePacket_CharacterCreate(engine::network::NetworkPacket *packet);
@@ -95,10 +114,12 @@ public:
 	void QueueClientUiEvent(ClientUIEventPtr e)
 	{
 		m_clientui_event_queue.push_back(e);
+		m_tick_scheduler.Notify();
 	}
 
 	void handleClientUiEvent_ChararacterAdd(ClientUIEventPtr event);
 	void handleClientUiEvent_ChararacterRemove(ClientUIEventPtr event);
+	void handleClientUiEvent_GalaxyPosition(ClientUIEventPtr event);
 private:
 	void Step(const float dtime);
 	void ProcessPacket(engine::network::NetworkPacket *packet);
@@ -116,6 +137,8 @@ private:
 
 	static Client *s_client;
 	std::atomic<ClientLoadingStep> m_loading_step;
+	// Copied from the singleplayer server while the client waits for it
+	std::atomic<float> m_server_loading_progress;
 	SessionState m_state = SESSION_STATE_NONE;
 
 	bool m_singleplayer_mode = false;
@@ -126,11 +149,16 @@ private:
 
 	engine::Server *m_server = nullptr;
 
-	SafeQueue<engine::network::NetworkPacket *> m_packet_sending_queue;
-	SafeQueue<engine::network::NetworkPacket *> m_packet_receive_queue;
+	// Filled by the network thread
+	SPSCQueue<engine::network::NetworkPacket *, CLIENT_PACKET_QUEUE_SIZE> m_packet_receive_queue;
 
 	ClientUIEventQueue m_clientui_event_queue;
+	TickScheduler m_tick_scheduler;
+	Profiler m_profiler;
+	engine::network::PacketRouterMetrics m_router_metrics;
 
-	engine::SolarSystemMap m_solar_systems;
+	engine::SolarSystemTable m_solar_systems;
+	// Solar system names sent by the server in this session
+	engine::network::GalaxyNameDictionary m_galaxy_names;
 };
 }
@@ -279,6 +279,13 @@ void Game::HandleKeyDown(StringHash eventType, VariantMap &eventData)
 			}
 			break;
 		}
+		case KEY_F8:
+			// Client and server tick profiles, next to the screenshots
+			Client::instance()->DumpProfiles(std::string(GetSubsystem<FileSystem>()->
+				GetAppPreferencesDir("spacel", "profiles").CString()) + "Profile_" +
+				Time::GetTimeStamp().Replaced(':', '_').Replaced('.', '_')
+					.Replaced(' ', '_').CString() + "_");
+			break;
 		case KEY_F9:
 			GetSubsystem<Console>()->Toggle();
 			break;
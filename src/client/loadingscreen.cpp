@@ -154,6 +154,10 @@ void LoadingScreen::HandleUpdate(StringHash, VariantMap &eventData)
 		m_last_loading_step = loading_step;
 	}
 
+	// The singleplayer server loads or generates the universe during this step
+	if (loading_step == CLIENTLOADINGSTEP_BEGIN_START) {
+		m_progress_bar->SetValue(5 + 5 * Client::instance()->GetServerLoadingProgress());
+	}
 }
 
 void LoadingScreen::LaunchGame()
@@ -333,8 +333,26 @@ void MainMenu::HandleLaunchGamePressed(StringHash, VariantMap &eventData)
 			GetSubsystem<FileSystem>()->CreateDir(path_universe);
 		}
 
-		engine::DatabaseSQLite3 game_database(std::string(path_universe.CString()));
-		game_database.CreateUniverse(std::string(universe_name.CString()), seed);
+		// Create the universe database on the job system, the menu stays responsive
+		const std::string path(path_universe.CString()), name(universe_name.CString());
+		async_then(*JobSystem::instance(), [path, name, seed] {
+			try {
+				engine::DatabaseSQLite3 game_database(path);
+				game_database.CreateUniverse(name, seed);
+			}
+			catch (engine::SQLiteException &e) {
+				URHO3D_LOGERROR(e.what());
+				return false;
+			}
+			return true;
+		}, m_main->GetCallbackQueue(), [this, name] (bool created) {
+			if (!created) {
+				ShowErrorBubble(m_l10n->Get("Unable to create the universe"));
+				return;
+			}
+			m_main->ChangeGameGlobalUI(GLOBALUI_LOADINGSCREEN, (void *)name.c_str());
+		});
+		return;
 	} else if (universe_name.Empty()) {
 		ShowErrorBubble(m_l10n->Get("You must select a universe."));
 		URHO3D_LOGERROR("No universe selected when loading.");
@@ -40,6 +40,9 @@ const CMsgHandler cmsgHandlerTable[MSG_MAX] = {
 	null_command_handler,
 	{"SMSG_KICK", SESSION_STATE_AUTHED, &Client::handlePacket_Kick},
 	{"SMSG_GALAXY_SYSTEMS", SESSION_STATE_AUTHED, &Client::handlePacket_GalaxySystems},
+	null_command_handler,
+	{"SMSG_GALAXY_SYSTEMS_REMOVE", SESSION_STATE_AUTHED, &Client::handlePacket_GalaxySystemsRemove},
+	{"SMSG_GALAXY_SYSTEMS_COMPACT", SESSION_STATE_AUTHED, &Client::handlePacket_GalaxySystemsCompact},
 };
 }
 }
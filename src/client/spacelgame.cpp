@@ -54,6 +54,8 @@ engine::Universe *engine::Universe::s_universe = nullptr;
 engine::ObjectMgr *engine::ObjectMgr::s_objmgr = nullptr;
 engine::UniverseGenerator *engine::UniverseGenerator::s_univgen = nullptr;
 uint64_t engine::UniverseGenerator::s_seed = 0;
+engine::UniverseGeneratorBackend engine::UniverseGenerator::s_backend =
+	engine::UNIVGEN_BACKEND_COUNTER;
 Client *Client::s_client = nullptr;
 
 void SpacelGame::Setup()
@@ -154,10 +156,10 @@ void SpacelGame::HandleBeginFrame(StringHash, VariantMap &eventData)
 {
 	{
 		static const uint8_t MAX_UI_EVENT_ITERATIONS = 5;
-		uint8_t i = 0;
-		while (!m_ui_event_queue.empty() && i < MAX_UI_EVENT_ITERATIONS) {
-			i++;
-			UIEventPtr event = m_ui_event_queue.pop_front();
+		UIEventPtr events[MAX_UI_EVENT_ITERATIONS];
+		const size_t event_count = m_ui_event_queue.pop_front(events, MAX_UI_EVENT_ITERATIONS);
+		for (size_t i = 0; i < event_count; i++) {
+			const UIEventPtr &event = events[i];
 
 			// Invalid event, ignore it
 			if (event->id >= UI_EVENT_MAX) {
@@ -169,6 +171,8 @@ void SpacelGame::HandleBeginFrame(StringHash, VariantMap &eventData)
 			(this->*eventHandle.handler)(event);
 		}
 	}
+
+	m_callbacks.RunPending();
 }
 
 void SpacelGame::HandleCharacterList(UIEventPtr event)
@@ -24,6 +24,7 @@
 #include <Urho3D/IO/Log.h>
 #include <Urho3D/Resource/ResourceCache.h>
 
+#include <common/jobsystem.h>
 #include "settings.h"
 #include "uievents.h"
 
@@ -63,11 +64,15 @@ public:
 
 	void QueueClientUIEvent(ClientUIEvent *event);
 
+	// Job results are handed back to the UI thread through this queue, see async_then
+	CallbackQueue &GetCallbackQueue() { return m_callbacks; }
+
 private:
 	void InitLocales();
 
 	ClientSettings *m_config = nullptr;
 	UIEventQueue m_ui_event_queue;
+	CallbackQueue m_callbacks;
 };
 
 }
@@ -31,5 +31,6 @@ const UIEventHandler UIEventHandlerTable[UI_EVENT_MAX] = {
 const ClientUIEventHandler ClientUIEventHandlerTable[CLIENT_UI_EVENT_MAX] = {
 	&Client::handleClientUiEvent_ChararacterAdd,
 	&Client::handleClientUiEvent_ChararacterRemove,
+	&Client::handleClientUiEvent_GalaxyPosition,
 };
 }
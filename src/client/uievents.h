@@ -59,7 +59,8 @@ struct UIEventHandler
 extern const UIEventHandler UIEventHandlerTable[UI_EVENT_MAX];
 
 
-typedef SafeQueue<UIEventPtr> UIEventQueue;
+// Events are queued by the client thread and other UI components
+typedef MPSCQueue<UIEventPtr, 256> UIEventQueue;
 
 /*
  * UI -> Client
@@ -67,6 +68,7 @@ typedef SafeQueue<UIEventPtr> UIEventQueue;
 enum ClientUIEventID {
 	CLIENT_UI_EVENT_CHARACTER_ADD,
 	CLIENT_UI_EVENT_CHARACTER_REMOVE,
+	CLIENT_UI_EVENT_GALAXY_POSITION,
 	CLIENT_UI_EVENT_MAX,
 };
 
@@ -88,6 +90,10 @@ struct ClientUIEvent_CharacterRemove: public ClientUIEvent {
 	ClientUIEvent_CharacterRemove(): ClientUIEvent(CLIENT_UI_EVENT_CHARACTER_REMOVE) {}
 	uint64_t guid;
 };
+struct ClientUIEvent_GalaxyPosition: public ClientUIEvent {
+	ClientUIEvent_GalaxyPosition(): ClientUIEvent(CLIENT_UI_EVENT_GALAXY_POSITION) {}
+	double pos_x, pos_y, pos_z;
+};
 
 struct ClientUIEventHandler
 {
@@ -95,7 +101,8 @@ struct ClientUIEventHandler
 };
 
 extern const ClientUIEventHandler ClientUIEventHandlerTable[CLIENT_UI_EVENT_MAX];
-typedef SafeQueue<ClientUIEventPtr> ClientUIEventQueue;
+// Events are only queued by the UI thread
+typedef SPSCQueue<ClientUIEventPtr, 256> ClientUIEventQueue;
 
 
 }
@@ -0,0 +1,131 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "macro_utils.h"
+
+namespace spacel {
+
+/*
+ * Monotonic arena: objects are bump allocated into big blocks and are never freed
+ * individually. Release destroys every non trivial object created with Create and frees
+ * all blocks at once.
+ * This is not thread safe
+ */
+class MonotonicArena
+{
+public:
+	MonotonicArena(const size_t block_size = 64 * 1024): m_block_size(block_size) {}
+	~MonotonicArena() { Release(); }
+
+	void *Allocate(const size_t size, const size_t alignment = alignof(std::max_align_t))
+	{
+		uintptr_t ptr = (m_current + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		if (ptr + size > m_end) {
+			// Oversized objects get their own block, the current block is kept
+			const size_t block_size = std::max(m_block_size, size + alignment);
+			char *block = static_cast<char *>(std::malloc(block_size));
+			if (!block) {
+				throw std::bad_alloc();
+			}
+
+			m_blocks.push_back(block);
+			m_allocated_size += block_size;
+			ptr = ((uintptr_t) block + alignment - 1) & ~(uintptr_t)(alignment - 1);
+			if (block_size > m_block_size) {
+				return (void *) ptr;
+			}
+
+			m_end = (uintptr_t) block + block_size;
+		}
+
+		m_current = ptr + size;
+		return (void *) ptr;
+	}
+
+	template <typename T, typename... Args>
+	T *Create(Args &&... args)
+	{
+		// Reserve the destructor node first, if the constructor throws it's only lost space
+		DestructorNode *node = nullptr;
+		if (!std::is_trivially_destructible<T>::value) {
+			node = static_cast<DestructorNode *>(
+				Allocate(sizeof(DestructorNode), alignof(DestructorNode)));
+		}
+
+		T *object = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		if (node) {
+			node->object = object;
+			node->destroy = [](void *p) { static_cast<T *>(p)->~T(); };
+			node->next = m_destructors;
+			m_destructors = node;
+		}
+
+		return object;
+	}
+
+	/*
+	 * Destroy objects in reverse creation order and free every block
+	 */
+	void Release()
+	{
+		for (DestructorNode *node = m_destructors; node; node = node->next) {
+			node->destroy(node->object);
+		}
+
+		for (char *block: m_blocks) {
+			std::free(block);
+		}
+
+		m_destructors = nullptr;
+		m_blocks.clear();
+		m_current = 0;
+		m_end = 0;
+		m_allocated_size = 0;
+	}
+
+	const size_t GetAllocatedSize() const { return m_allocated_size; }
+
+private:
+	DISABLE_CLASS_COPY(MonotonicArena);
+
+	struct DestructorNode
+	{
+		void *object;
+		void (*destroy)(void *);
+		DestructorNode *next;
+	};
+
+	size_t m_block_size;
+	std::vector<char *> m_blocks;
+	uintptr_t m_current = 0;
+	uintptr_t m_end = 0;
+	size_t m_allocated_size = 0;
+	DestructorNode *m_destructors = nullptr;
+};
+}
@@ -22,6 +22,7 @@
 #include "porting.h"
 #include "database-sqlite3.h"
 #include "time_utils.h"
+#include "../../engine/generators.h"
 #include "../../engine/space.h"
 
 namespace spacel {
@@ -30,25 +31,39 @@ namespace engine {
 static const char *stmt_list[SQLITE3STMT_COUNT] = {
 		"BEGIN",
 		"END",
+		"ROLLBACK",
 		"INSERT INTO galaxies(galaxy_id, galaxy_name, pos_x, pos_y, pos_z) VALUES (?, ?, ?, ?, ?)",
 		"SELECT `galaxy_name`,`pos_x`,`pos_y`,`pos_z` FROM `galaxies` WHERE galaxy_id = ?",
 		"INSERT INTO `solar_systems`(`solarsystem_id`,`galaxy_id`,`solarsystem_name`,`type`,`pos_x`,`pos_y`,`pos_z`,`radius`) VALUES (?, ?, ?, ?, ?, ?, ?, ?)",
+		// Values are appended SOLARSYSTEM_BULK_ROWS times when preparing
+		"INSERT INTO `solar_systems`(`solarsystem_id`,`galaxy_id`,`solarsystem_name`,`type`,`pos_x`,`pos_y`,`pos_z`,`radius`) VALUES ",
 		"SELECT `galaxy_id`,`solarsystem_name`,`type`,`pos_x`,`pos_y`,`pos_z`,`radius` FROM `solar_systems` WHERE `solarsystem_id` = ?",
+		"INSERT OR REPLACE INTO `solar_systems`(`solarsystem_id`,`galaxy_id`,`solarsystem_name`,`type`,`pos_x`,`pos_y`,`pos_z`,`radius`) VALUES (?, ?, ?, ?, ?, ?, ?, ?)",
 		"SELECT `solarsystem_id`,`solarsystem_name`,`type`,`pos_x`,`pos_y`,`pos_z`,`radius` FROM `solar_systems` WHERE `galaxy_id` = ?",
 		"INSERT INTO `gameconfig` (`universe_name`, `seed`, `universe_birth`) VALUES (?, ?, ?)",
 		"SELECT `seed`, `universe_birth` FROM `gameconfig` WHERE `universe_name` = ?",
 		"SELECT `universe_generated` FROM `gameconfig` WHERE `universe_name` = ?",
-		"UPDATE `gameconfig` SET `universe_generated` = ? WHERE `universe_name` = ?"
+		"UPDATE `gameconfig` SET `universe_generated` = ? WHERE `universe_name` = ?",
+		"SELECT `generator_backend` FROM `gameconfig` WHERE `universe_name` = ?",
+		"UPDATE `gameconfig` SET `generator_backend` = ? WHERE `universe_name` = ?",
+		"SELECT `solarsystem_derived_names` FROM `gameconfig` WHERE `universe_name` = ?",
+		"UPDATE `gameconfig` SET `solarsystem_derived_names` = ? WHERE `universe_name` = ?",
+		"SELECT `solarsystem_id`,`type`,`pos_x`,`pos_y`,`pos_z`,`radius` FROM `solar_systems` WHERE `galaxy_id` = ?"
 };
 
+// 8 parameters per row, must stay under SQLITE_MAX_VARIABLE_NUMBER (999 before 3.32)
+#define SOLARSYSTEM_BULK_ROWS	100
+#define SOLARSYSTEM_BULK_COLUMNS	8
+
 #define BUSY_INFO_THRESHOLD	100	// Print first informational message after 100ms.
 #define BUSY_WARNING_THRESHOLD	250	// Print warning message after 250ms. Lag is increased.
 #define BUSY_ERROR_THRESHOLD	1000	// Print error message after 1000ms. Significant lag.
 #define BUSY_FATAL_THRESHOLD	3000	// Allow SQLITE_BUSY to be returned
 #define BUSY_ERROR_INTERVAL	10000	// Safety net: report again every 10 seconds
 
-DatabaseSQLite3::DatabaseSQLite3(const std::string &db_path):
-	m_db_path(db_path + DIR_DELIM + "universe.db")
+DatabaseSQLite3::DatabaseSQLite3(const std::string &db_path, const bool read_only):
+	m_db_path(db_path + DIR_DELIM + "universe.db"),
+	m_read_only(read_only)
 {
 	Open();
 }
@@ -57,16 +72,31 @@ void DatabaseSQLite3::Open()
 {
 	URHO3D_LOGDEBUGF("Opening DB at %s", m_db_path.c_str());
 
-	sqlite3_verify(sqlite3_open_v2(m_db_path.c_str(), &m_database,
-	   SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL));
+	// A read only connection is used by one thread at a time, it doesn't need SQLite mutexes
+	sqlite3_verify(sqlite3_open_v2(m_db_path.c_str(), &m_database, m_read_only ?
+		SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+		NULL));
 	sqlite3_verify(sqlite3_busy_handler(m_database, DatabaseSQLite3::busyHandler,
 		m_busy_handler_data));
 
-	UpdateSchema();
+	if (!m_read_only) {
+		// Readers don't block the writer and see the last committed transaction, the
+		// journal mode is stored in the database file
+		sqlite3_verify(sqlite3_exec(m_database, "PRAGMA journal_mode = WAL;", NULL, NULL,
+			NULL));
+		UpdateSchema();
+	}
 
 	for (uint16_t i = 0; i < SQLITE3STMT_COUNT; i++) {
-		URHO3D_LOGDEBUGF("Loading statement %d %s", i, stmt_list[i]);
-		sqlite3_verify(sqlite3_prepare_v2(m_database, stmt_list[i], -1, &m_stmt[i], NULL));
+		std::string stmt = stmt_list[i];
+		if (i == SQLITE3STMT_CREATE_SOLARSYSTEMS_BULK) {
+			for (uint16_t row = 0; row < SOLARSYSTEM_BULK_ROWS; row++) {
+				stmt += row == 0 ? "(?, ?, ?, ?, ?, ?, ?, ?)" : ", (?, ?, ?, ?, ?, ?, ?, ?)";
+			}
+		}
+
+		URHO3D_LOGDEBUGF("Loading statement %d %s", i, stmt.c_str());
+		sqlite3_verify(sqlite3_prepare_v2(m_database, stmt.c_str(), -1, &m_stmt[i], NULL));
 	}
 }
 
@@ -105,6 +135,21 @@ void DatabaseSQLite3::UpdateSchema()
 
 	sqlite3_verify(sqlite3_exec(m_database, gameconfig_table_sql, NULL, NULL, NULL));
 
+	// Universes created before the counter backend were generated with MT19937
+	if (!HasColumn("gameconfig", "generator_backend")) {
+		const std::string backend_sql = "ALTER TABLE `gameconfig` ADD COLUMN "
+			"`generator_backend` SMALLINT NOT NULL DEFAULT(" +
+			std::to_string(UNIVGEN_BACKEND_MT19937) + ");";
+		sqlite3_verify(sqlite3_exec(m_database, backend_sql.c_str(), NULL, NULL, NULL));
+	}
+
+	// Names were always stored before
+	if (!HasColumn("gameconfig", "solarsystem_derived_names")) {
+		static const char *derived_names_sql = "ALTER TABLE `gameconfig` ADD COLUMN "
+			"`solarsystem_derived_names` SMALLINT NOT NULL DEFAULT(0);";
+		sqlite3_verify(sqlite3_exec(m_database, derived_names_sql, NULL, NULL, NULL));
+	}
+
 	static const char *galaxy_table_sql = "CREATE TABLE IF NOT EXISTS `galaxies` ("
 		"	galaxy_id INTEGER NOT NULL PRIMARY KEY,"
 		"	galaxy_name VARCHAR(32) NOT NULL,"
@@ -129,6 +174,12 @@ void DatabaseSQLite3::UpdateSchema()
 
 	sqlite3_verify(sqlite3_exec(m_database, solarsystem_table_sql, NULL, NULL, NULL));
 
+	// Dropped during bulk loads and rebuilt once at the end
+	static const char *solarsystem_galaxy_index_sql = "CREATE INDEX IF NOT EXISTS "
+		"`solar_systems_galaxy_id` ON `solar_systems` (`galaxy_id`);";
+
+	sqlite3_verify(sqlite3_exec(m_database, solarsystem_galaxy_index_sql, NULL, NULL, NULL));
+
 	static const char *planet_table_sql = "CREATE TABLE IF NOT EXISTS `planets` ("
 		"	planet_id INTEGER NOT NULL PRIMARY KEY,"
 		"	solarsystem_id INTEGER NOT NULL,"
@@ -224,6 +275,83 @@ void DatabaseSQLite3::CommitTransaction()
 	reset_stmt(SQLITE3STMT_END);
 }
 
+void DatabaseSQLite3::RollbackTransaction()
+{
+	CheckDatabase();
+	if (sqlite3_get_autocommit(m_database)) {
+		return;
+	}
+
+	sqlite3_verify(stmt_step(SQLITE3STMT_ROLLBACK), SQLITE_DONE);
+	reset_stmt(SQLITE3STMT_ROLLBACK);
+}
+
+const std::string DatabaseSQLite3::GetPragma(const char *name)
+{
+	sqlite3_stmt *stmt;
+	sqlite3_verify(sqlite3_prepare_v2(m_database, (std::string("PRAGMA ") + name).c_str(), -1,
+		&stmt, NULL));
+
+	std::string value = "";
+	if (sqlite3_step(stmt) == SQLITE_ROW) {
+		const char *text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+		value = text ? text : "";
+	}
+
+	sqlite3_verify(sqlite3_finalize(stmt));
+	return value;
+}
+
+const bool DatabaseSQLite3::HasColumn(const char *table, const char *column)
+{
+	sqlite3_stmt *stmt;
+	sqlite3_verify(sqlite3_prepare_v2(m_database,
+		(std::string("PRAGMA table_info(") + table + ")").c_str(), -1, &stmt, NULL));
+
+	bool found = false;
+	while (!found && sqlite3_step(stmt) == SQLITE_ROW) {
+		const char *name = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
+		found = name && std::string(name) == column;
+	}
+
+	sqlite3_verify(sqlite3_finalize(stmt));
+	return found;
+}
+
+/*
+ * Bulk load trades durability for speed: if the process dies during the load the universe
+ * is not flagged as generated and will be generated again.
+ * The galaxy index is rebuilt once at the end instead of being updated on each insert.
+ * WAL journaling can only be left when no other connection is open
+ */
+void DatabaseSQLite3::BeginBulkLoad()
+{
+	m_saved_journal_mode = GetPragma("journal_mode");
+	m_saved_synchronous = GetPragma("synchronous");
+	m_saved_cache_size = GetPragma("cache_size");
+
+	static const char *bulk_begin_sql = "PRAGMA journal_mode = MEMORY;"
+		"PRAGMA synchronous = OFF;"
+		"PRAGMA cache_size = -65536;"
+		"DROP INDEX IF EXISTS `solar_systems_galaxy_id`;";
+
+	sqlite3_verify(sqlite3_exec(m_database, bulk_begin_sql, NULL, NULL, NULL));
+}
+
+void DatabaseSQLite3::EndBulkLoad()
+{
+	static const char *bulk_end_sql = "CREATE INDEX IF NOT EXISTS `solar_systems_galaxy_id` "
+		"ON `solar_systems` (`galaxy_id`);";
+
+	sqlite3_verify(sqlite3_exec(m_database, bulk_end_sql, NULL, NULL, NULL));
+
+	const std::string restore_sql = "PRAGMA journal_mode = " + m_saved_journal_mode + ";"
+		"PRAGMA synchronous = " + m_saved_synchronous + ";"
+		"PRAGMA cache_size = " + m_saved_cache_size + ";";
+
+	sqlite3_verify(sqlite3_exec(m_database, restore_sql.c_str(), NULL, NULL, NULL));
+}
+
 void DatabaseSQLite3::CreateGalaxy(Galaxy *galaxy)
 {
 	uint64_to_sqlite(SQLITE3STMT_CREATE_GALAXY, 1, galaxy->id);
@@ -254,60 +382,158 @@ Galaxy *DatabaseSQLite3::LoadGalaxy(const uint64_t &galaxy_id)
 	return galaxy;
 }
 
-void DatabaseSQLite3::CreateSolarSystem(engine::SolarSystem *ss)
+void DatabaseSQLite3::bind_solarsystem(const SQLite3Stmt s, const int first_col,
+	const Galaxy *galaxy, const SolarSystemHandle &ss)
+{
+	uint64_to_sqlite(s, first_col, ss.GetId());
+	uint64_to_sqlite(s, first_col + 1, galaxy->id);
+	// Derived names are stored empty
+	string_to_sqlite(s, first_col + 2, ss.GetStoredName());
+	uint16_to_sqlite(s, first_col + 3, ss.GetType());
+	double_to_sqlite(s, first_col + 4, ss.GetPosX());
+	double_to_sqlite(s, first_col + 5, ss.GetPosY());
+	double_to_sqlite(s, first_col + 6, ss.GetPosZ());
+	double_to_sqlite(s, first_col + 7, ss.GetRadius());
+}
+
+void DatabaseSQLite3::CreateSolarSystem(const Galaxy *galaxy, const SolarSystemHandle &ss)
 {
-	assert(ss->galaxy);
+	assert(galaxy);
 
-	uint64_to_sqlite(SQLITE3STMT_CREATE_SOLARSYSTEM, 1, ss->id);
-	uint64_to_sqlite(SQLITE3STMT_CREATE_SOLARSYSTEM, 2, ss->galaxy->id);
-	string_to_sqlite(SQLITE3STMT_CREATE_SOLARSYSTEM, 3, ss->name.c_str());
-	uint16_to_sqlite(SQLITE3STMT_CREATE_SOLARSYSTEM, 4, ss->type);
-	double_to_sqlite(SQLITE3STMT_CREATE_SOLARSYSTEM, 5, ss->pos_x);
-	double_to_sqlite(SQLITE3STMT_CREATE_SOLARSYSTEM, 6, ss->pos_y);
-	double_to_sqlite(SQLITE3STMT_CREATE_SOLARSYSTEM, 7, ss->pos_z);
-	double_to_sqlite(SQLITE3STMT_CREATE_SOLARSYSTEM, 8, ss->radius);
+	bind_solarsystem(SQLITE3STMT_CREATE_SOLARSYSTEM, 1, galaxy, ss);
 
 	sqlite3_verify(stmt_step(SQLITE3STMT_CREATE_SOLARSYSTEM), SQLITE_DONE);
 	reset_stmt(SQLITE3STMT_CREATE_SOLARSYSTEM);
 }
 
-SolarSystem *DatabaseSQLite3::LoadSolarSystem(const uint64_t &ss_id)
+void DatabaseSQLite3::CreateSolarSystems(const Galaxy *galaxy, const uint32_t begin,
+	const uint32_t end, std::atomic<uint32_t> *progress)
 {
-	SolarSystem *solar_system = nullptr;
+	assert(galaxy);
+	assert(end <= galaxy->solar_systems.size());
+
+	uint32_t row = begin;
+	for (; row + SOLARSYSTEM_BULK_ROWS <= end; row += SOLARSYSTEM_BULK_ROWS) {
+		for (uint32_t i = 0; i < SOLARSYSTEM_BULK_ROWS; i++) {
+			bind_solarsystem(SQLITE3STMT_CREATE_SOLARSYSTEMS_BULK,
+				i * SOLARSYSTEM_BULK_COLUMNS + 1, galaxy, galaxy->solar_systems[row + i]);
+		}
+
+		sqlite3_verify(stmt_step(SQLITE3STMT_CREATE_SOLARSYSTEMS_BULK), SQLITE_DONE);
+		reset_stmt(SQLITE3STMT_CREATE_SOLARSYSTEMS_BULK);
+
+		if (progress) {
+			progress->fetch_add(SOLARSYSTEM_BULK_ROWS);
+		}
+	}
+
+	// Remaining rows don't fill a bulk statement
+	for (; row < end; row++) {
+		CreateSolarSystem(galaxy, galaxy->solar_systems[row]);
+		if (progress) {
+			progress->fetch_add(1);
+		}
+	}
+}
+
+/*
+ * Load a solar system object into the galaxy arena, nullptr is returned if the solar system
+ * doesn't exist or doesn't belong to this galaxy
+ */
+SolarSystem *DatabaseSQLite3::LoadSolarSystem(Galaxy *galaxy, const uint64_t &ss_id)
+{
+	SolarSystem solar_system;
+	if (!LoadSolarSystem(galaxy, ss_id, &solar_system)) {
+		return nullptr;
+	}
+
+	return galaxy->arena.Create<SolarSystem>(std::move(solar_system));
+}
+
+/*
+ * Load a solar system into an existing object, used to reuse objects owned by a cache
+ */
+bool DatabaseSQLite3::LoadSolarSystem(Galaxy *galaxy, const uint64_t &ss_id, SolarSystem *ss)
+{
+	assert(galaxy && ss);
+
+	bool found = false;
 	uint64_to_sqlite(SQLITE3STMT_LOAD_SOLARSYSTEM, 1, ss_id);
-	if (stmt_step(SQLITE3STMT_LOAD_SOLARSYSTEM) == SQLITE_ROW) {
-		solar_system = new SolarSystem();
-		// Warning we don't load solar system galaxy_id there
-		solar_system->id = ss_id;
-		solar_system->name = sqlite_to_string(SQLITE3STMT_LOAD_SOLARSYSTEM, 1);
-		solar_system->type = (SolarType)sqlite_to_uint16(SQLITE3STMT_LOAD_SOLARSYSTEM, 2);
-		solar_system->pos_x = sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEM, 3);
-		solar_system->pos_y = sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEM, 4);
-		solar_system->pos_z = sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEM, 5);
-		solar_system->radius = sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEM, 6);
+	if (stmt_step(SQLITE3STMT_LOAD_SOLARSYSTEM) == SQLITE_ROW &&
+		sqlite_to_uint64(SQLITE3STMT_LOAD_SOLARSYSTEM, 0) == galaxy->id) {
+		ss->id = ss_id;
+		ss->galaxy = galaxy;
+		ss->name = sqlite_to_string(SQLITE3STMT_LOAD_SOLARSYSTEM, 1);
+		if (ss->name.empty()) {
+			ss->name = UnivGen->generate_solarsystem_name(ss_id);
+		}
+		ss->type = (SolarType)sqlite_to_uint16(SQLITE3STMT_LOAD_SOLARSYSTEM, 2);
+		ss->pos_x = sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEM, 3);
+		ss->pos_y = sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEM, 4);
+		ss->pos_z = sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEM, 5);
+		ss->radius = sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEM, 6);
+		ss->planets.clear();
+		found = true;
 	}
 
-	reset_stmt(SQLITE3STMT_LOAD_GALAXY);
+	reset_stmt(SQLITE3STMT_LOAD_SOLARSYSTEM);
+
+	return found;
+}
 
-	return solar_system;
+void DatabaseSQLite3::SaveSolarSystem(const SolarSystem &ss)
+{
+	assert(ss.galaxy);
+
+	uint64_to_sqlite(SQLITE3STMT_SAVE_SOLARSYSTEM, 1, ss.id);
+	uint64_to_sqlite(SQLITE3STMT_SAVE_SOLARSYSTEM, 2, ss.galaxy->id);
+	// Loading filled in the derived name, it's stored empty
+	string_to_sqlite(SQLITE3STMT_SAVE_SOLARSYSTEM, 3,
+		Universe::instance()->HasDerivedNames() ? std::string() : ss.name);
+	uint16_to_sqlite(SQLITE3STMT_SAVE_SOLARSYSTEM, 4, ss.type);
+	double_to_sqlite(SQLITE3STMT_SAVE_SOLARSYSTEM, 5, ss.pos_x);
+	double_to_sqlite(SQLITE3STMT_SAVE_SOLARSYSTEM, 6, ss.pos_y);
+	double_to_sqlite(SQLITE3STMT_SAVE_SOLARSYSTEM, 7, ss.pos_z);
+	double_to_sqlite(SQLITE3STMT_SAVE_SOLARSYSTEM, 8, ss.radius);
+
+	sqlite3_verify(stmt_step(SQLITE3STMT_SAVE_SOLARSYSTEM), SQLITE_DONE);
+	reset_stmt(SQLITE3STMT_SAVE_SOLARSYSTEM);
 }
 
 void DatabaseSQLite3::LoadSolarSystemsForGalaxy(Galaxy *galaxy)
 {
 	uint64_to_sqlite(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY, 1, galaxy->id);
 	while (stmt_step(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY) == SQLITE_ROW) {
-		SolarSystem *solar_system = new SolarSystem();
-		solar_system->id = sqlite_to_uint64(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY, 0);
-		solar_system->name = sqlite_to_string(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY, 1);
-		solar_system->type = (SolarType)sqlite_to_uint16(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY, 2);
-		solar_system->pos_x = sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY, 3);
-		solar_system->pos_y = sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY, 4);
-		solar_system->pos_z = sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY, 5);
-		solar_system->radius = sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY, 6);
-		galaxy->solar_systems[solar_system->id] = solar_system;
+		const uint32_t row = galaxy->solar_systems.Add(
+			sqlite_to_uint64(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY, 0));
+		galaxy->solar_systems.SetName(row,
+			sqlite_to_string(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY, 1));
+		galaxy->solar_systems.Set(row,
+			(SolarType)sqlite_to_uint16(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY, 2),
+			sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY, 6),
+			sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY, 3),
+			sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY, 4),
+			sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY, 5));
 	}
 
-	reset_stmt(SQLITE3STMT_LOAD_GALAXY);
+	reset_stmt(SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY);
+}
+
+void DatabaseSQLite3::LoadSolarSystemPositionsForGalaxy(Galaxy *galaxy)
+{
+	uint64_to_sqlite(SQLITE3STMT_LOAD_SOLARSYSTEM_POSITIONS_FOR_GALAXY, 1, galaxy->id);
+	while (stmt_step(SQLITE3STMT_LOAD_SOLARSYSTEM_POSITIONS_FOR_GALAXY) == SQLITE_ROW) {
+		const uint32_t row = galaxy->solar_systems.Add(
+			sqlite_to_uint64(SQLITE3STMT_LOAD_SOLARSYSTEM_POSITIONS_FOR_GALAXY, 0));
+		galaxy->solar_systems.Set(row,
+			(SolarType)sqlite_to_uint16(SQLITE3STMT_LOAD_SOLARSYSTEM_POSITIONS_FOR_GALAXY, 1),
+			sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEM_POSITIONS_FOR_GALAXY, 5),
+			sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEM_POSITIONS_FOR_GALAXY, 2),
+			sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEM_POSITIONS_FOR_GALAXY, 3),
+			sqlite_to_double(SQLITE3STMT_LOAD_SOLARSYSTEM_POSITIONS_FOR_GALAXY, 4));
+	}
+
+	reset_stmt(SQLITE3STMT_LOAD_SOLARSYSTEM_POSITIONS_FOR_GALAXY);
 }
 
 void DatabaseSQLite3::CreateUniverse(const std::string &name, const uint64_t &seed)
@@ -320,7 +546,7 @@ void DatabaseSQLite3::CreateUniverse(const std::string &name, const uint64_t &se
 	reset_stmt(SQLITE3STMT_CREATE_UNIVERSE);
 }
 
-void DatabaseSQLite3::LoadUniverse(const std::string &name)
+const bool DatabaseSQLite3::LoadUniverse(const std::string &name)
 {
 	CheckDatabase();
 	string_to_sqlite(SQLITE3STMT_LOAD_UNIVERSE, 1, name);
@@ -329,19 +555,24 @@ void DatabaseSQLite3::LoadUniverse(const std::string &name)
 		engine::Universe::instance()->SetUniverseSeed(sqlite_to_uint64(SQLITE3STMT_LOAD_UNIVERSE, 0));
 		engine::Universe::instance()->SetUniverseBirth(sqlite_to_uint32(SQLITE3STMT_LOAD_UNIVERSE, 1));
 		reset_stmt(SQLITE3STMT_LOAD_UNIVERSE);
-		return;
+		return true;
 	}
 	reset_stmt(SQLITE3STMT_LOAD_UNIVERSE);
+	return false;
 }
 
 const bool DatabaseSQLite3::IsUniverseGenerated(const std::string &name)
 {
 	CheckDatabase();
 	string_to_sqlite(SQLITE3STMT_LOAD_UNIVERSE_GENERATED_FLAG, 1, name);
+	bool generated = false;
 	if (stmt_step(SQLITE3STMT_LOAD_UNIVERSE_GENERATED_FLAG) == SQLITE_ROW) {
-		return sqlite_to_bool(SQLITE3STMT_LOAD_UNIVERSE_GENERATED_FLAG, 0);
+		generated = sqlite_to_bool(SQLITE3STMT_LOAD_UNIVERSE_GENERATED_FLAG, 0);
 	}
-	return false;
+
+	// An unreset statement keeps the read transaction open
+	reset_stmt(SQLITE3STMT_LOAD_UNIVERSE_GENERATED_FLAG);
+	return generated;
 }
 
 void DatabaseSQLite3::SetUniverseGenerated(const std::string &name, bool generated)
@@ -352,5 +583,57 @@ void DatabaseSQLite3::SetUniverseGenerated(const std::string &name, bool generat
 	sqlite3_verify(stmt_step(SQLITE3STMT_SET_UNIVERSE_GENERATED_FLAG), SQLITE_DONE);
 	reset_stmt(SQLITE3STMT_SET_UNIVERSE_GENERATED_FLAG);
 }
+
+void DatabaseSQLite3::SetUniverseBackend(const std::string &name,
+	const UniverseGeneratorBackend backend)
+{
+	CheckDatabase();
+	uint16_to_sqlite(SQLITE3STMT_SET_UNIVERSE_BACKEND, 1, backend);
+	string_to_sqlite(SQLITE3STMT_SET_UNIVERSE_BACKEND, 2, name);
+	sqlite3_verify(stmt_step(SQLITE3STMT_SET_UNIVERSE_BACKEND), SQLITE_DONE);
+	reset_stmt(SQLITE3STMT_SET_UNIVERSE_BACKEND);
+}
+
+const UniverseGeneratorBackend DatabaseSQLite3::GetUniverseBackend(const std::string &name)
+{
+	CheckDatabase();
+	uint16_t backend = UNIVGEN_BACKEND_MT19937;
+	string_to_sqlite(SQLITE3STMT_LOAD_UNIVERSE_BACKEND, 1, name);
+	if (stmt_step(SQLITE3STMT_LOAD_UNIVERSE_BACKEND) == SQLITE_ROW) {
+		backend = sqlite_to_uint16(SQLITE3STMT_LOAD_UNIVERSE_BACKEND, 0);
+	}
+
+	reset_stmt(SQLITE3STMT_LOAD_UNIVERSE_BACKEND);
+
+	// Planets would be generated again with another generator
+	if (backend >= UNIVGEN_BACKEND_COUNT) {
+		throw SQLiteException("Unknown universe generator backend " +
+			std::to_string(backend));
+	}
+
+	return (UniverseGeneratorBackend) backend;
+}
+
+void DatabaseSQLite3::SetUniverseDerivedNames(const std::string &name, const bool derived_names)
+{
+	CheckDatabase();
+	bool_to_sqlite(SQLITE3STMT_SET_UNIVERSE_DERIVED_NAMES, 1, derived_names);
+	string_to_sqlite(SQLITE3STMT_SET_UNIVERSE_DERIVED_NAMES, 2, name);
+	sqlite3_verify(stmt_step(SQLITE3STMT_SET_UNIVERSE_DERIVED_NAMES), SQLITE_DONE);
+	reset_stmt(SQLITE3STMT_SET_UNIVERSE_DERIVED_NAMES);
+}
+
+const bool DatabaseSQLite3::HasUniverseDerivedNames(const std::string &name)
+{
+	CheckDatabase();
+	string_to_sqlite(SQLITE3STMT_LOAD_UNIVERSE_DERIVED_NAMES, 1, name);
+	bool derived_names = false;
+	if (stmt_step(SQLITE3STMT_LOAD_UNIVERSE_DERIVED_NAMES) == SQLITE_ROW) {
+		derived_names = sqlite_to_bool(SQLITE3STMT_LOAD_UNIVERSE_DERIVED_NAMES, 0);
+	}
+
+	reset_stmt(SQLITE3STMT_LOAD_UNIVERSE_DERIVED_NAMES);
+	return derived_names;
+}
 }
 }
@@ -38,43 +38,69 @@ enum SQLite3Stmt
 {
 	SQLITE3STMT_BEGIN = 0,
 	SQLITE3STMT_END,
+	SQLITE3STMT_ROLLBACK,
 	SQLITE3STMT_CREATE_GALAXY,
 	SQLITE3STMT_LOAD_GALAXY,
 	SQLITE3STMT_CREATE_SOLARSYSTEM,
+	SQLITE3STMT_CREATE_SOLARSYSTEMS_BULK,
 	SQLITE3STMT_LOAD_SOLARSYSTEM,
+	SQLITE3STMT_SAVE_SOLARSYSTEM,
 	SQLITE3STMT_LOAD_SOLARSYSTEMS_FOR_GALAXY,
 	SQLITE3STMT_CREATE_UNIVERSE,
 	SQLITE3STMT_LOAD_UNIVERSE,
 	SQLITE3STMT_LOAD_UNIVERSE_GENERATED_FLAG,
 	SQLITE3STMT_SET_UNIVERSE_GENERATED_FLAG,
+	SQLITE3STMT_LOAD_UNIVERSE_BACKEND,
+	SQLITE3STMT_SET_UNIVERSE_BACKEND,
+	SQLITE3STMT_LOAD_UNIVERSE_DERIVED_NAMES,
+	SQLITE3STMT_SET_UNIVERSE_DERIVED_NAMES,
+	SQLITE3STMT_LOAD_SOLARSYSTEM_POSITIONS_FOR_GALAXY,
 	SQLITE3STMT_COUNT,
 };
 
 class DatabaseSQLite3: public Database
 {
 public:
-	DatabaseSQLite3(const std::string &db_path);
+	// Read only connections don't update the schema, they can be used alongside the
+	// read-write connection thanks to WAL journaling
+	DatabaseSQLite3(const std::string &db_path, const bool read_only = false);
 	~DatabaseSQLite3() { Close(); }
 
 	// Transactions related
 	void BeginTransaction();
 	void CommitTransaction();
+	void RollbackTransaction();
+	void BeginBulkLoad();
+	void EndBulkLoad();
 
 	void CreateGalaxy(Galaxy *galaxy);
 	Galaxy *LoadGalaxy(const uint64_t &galaxy_id);
-	void CreateSolarSystem(engine::SolarSystem *ss);
-	SolarSystem *LoadSolarSystem(const uint64_t &ss_id);
+	void CreateSolarSystem(const Galaxy *galaxy, const SolarSystemHandle &ss);
+	void CreateSolarSystems(const Galaxy *galaxy, const uint32_t begin, const uint32_t end,
+		std::atomic<uint32_t> *progress = nullptr);
+	SolarSystem *LoadSolarSystem(Galaxy *galaxy, const uint64_t &ss_id);
+	bool LoadSolarSystem(Galaxy *galaxy, const uint64_t &ss_id, SolarSystem *ss);
+	void SaveSolarSystem(const SolarSystem &ss);
 	void LoadSolarSystemsForGalaxy(Galaxy *galaxy);
+	void LoadSolarSystemPositionsForGalaxy(Galaxy *galaxy);
 	void CreateUniverse(const std::string &name, const uint64_t &seed);
-	void LoadUniverse(const std::string &name);
+	const bool LoadUniverse(const std::string &name);
 	void SetUniverseGenerated(const std::string &name, bool generated);
 	const bool IsUniverseGenerated(const std::string &name);
+	void SetUniverseBackend(const std::string &name, const UniverseGeneratorBackend backend);
+	const UniverseGeneratorBackend GetUniverseBackend(const std::string &name);
+	void SetUniverseDerivedNames(const std::string &name, const bool derived_names);
+	const bool HasUniverseDerivedNames(const std::string &name);
 
 private:
 	void Open();
 	bool Close();
 	void UpdateSchema();
 	void CheckDatabase() {}
+	const std::string GetPragma(const char *name);
+	const bool HasColumn(const char *table, const char *column);
+	void bind_solarsystem(const SQLite3Stmt s, const int first_col, const Galaxy *galaxy,
+		const SolarSystemHandle &ss);
 
 	// Common Sqlite interfaces
 	static int busyHandler(void *data, int count);
@@ -109,7 +135,8 @@ private:
 	inline void string_to_sqlite(const SQLite3Stmt s, const int iCol, const std::string &str) const
 	{
 		assert(s < SQLITE3STMT_COUNT);
-		sqlite3_verify(sqlite3_bind_text(m_stmt[s], iCol, str.c_str(), str.size(), NULL));
+		sqlite3_verify(sqlite3_bind_text(m_stmt[s], iCol, str.c_str(), str.size(),
+			SQLITE_TRANSIENT));
 	}
 
 	inline void uint64_to_sqlite(const SQLite3Stmt s, const int iCol, const uint64_t &val) const
@@ -180,9 +207,15 @@ private:
 	}
 
 	std::string m_db_path = "";
+	bool m_read_only = false;
 	sqlite3 *m_database;
 	int64_t m_busy_handler_data[2];
 	sqlite3_stmt *m_stmt[SQLITE3STMT_COUNT];
+
+	// Settings overriden during bulk loading
+	std::string m_saved_journal_mode = "";
+	std::string m_saved_synchronous = "";
+	std::string m_saved_cache_size = "";
 };
 
 }
@@ -19,7 +19,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include "../../exception_utils.h"
+#include "../generators.h"
 
 namespace spacel {
 
@@ -27,6 +30,7 @@ namespace engine {
 
 struct Galaxy;
 struct SolarSystem;
+class SolarSystemHandle;
 
 class Database
 {
@@ -37,14 +41,42 @@ public:
 	// transactions
 	virtual void BeginTransaction() = 0;
 	virtual void CommitTransaction() = 0;
+	// Does nothing if no transaction is open
+	virtual void RollbackTransaction() = 0;
+
+	// Bulk loading window, durability can be relaxed between these calls. They should be
+	// called outside of a transaction
+	virtual void BeginBulkLoad() {}
+	virtual void EndBulkLoad() {}
 
 	virtual void CreateGalaxy(Galaxy *galaxy) = 0;
 	virtual Galaxy *LoadGalaxy(const uint64_t &galaxy_id) = 0;
-	virtual void CreateSolarSystem(engine::SolarSystem *ss) = 0;
-	virtual SolarSystem *LoadSolarSystem(const uint64_t &ss_id) = 0;
+	virtual void CreateSolarSystem(const Galaxy *galaxy, const SolarSystemHandle &ss) = 0;
+	/*
+	 * Persist solar systems rows [begin, end) of the galaxy, progress is incremented
+	 * by the number of persisted rows
+	 */
+	virtual void CreateSolarSystems(const Galaxy *galaxy, const uint32_t begin,
+		const uint32_t end, std::atomic<uint32_t> *progress = nullptr) = 0;
+	virtual SolarSystem *LoadSolarSystem(Galaxy *galaxy, const uint64_t &ss_id) = 0;
+	virtual bool LoadSolarSystem(Galaxy *galaxy, const uint64_t &ss_id, SolarSystem *ss) = 0;
+	// Insert or update the solar system row, its galaxy must be set
+	virtual void SaveSolarSystem(const SolarSystem &ss) = 0;
 	virtual void LoadSolarSystemsForGalaxy(Galaxy *galaxy) = 0;
+	// Load every solar system of the galaxy without its name
+	virtual void LoadSolarSystemPositionsForGalaxy(Galaxy *galaxy) = 0;
+	virtual void CreateUniverse(const std::string &name, const uint64_t &seed) = 0;
+	// Returns false if the universe doesn't exist
+	virtual const bool LoadUniverse(const std::string &name) = 0;
 	virtual void SetUniverseGenerated(const std::string &name, bool generated) = 0;
 	virtual const bool IsUniverseGenerated(const std::string &name) = 0;
+	// Random backend the universe was generated with, MT19937 for older universes
+	virtual void SetUniverseBackend(const std::string &name,
+		const UniverseGeneratorBackend backend) = 0;
+	virtual const UniverseGeneratorBackend GetUniverseBackend(const std::string &name) = 0;
+	// Solar system names of the universe are not stored, false for older universes
+	virtual void SetUniverseDerivedNames(const std::string &name, const bool derived_names) = 0;
+	virtual const bool HasUniverseDerivedNames(const std::string &name) = 0;
 
 private:
 	virtual void Open() = 0;
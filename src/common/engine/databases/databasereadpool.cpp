@@ -0,0 +1,59 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "databasereadpool.h"
+#include "database-sqlite3.h"
+
+namespace spacel {
+namespace engine {
+
+DatabaseReadPool::DatabaseReadPool(const std::string &db_path):
+	m_db_path(db_path)
+{
+}
+
+DatabaseReadPool::~DatabaseReadPool()
+{
+}
+
+Database *DatabaseReadPool::Get()
+{
+	const std::thread::id thread_id = std::this_thread::get_id();
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		auto it = m_connections.find(thread_id);
+		if (it != m_connections.end()) {
+			return it->second.get();
+		}
+	}
+
+	// Opened without the lock, other threads keep loading meanwhile
+	std::unique_ptr<DatabaseSQLite3> db(new DatabaseSQLite3(m_db_path, true));
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return (m_connections[thread_id] = std::move(db)).get();
+}
+
+const size_t DatabaseReadPool::GetConnectionCount() const
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_connections.size();
+}
+
+}
+}
@@ -0,0 +1,58 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace spacel {
+namespace engine {
+
+class Database;
+class DatabaseSQLite3;
+
+/*
+ * Read only connections to a universe database, one per thread using the pool. Each
+ * connection has its own prepared statements so workers load in parallel, the single
+ * writer is not blocked by readers.
+ * Connections are kept until the pool is destroyed, use it from long lived threads like
+ * the job system workers
+ */
+class DatabaseReadPool
+{
+public:
+	DatabaseReadPool(const std::string &db_path);
+	~DatabaseReadPool();
+
+	// Connection of the calling thread, opened on first use. Throws SQLiteException
+	Database *Get();
+	const size_t GetConnectionCount() const;
+
+private:
+	std::string m_db_path;
+	mutable std::mutex m_mutex;
+	std::unordered_map<std::thread::id, std::unique_ptr<DatabaseSQLite3>> m_connections;
+};
+
+}
+}
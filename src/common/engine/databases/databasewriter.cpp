@@ -0,0 +1,198 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <Urho3D/IO/Log.h>
+#include "databasewriter.h"
+#include "database-sqlite3.h"
+#include "../../profiler.h"
+
+namespace spacel {
+namespace engine {
+
+DatabaseWriter::DatabaseWriter(Database *db, const uint32_t flush_interval_ms):
+	m_db(db), m_flush_interval(flush_interval_ms)
+{
+	assert(m_db);
+}
+
+DatabaseWriter::~DatabaseWriter()
+{
+	Shutdown();
+	delete m_db;
+}
+
+void DatabaseWriter::ThreadFunction()
+{
+	while (shouldRun_) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeup.wait_for(lock, m_flush_interval, [this] {
+				return !shouldRun_ || m_flush_requested;
+			});
+			m_flush_requested = false;
+		}
+
+		WriteBatch();
+	}
+
+	// Objects marked while stopping
+	WriteBatch();
+}
+
+void DatabaseWriter::Shutdown()
+{
+	if (IsStarted()) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			shouldRun_ = false;
+		}
+		m_wakeup.notify_one();
+		Stop();
+	}
+
+	// Remaining objects, or every object if the thread never ran
+	WriteBatch();
+	if (m_metrics.pending_objects > 0) {
+		URHO3D_LOGERRORF("%d objects were not saved to the database",
+			(int) m_metrics.pending_objects);
+	}
+}
+
+void DatabaseWriter::Flush()
+{
+	if (!IsStarted()) {
+		WriteBatch();
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	const uint64_t marked = m_marked;
+	const uint64_t failed = m_metrics.failed_transactions;
+	m_flush_requested = true;
+	m_wakeup.notify_one();
+	m_flushed.wait(lock, [&] {
+		return m_written >= marked || m_metrics.failed_transactions > failed;
+	});
+}
+
+void DatabaseWriter::SaveSolarSystem(const SolarSystem &ss)
+{
+	assert(ss.galaxy);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	auto it = m_dirty_solarsystems.find(ss.id);
+	if (it != m_dirty_solarsystems.end()) {
+		it->second = ss;
+		m_metrics.coalesced_writes++;
+	} else {
+		it = m_dirty_solarsystems.emplace(ss.id, ss).first;
+		m_metrics.pending_objects++;
+	}
+
+	// Planets are not saved with their solar system
+	it->second.planets.clear();
+	m_marked++;
+}
+
+bool DatabaseWriter::GetPendingSolarSystem(const uint64_t &id, SolarSystem *ss) const
+{
+	assert(ss);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	auto it = m_dirty_solarsystems.find(id);
+	if (it == m_dirty_solarsystems.end()) {
+		it = m_writing_solarsystems.find(id);
+		if (it == m_writing_solarsystems.end()) {
+			return false;
+		}
+	}
+
+	(*ss) = it->second;
+	return true;
+}
+
+/*
+ * Take the dirty objects and write them in one transaction. They stay readable until the
+ * transaction is committed, a failed batch is merged back behind newer states
+ */
+void DatabaseWriter::WriteBatch()
+{
+	uint64_t marked;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (m_dirty_solarsystems.empty()) {
+			m_written = m_marked;
+			m_flushed.notify_all();
+			return;
+		}
+
+		m_writing_solarsystems.swap(m_dirty_solarsystems);
+		m_metrics.pending_objects = 0;
+		marked = m_marked;
+	}
+
+	const uint64_t start = m_profiler ? m_profiler->GetTime() : 0;
+	const auto begin = std::chrono::steady_clock::now();
+	bool committed = false;
+	try {
+		m_db->BeginTransaction();
+		for (const auto &ss: m_writing_solarsystems) {
+			m_db->SaveSolarSystem(ss.second);
+		}
+		m_db->CommitTransaction();
+		committed = true;
+	}
+	catch (SQLiteException &e) {
+		URHO3D_LOGERRORF("Unable to write %d objects to the database: %s",
+			(int) m_writing_solarsystems.size(), e.what());
+		try {
+			m_db->RollbackTransaction();
+		}
+		catch (SQLiteException &e) {
+			URHO3D_LOGERROR(e.what());
+		}
+	}
+
+	m_metrics.last_flush_us = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - begin).count();
+	if (m_profiler) {
+		m_profiler->RecordScope("db_flush", start, m_profiler->GetTime());
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (committed) {
+		m_metrics.written_objects += m_writing_solarsystems.size();
+		m_metrics.transactions++;
+		m_written = marked;
+	} else {
+		for (auto &ss: m_writing_solarsystems) {
+			if (m_dirty_solarsystems.emplace(ss.first, std::move(ss.second)).second) {
+				m_metrics.pending_objects++;
+			}
+		}
+		m_metrics.failed_transactions++;
+	}
+
+	m_writing_solarsystems.clear();
+	m_flushed.notify_all();
+}
+
+}
+}
@@ -0,0 +1,108 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <Urho3D/Core/Thread.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include "../space.h"
+
+namespace spacel {
+
+class Profiler;
+
+namespace engine {
+
+class Database;
+
+/*
+ * Database writer state, readable from any thread
+ */
+struct DatabaseWriterMetrics
+{
+	// Dirty objects waiting for the next flush
+	std::atomic<uint32_t> pending_objects{0};
+	std::atomic<uint64_t> written_objects{0};
+	// Objects modified again before being written
+	std::atomic<uint64_t> coalesced_writes{0};
+	std::atomic<uint64_t> transactions{0};
+	// Failed batches are kept and written again on next flush
+	std::atomic<uint64_t> failed_transactions{0};
+	std::atomic<uint64_t> last_flush_us{0};
+};
+
+/*
+ * Write-behind persistence. Objects are marked dirty from the server thread, the writer
+ * thread saves the latest state of the dirty objects in one transaction per flush
+ * interval, so the server never waits on disk or on database locks.
+ * The pending state of an object is returned until its transaction is committed, the
+ * server reads its own writes this way
+ */
+class DatabaseWriter: public Urho3D::Thread
+{
+public:
+	// The writer owns the database, it's only used by the writer thread once running
+	DatabaseWriter(Database *db, const uint32_t flush_interval_ms);
+	~DatabaseWriter();
+
+	void ThreadFunction();
+	// Write the pending objects and stop the writer thread
+	void Shutdown();
+	// Wait until the objects marked before this call are written, or until a batch fails.
+	// When the writer thread is not running they are written by the calling thread
+	void Flush();
+
+	// Thread safe
+	void SaveSolarSystem(const SolarSystem &ss);
+	// Returns false if the solar system has no pending write
+	bool GetPendingSolarSystem(const uint64_t &id, SolarSystem *ss) const;
+
+	const DatabaseWriterMetrics &GetMetrics() const { return m_metrics; }
+	// Flushes are recorded as "db_flush" scopes when set, before Run
+	void SetProfiler(Profiler *profiler) { m_profiler = profiler; }
+
+private:
+	void WriteBatch();
+
+	Database *m_db;
+	std::chrono::milliseconds m_flush_interval;
+	Profiler *m_profiler = nullptr;
+	DatabaseWriterMetrics m_metrics;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_wakeup;
+	std::condition_variable m_flushed;
+	bool m_flush_requested = false;
+	// Number of marked objects, and of marked objects whose batch is committed
+	uint64_t m_marked = 0;
+	uint64_t m_written = 0;
+
+	// Latest state of the dirty objects
+	std::unordered_map<uint64_t, SolarSystem> m_dirty_solarsystems;
+	// Batch being written, only modified with the mutex held
+	std::unordered_map<uint64_t, SolarSystem> m_writing_solarsystems;
+};
+
+}
+}
@@ -0,0 +1,229 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include "galaxyinterest.h"
+#include "space.h"
+#include "network/localmessages.h"
+#include "network/networkprotocol.h"
+#include "network/packetpool.h"
+
+namespace spacel {
+namespace engine {
+
+using namespace network;
+
+#define GALAXY_INTEREST_HYSTERESIS 1.25
+
+// Packet header: opcode and entry count
+#define GALAXY_PACKET_HEADER_SIZE (sizeof(uint16_t) + sizeof(uint32_t))
+// Id, type, radius and position, the name is added
+#define GALAXY_SYSTEM_ENTRY_SIZE (sizeof(uint64_t) + sizeof(uint8_t) + 4 * sizeof(double))
+
+GalaxyInterest::GalaxyInterest(const Galaxy *galaxy, const double radius, const bool compact):
+	m_galaxy(galaxy), m_radius(radius), m_compact(compact)
+{
+	assert(m_galaxy);
+}
+
+void GalaxyInterest::SetPosition(const double x, const double y, const double z)
+{
+	const SolarSystemTable &solar_systems = m_galaxy->solar_systems;
+	auto distance_sq = [&](const uint32_t row) {
+		const double dx = solar_systems.GetPosX()[row] - x,
+			dy = solar_systems.GetPosY()[row] - y, dz = solar_systems.GetPosZ()[row] - z;
+		return dx * dx + dy * dy + dz * dz;
+	};
+
+	std::vector<uint64_t> in_range;
+	m_galaxy->spatial_index.QueryRadius(x, y, z, m_radius, in_range);
+
+	std::vector<std::pair<double, uint64_t>> to_add;
+	for (const uint64_t &id: in_range) {
+		uint32_t row;
+		if (!IsKnown(id) && solar_systems.Find(id, row)) {
+			to_add.push_back({ distance_sq(row), id });
+		}
+	}
+
+	std::sort(to_add.begin(), to_add.end());
+	m_pending_add.clear();
+	for (const auto &entry: to_add) {
+		m_pending_add.push_back(entry.second);
+	}
+
+	// Removed solar systems are also removed from the client
+	const double remove_radius_sq = m_radius * m_radius *
+		GALAXY_INTEREST_HYSTERESIS * GALAXY_INTEREST_HYSTERESIS;
+	m_pending_remove.clear();
+	for (const uint64_t &id: m_known) {
+		uint32_t row;
+		if (!solar_systems.Find(id, row) || distance_sq(row) > remove_radius_sq) {
+			m_pending_remove.push_back(id);
+		}
+	}
+}
+
+void GalaxyInterest::GetNextAdds(const uint32_t byte_budget, std::vector<uint64_t> &ids) const
+{
+	const size_t max_count = byte_budget / (m_compact && !m_local_messages ?
+		GALAXY_COMPACT_ENTRY_MIN_SIZE : GALAXY_SYSTEM_ENTRY_SIZE) + 1;
+	const size_t count = std::min(max_count, m_pending_add.size());
+	ids.insert(ids.end(), m_pending_add.begin(), m_pending_add.begin() + count);
+}
+
+uint32_t GalaxyInterest::Flush(const uint32_t byte_budget,
+	std::vector<NetworkPacket *> &packets)
+{
+	uint32_t written = 0;
+	if (!m_pending_remove.empty()) {
+		const uint32_t count = std::max<uint32_t>(1, std::min<uint32_t>(m_pending_remove.size(),
+			(std::max<uint32_t>(byte_budget, GALAXY_PACKET_HEADER_SIZE) -
+			GALAXY_PACKET_HEADER_SIZE) / sizeof(uint64_t)));
+
+		if (m_local_messages) {
+			std::shared_ptr<GalaxySystemsRemoveMessage> message(new GalaxySystemsRemoveMessage());
+			message->ids.reserve(count);
+			for (uint32_t i = 0; i < count; i++) {
+				const uint64_t id = m_pending_remove.back();
+				m_pending_remove.pop_back();
+				m_known.erase(id);
+				message->ids.push_back(id);
+			}
+
+			// Budget is accounted as if the message was encoded
+			written += GALAXY_PACKET_HEADER_SIZE + count * sizeof(uint64_t);
+			packets.push_back(make_local_packet(SMSG_GALAXY_SYSTEMS_REMOVE, message));
+		} else {
+			NetworkPacket *packet = PacketPool::instance()->Acquire(SMSG_GALAXY_SYSTEMS_REMOVE);
+			packet->WriteUInt(count);
+			for (uint32_t i = 0; i < count; i++) {
+				const uint64_t id = m_pending_remove.back();
+				m_pending_remove.pop_back();
+				m_known.erase(id);
+				packet->WriteUInt64(id);
+			}
+
+			written += packet->GetSize();
+			packets.push_back(packet);
+		}
+	}
+
+	if (m_pending_add.empty() || (written > 0 && written >= byte_budget)) {
+		return written;
+	}
+
+	// Select entries fitting in the budget first, the count is written before them
+	const SolarSystemTable &solar_systems = m_galaxy->solar_systems;
+	std::vector<uint32_t> rows;
+	std::vector<std::string> row_names;
+	uint32_t packet_size = GALAXY_PACKET_HEADER_SIZE;
+	// Names which will be added to the dictionary by this packet
+	std::unordered_set<std::string> new_names;
+	while (!m_pending_add.empty()) {
+		uint32_t row;
+		if (!solar_systems.Find(m_pending_add.front(), row)) {
+			m_pending_add.pop_front();
+			continue;
+		}
+
+		std::string name;
+		if (!m_name_source) {
+			name = solar_systems.GetStoredName(row);
+		} else if (!m_name_source(m_pending_add.front(), name)) {
+			// Keep the streaming order, the next solar systems wait for this one
+			break;
+		}
+
+		uint32_t entry_size;
+		if (m_compact && !m_local_messages) {
+			// Indexes of names sent by this packet are bounded by the dictionary size
+			uint32_t name_index = m_names.size() + new_names.size();
+			const bool known_name = m_names.Find(name, name_index) ||
+				!new_names.insert(name).second;
+			entry_size = galaxy_compact_entry_size(solar_systems.GetIds()[row], name,
+				known_name ? name_index : -1);
+		} else {
+			// Name is null terminated
+			entry_size = GALAXY_SYSTEM_ENTRY_SIZE + name.size() + 1;
+		}
+
+		if (!(rows.empty() && written == 0) && written + packet_size + entry_size > byte_budget) {
+			break;
+		}
+
+		rows.push_back(row);
+		row_names.push_back(name);
+		packet_size += entry_size;
+		m_pending_add.pop_front();
+	}
+
+	if (rows.empty()) {
+		return written;
+	}
+
+	if (m_local_messages) {
+		std::shared_ptr<GalaxySystemsMessage> message(new GalaxySystemsMessage());
+		message->systems.reserve(rows.size());
+		for (size_t i = 0; i < rows.size(); i++) {
+			const SolarSystemHandle ss = solar_systems[rows[i]];
+			message->systems.push_back({ ss.GetId(), ss.GetType(), ss.GetRadius(),
+				ss.GetPosX(), ss.GetPosY(), ss.GetPosZ(), row_names[i] });
+			m_known.insert(ss.GetId());
+		}
+
+		written += packet_size;
+		packets.push_back(make_local_packet(SMSG_GALAXY_SYSTEMS, message));
+		return written;
+	}
+
+	if (m_compact) {
+		NetworkPacket *packet = PacketPool::instance()->Acquire(SMSG_GALAXY_SYSTEMS_COMPACT);
+		write_galaxy_systems_compact(packet, solar_systems, rows, row_names, m_names);
+		for (const uint32_t row: rows) {
+			m_known.insert(solar_systems.GetIds()[row]);
+		}
+
+		written += packet->GetSize();
+		packets.push_back(packet);
+		return written;
+	}
+
+	NetworkPacket *packet = PacketPool::instance()->Acquire(SMSG_GALAXY_SYSTEMS);
+	packet->WriteUInt(rows.size());
+	for (size_t i = 0; i < rows.size(); i++) {
+		const SolarSystemHandle ss = solar_systems[rows[i]];
+		packet->WriteUInt64(ss.GetId());
+		packet->WriteUByte(ss.GetType());
+		packet->WriteDouble(ss.GetRadius());
+		packet->WriteDouble(ss.GetPosX());
+		packet->WriteDouble(ss.GetPosY());
+		packet->WriteDouble(ss.GetPosZ());
+		packet->WriteString(Urho3D::String(row_names[i].c_str()));
+		m_known.insert(ss.GetId());
+	}
+
+	written += packet->GetSize();
+	packets.push_back(packet);
+	return written;
+}
+
+}
+}
@@ -0,0 +1,107 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "network/galaxyencoding.h"
+
+namespace spacel {
+namespace engine {
+
+struct Galaxy;
+
+namespace network {
+class NetworkPacket;
+}
+
+/*
+ * Stored name of a solar system, empty if its name is derived. Returns false when the name
+ * is not available yet, the solar system is sent on a later flush
+ */
+typedef std::function<const bool(const uint64_t &id, std::string &name)> SolarSystemNameSource;
+
+/*
+ * Galaxy area known by a client. Solar systems around the client position are streamed
+ * nearest first, systems which are far enough are removed from the client
+ */
+class GalaxyInterest
+{
+public:
+	/*
+	 * compact selects the SMSG_GALAXY_SYSTEMS_COMPACT encoding, names are then sent once
+	 * per session
+	 */
+	GalaxyInterest(const Galaxy *galaxy, const double radius, const bool compact = true);
+
+	/*
+	 * Recompute updates to send. Known systems are only removed once they are further than
+	 * GALAXY_INTEREST_HYSTERESIS times the radius to avoid flapping on boundaries
+	 */
+	void SetPosition(const double x, const double y, const double z);
+
+	/*
+	 * Send typed messages instead of encoded packets, only for clients running in the
+	 * server process
+	 */
+	void SetLocalMessages(const bool local) { m_local_messages = local; }
+
+	/*
+	 * Read names from source instead of the galaxy table, when the table doesn't keep
+	 * them. Shards call it while ticking in parallel, it must not block
+	 */
+	void SetNameSource(const SolarSystemNameSource &source) { m_name_source = source; }
+
+	/*
+	 * Write queued updates into packets without exceeding byte_budget, at least one update is
+	 * written if some are pending. Returns the number of written bytes
+	 */
+	uint32_t Flush(const uint32_t byte_budget, std::vector<network::NetworkPacket *> &packets);
+
+	const bool HasPendingUpdates() const
+	{
+		return !m_pending_add.empty() || !m_pending_remove.empty();
+	}
+	// Append the solar systems the next Flush may send within byte_budget
+	void GetNextAdds(const uint32_t byte_budget, std::vector<uint64_t> &ids) const;
+	const size_t GetKnownCount() const { return m_known.size(); }
+	const bool IsKnown(const uint64_t &id) const { return m_known.find(id) != m_known.end(); }
+
+private:
+	const Galaxy *m_galaxy;
+	double m_radius;
+	bool m_compact;
+	bool m_local_messages = false;
+	SolarSystemNameSource m_name_source;
+	network::GalaxyNameDictionary m_names;
+
+	// Solar systems sent to the client
+	std::unordered_set<uint64_t> m_known;
+	// Sorted from the nearest to the farthest
+	std::deque<uint64_t> m_pending_add;
+	std::vector<uint64_t> m_pending_remove;
+};
+
+}
+}
@@ -21,8 +21,11 @@
 #include <stdlib.h>
 #include <iostream>
 #include <chrono>
+#define _USE_MATH_DEFINES
+#include <cmath>
 #include "generators.h"
 #include "space.h"
+#include "../random_utils.h"
 
 namespace spacel {
 namespace engine {
@@ -55,35 +58,106 @@ static const char *vowels[] = {
 void UniverseGenerator::InitRandomGeneratorIfNot()
 {
 	if (!m_random_generator_inited) {
-		m_random_generator = std::mt19937(s_seed);
-		m_random_generator_galaxy_positions = std::mt19937(s_seed);
-
-		m_vowel_generator = std::uniform_int_distribution<uint8_t>(0, ARRLEN(vowels) - 1);
-		m_name_generators[0] = std::uniform_int_distribution<uint16_t>(0, ARRLEN(name_prefixes) - 1);
-		m_name_generators[1] = std::uniform_int_distribution<uint16_t>(0, ARRLEN(name_suffixes) - 1);
-		m_name_generators[2] = std::uniform_int_distribution<uint16_t>(0, ARRLEN(name_stem) - 1);
-		m_name_generators[3] = std::uniform_int_distribution<uint16_t>(0, 2);
+		m_random_generator = MT19937Random(s_seed);
 		m_random_generator_inited = true;
 	}
 }
 
-std::string UniverseGenerator::generate_world_name()
+/*
+ * Counter backend streams, one per object kind and attribute
+ */
+enum RandomStream
 {
-	InitRandomGeneratorIfNot();
+	RANDOM_STREAM_GALAXY_NAME,
+	RANDOM_STREAM_SOLARSYSTEM_NAME,
+	RANDOM_STREAM_SOLARSYSTEM_TYPE,
+	RANDOM_STREAM_SOLARSYSTEM_RADIUS,
+	RANDOM_STREAM_SOLARSYSTEM_PLANETNUMBER,
+	RANDOM_STREAM_SOLARSYSTEM_GALAXYPOS,
+	RANDOM_STREAM_PLANET_NAME,
+	RANDOM_STREAM_PLANET_TYPE,
+	RANDOM_STREAM_PLANET_DISTANCE,
+	RANDOM_STREAM_PLANET_RADIUS,
+};
+
+/*
+ * Run the attribute generator fn with the selected backend. legacy_seed is the
+ * std::mt19937 seed, (object_id, stream) identifies the counter stream
+ */
+template <typename Fn>
+static inline auto generate(const uint64_t legacy_seed, const uint64_t seed,
+		const uint64_t &object_id, const RandomStream stream, Fn fn)
+{
+	if (UniverseGenerator::GetBackend() == UNIVGEN_BACKEND_MT19937) {
+		MT19937Random rnd(legacy_seed);
+		return fn(rnd);
+	}
+
+	CounterRandom rnd(seed, object_id, stream);
+	return fn(rnd);
+}
 
-	std::string res = name_prefixes[m_name_generators[0](m_random_generator)];
-	uint8_t stem_number = m_name_generators[3](m_random_generator) % 2;
+/*
+ * Same as generate for the attributes which had no per object generator before the
+ * counter backend, the MT19937 backend draws them from a stream of (seed + object_id)
+ * so they don't share the legacy seeds of other attributes and objects
+ */
+template <typename Fn>
+static inline auto generate_stream(const uint64_t seed, const uint64_t &object_id,
+		const RandomStream stream, Fn fn)
+{
+	if (UniverseGenerator::GetBackend() == UNIVGEN_BACKEND_MT19937) {
+		MT19937Random rnd(seed + object_id, (uint32_t) stream + 1);
+		return fn(rnd);
+	}
+
+	CounterRandom rnd(seed, object_id, stream);
+	return fn(rnd);
+}
+
+/*
+ * Draw order matters for the MT19937 backend, don't change it
+ */
+template <typename RandomGenerator>
+static std::string build_world_name(RandomGenerator &rnd)
+{
+	std::string res = name_prefixes[rnd.template uniform_int<uint16_t>(0, ARRLEN(name_prefixes) - 1)];
+	uint8_t stem_number = rnd.template uniform_int<uint16_t>(0, 2) % 2;
 
 	for (uint8_t i = 0; i < stem_number; i++) {
-		res += vowels[m_vowel_generator(m_random_generator)];
-		res += name_stem[m_name_generators[2](m_random_generator)];
+		res += vowels[rnd.template uniform_int<uint8_t>(0, ARRLEN(vowels) - 1)];
+		res += name_stem[rnd.template uniform_int<uint16_t>(0, ARRLEN(name_stem) - 1)];
 	}
 
-	res += name_suffixes[m_name_generators[1](m_random_generator)];
+	res += name_suffixes[rnd.template uniform_int<uint16_t>(0, ARRLEN(name_suffixes) - 1)];
 
 	return res;
 }
 
+std::string UniverseGenerator::generate_world_name()
+{
+	InitRandomGeneratorIfNot();
+	return build_world_name(m_random_generator);
+}
+
+std::string UniverseGenerator::generate_galaxy_name(const uint64_t &galaxy_id)
+{
+	return generate_stream(s_seed, galaxy_id, RANDOM_STREAM_GALAXY_NAME,
+		[](auto &rnd) { return build_world_name(rnd); });
+}
+
+std::string UniverseGenerator::generate_solarsystem_name(const uint64_t &ss_id)
+{
+	return generate_stream(s_seed, ss_id, RANDOM_STREAM_SOLARSYSTEM_NAME,
+		[](auto &rnd) { return build_world_name(rnd); });
+}
+
+std::string UniverseGenerator::generate_planet_name(const uint64_t &pl_id)
+{
+	return generate_stream(s_seed, pl_id, RANDOM_STREAM_PLANET_NAME,
+		[](auto &rnd) { return build_world_name(rnd); });
+}
+
 struct SolarSystemGeneratorDef {
 	float chance;
 	uint8_t max_planets;
@@ -112,10 +186,10 @@ constexpr float solarsystem_chance_max()
 
 uint8_t UniverseGenerator::generate_solarsystem_type(const uint64_t &ss_id)
 {
-	std::mt19937 rndgen(s_seed + ss_id + 256);
-	std::uniform_real_distribution<double> rnd(0.0f, solarsystem_chance_max());
-
-	float chance_value = rnd(rndgen);
+	float chance_value = generate(s_seed + ss_id + 256, s_seed, ss_id,
+		RANDOM_STREAM_SOLARSYSTEM_TYPE, [](auto &rnd) {
+			return rnd.template uniform_real<double>(0.0f, solarsystem_chance_max());
+		});
 	float chance_accumulator = 0.0f;
 
 	// Increment the accumulator with the current planet chance, when the accumulator was
@@ -133,11 +207,12 @@ uint8_t UniverseGenerator::generate_solarsystem_type(const uint64_t &ss_id)
 
 double UniverseGenerator::generate_solarsystem_radius(const uint64_t &ss_id)
 {
-	std::mt19937 rndgen(s_seed + ss_id + 256 * 256);
 	// 10 Billion to 20 Trillion kilometers
-	std::uniform_real_distribution<double> rnd(10 * 1000.0f * 1000.0f * 1000.0f,
-		20.0f * 1000.0f * 1000.0f * 1000.0f * 1000.0f);
-	return rnd(rndgen);
+	return generate(s_seed + ss_id + 256 * 256, s_seed, ss_id,
+		RANDOM_STREAM_SOLARSYSTEM_RADIUS, [](auto &rnd) {
+			return rnd.template uniform_real<double>(10 * 1000.0f * 1000.0f * 1000.0f,
+				20.0f * 1000.0f * 1000.0f * 1000.0f * 1000.0f);
+		});
 }
 
 uint8_t UniverseGenerator::generate_solarsystem_planetnumber(const SolarSystem *ss)
@@ -146,9 +221,11 @@ uint8_t UniverseGenerator::generate_solarsystem_planetnumber(const SolarSystem *
 		return 0;
 	}
 
-	std::mt19937 rndgen(s_seed + ss->id + 256 * 256 * 256);
-	std::uniform_int_distribution<uint8_t> rnd(0, ss_defs[ss->type].max_planets);
-	return rnd(rndgen);
+	const uint8_t max_planets = ss_defs[ss->type].max_planets;
+	return generate(s_seed + ss->id + 256 * 256 * 256, s_seed, ss->id,
+		RANDOM_STREAM_SOLARSYSTEM_PLANETNUMBER, [max_planets](auto &rnd) {
+			return rnd.template uniform_int<uint8_t>(0, max_planets);
+		});
 }
 
 struct PlanetGeneratorDef {
@@ -184,10 +261,10 @@ constexpr float planet_chance_max()
 
 uint8_t UniverseGenerator::generate_planet_type(const uint64_t &pl_id)
 {
-	std::mt19937 rndgen(s_seed + pl_id + 256 * pl_id);
-	std::uniform_real_distribution<double> rnd(0.0f, planet_chance_max());
-
-	float chance_value = rnd(rndgen);
+	float chance_value = generate(s_seed + pl_id + 256 * pl_id, s_seed, pl_id,
+		RANDOM_STREAM_PLANET_TYPE, [](auto &rnd) {
+			return rnd.template uniform_real<double>(0.0f, planet_chance_max());
+		});
 	float chance_accumulator = 0.0f;
 
 	// Increment the accumulator with the current planet chance, when the accumulator was
@@ -209,21 +286,25 @@ double UniverseGenerator::generate_planet_distance(const uint64_t &pl_id,
 	assert(pg_defs[planet_type].distance_scaling_factor_min * 10 * 1000.0f * 1000.0f
 		   < ss->radius); // This should not happen
 
-	std::mt19937 rndgen(s_seed + pl_id + 1024 * pl_id);
 	// 10 Billion to max_distance km
-	std::uniform_real_distribution<double> rnd(10 * 1000.0f * 1000.0f *
-		pg_defs[planet_type].distance_scaling_factor_min, ss->radius);
-	return rnd(rndgen);
+	const double min_distance = 10 * 1000.0f * 1000.0f *
+		pg_defs[planet_type].distance_scaling_factor_min, max_distance = ss->radius;
+	return generate(s_seed + pl_id + 1024 * pl_id, s_seed, pl_id,
+		RANDOM_STREAM_PLANET_DISTANCE, [min_distance, max_distance](auto &rnd) {
+			return rnd.template uniform_real<double>(min_distance, max_distance);
+		});
 }
 
 double UniverseGenerator::generate_planet_radius(const uint64_t &pl_id,
 		const uint8_t planet_type)
 {
-	std::mt19937 rndgen(s_seed + pl_id + 512 * pl_id);
 	// 200 km to 100k km
-	std::uniform_real_distribution<double> rnd(200.0f * pg_defs[planet_type].radius_scaling_factor_min,
-			100 * 1000.0f * pg_defs[planet_type].radius_scaling_factor_max);
-	return rnd(rndgen);
+	const double min_radius = 200.0f * pg_defs[planet_type].radius_scaling_factor_min,
+		max_radius = 100 * 1000.0f * pg_defs[planet_type].radius_scaling_factor_max;
+	return generate(s_seed + pl_id + 512 * pl_id, s_seed, pl_id,
+		RANDOM_STREAM_PLANET_RADIUS, [min_radius, max_radius](auto &rnd) {
+			return rnd.template uniform_real<double>(min_radius, max_radius);
+		});
 }
 
 uint64_t UniverseGenerator::generate_seed()
@@ -233,23 +314,26 @@ uint64_t UniverseGenerator::generate_seed()
 	return rnd(rndgen);
 }
 
-float UniverseGenerator::generate_galaxypos_radius(const float min_radius,
-		const float max_radius)
-{
-	std::uniform_real_distribution<float> rnd(min_radius, max_radius);
-	return rnd(m_random_generator_galaxy_positions);
-}
-
-float UniverseGenerator::generate_galaxypos_gauss_random(const float param)
-{
-	std::normal_distribution<float> rnd(param);
-	return rnd(m_random_generator_galaxy_positions);
-}
-
-uint32_t UniverseGenerator::generate_galaxypos_urange(const uint32_t param)
+void UniverseGenerator::generate_solarsystem_galaxypos(const uint64_t &ss_id,
+		const GalaxyShape &shape, double &pos_x, double &pos_y, double &pos_z)
 {
-	std::uniform_int_distribution<uint32_t> rnd(0, param);
-	return rnd(m_random_generator_galaxy_positions);
+	const float scatter_theta = M_PI / shape.spiral_arms * 0.2,
+		scatter_radius = shape.min_radius * 0.4,
+		spiral_b = shape.spiral_angle_degrees / M_PI * shape.min_radius / shape.max_radius;
+
+	generate_stream(s_seed, ss_id, RANDOM_STREAM_SOLARSYSTEM_GALAXYPOS, [&](auto &rnd) {
+		float r = rnd.template uniform_real<float>(shape.min_radius, shape.max_radius);
+		float theta = spiral_b * log(r / shape.max_radius) +
+			rnd.template normal<float>(scatter_theta);
+		r += rnd.template normal<float>(scatter_radius);
+		// assign to a spiral arm
+		theta += rnd.template uniform_int<uint32_t>(0, shape.spiral_arms - 1) *
+			M_PI * 2 / shape.spiral_arms;
+		pos_x = cos(theta) * r;
+		pos_y = sin(theta) * r;
+		pos_z = rnd.template normal<float>(shape.thickness * 0.5f);
+		return true;
+	});
 }
 
 }
@@ -23,10 +23,34 @@
 #include <cassert>
 #include <random>
 #include "space.h"
+#include "../random_utils.h"
 
 namespace spacel {
 namespace engine {
 
+/*
+ * Galaxy shape parameters used to place solar systems on the spiral arms
+ */
+struct GalaxyShape
+{
+	uint8_t spiral_arms = 2;
+	uint16_t spiral_angle_degrees = 360;
+	float min_radius = 0.05f;
+	float max_radius = 0.9f;
+	float thickness = 0.1f;
+};
+
+/*
+ * Random backends. The counter backend is a stateless function of (seed, object id,
+ * attribute), MT19937 reproduces values from universes generated with a mt19937 per draw
+ */
+enum UniverseGeneratorBackend
+{
+	UNIVGEN_BACKEND_COUNTER,
+	UNIVGEN_BACKEND_MT19937,
+	UNIVGEN_BACKEND_COUNT,
+};
+
 class UniverseGenerator
 {
 public:
@@ -43,8 +67,14 @@ public:
 	}
 
 	inline static void SetSeed(uint64_t seed) { s_seed = seed; }
+	inline static uint64_t GetSeed() { return s_seed; }
+	inline static void SetBackend(UniverseGeneratorBackend backend) { s_backend = backend; }
+	inline static UniverseGeneratorBackend GetBackend() { return s_backend; }
 
 	std::string generate_world_name();
+	std::string generate_galaxy_name(const uint64_t &galaxy_id);
+	std::string generate_solarsystem_name(const uint64_t &ss_id);
+	std::string generate_planet_name(const uint64_t &pl_id);
 	uint8_t generate_solarsystem_type(const uint64_t &ss_id);
 	double generate_solarsystem_radius(const uint64_t &ss_id);
 	uint8_t generate_solarsystem_planetnumber(const SolarSystem *ss);
@@ -54,19 +84,16 @@ public:
 	double generate_planet_radius(const uint64_t &pl_id, const uint8_t planet_type);
 	static uint64_t generate_seed();
 
-	float generate_galaxypos_radius(const float min_radius, const float max_radius);
-	float generate_galaxypos_gauss_random(const float param);
-	uint32_t generate_galaxypos_urange(const uint32_t param);
+	void generate_solarsystem_galaxypos(const uint64_t &ss_id, const GalaxyShape &shape,
+			double &pos_x, double &pos_y, double &pos_z);
 private:
 	void InitRandomGeneratorIfNot();
 
 	bool m_random_generator_inited = false;
-	std::mt19937 m_random_generator;
-	std::mt19937 m_random_generator_galaxy_positions;
-	std::uniform_int_distribution<uint8_t> m_vowel_generator;
-	std::uniform_int_distribution<uint16_t> m_name_generators[4];
+	MT19937Random m_random_generator;
 	static UniverseGenerator *s_univgen;
 	static uint64_t s_seed;
+	static UniverseGeneratorBackend s_backend;
 };
 
 #define UnivGen UniverseGenerator::instance()
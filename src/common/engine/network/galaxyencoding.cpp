@@ -0,0 +1,209 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include "galaxyencoding.h"
+#include "networkprotocol.h"
+#include "../space.h"
+
+namespace spacel {
+namespace engine {
+namespace network {
+
+// log2 of solar system radius is stored on 12 bits between these bounds
+#define SOLAR_RADIUS_LOG2_MIN 30.0
+#define SOLAR_RADIUS_LOG2_MAX 46.0
+#define SOLAR_RADIUS_STEPS 4095.0
+
+bool GalaxyNameDictionary::Find(const std::string &name, uint32_t &index) const
+{
+	auto name_it = m_indexes.find(name);
+	if (name_it == m_indexes.end()) {
+		return false;
+	}
+
+	index = name_it->second;
+	return true;
+}
+
+uint32_t GalaxyNameDictionary::Add(const std::string &name)
+{
+	const uint32_t index = m_names.size();
+	m_names.push_back(name);
+	m_indexes[name] = index;
+	return index;
+}
+
+void GalaxyNameDictionary::Clear()
+{
+	m_indexes.clear();
+	m_names.clear();
+	Add("");
+}
+
+uint8_t varuint64_size(uint64_t value)
+{
+	uint8_t size = 1;
+	while (value >= 0x80) {
+		value >>= 7;
+		size++;
+	}
+
+	return size;
+}
+
+uint16_t encode_solar_type_radius(const uint8_t type, const double radius)
+{
+	assert(type < 16);
+	const double log_radius = std::log2(std::max(radius, 1.0));
+	const double step = std::round((log_radius - SOLAR_RADIUS_LOG2_MIN) /
+		(SOLAR_RADIUS_LOG2_MAX - SOLAR_RADIUS_LOG2_MIN) * SOLAR_RADIUS_STEPS);
+	const uint16_t radius_bits = std::max(std::min(step, SOLAR_RADIUS_STEPS), 0.0);
+	return (uint16_t) (type << 12) | radius_bits;
+}
+
+void decode_solar_type_radius(const uint16_t value, uint8_t &type, double &radius)
+{
+	type = value >> 12;
+	radius = std::exp2(SOLAR_RADIUS_LOG2_MIN + (value & 0x0FFF) / SOLAR_RADIUS_STEPS *
+		(SOLAR_RADIUS_LOG2_MAX - SOLAR_RADIUS_LOG2_MIN));
+}
+
+uint32_t galaxy_compact_entry_size(const uint64_t &id, const std::string &name,
+	const int64_t name_index)
+{
+	// The id delta is never bigger than the id
+	uint32_t size = varuint64_size(id) + sizeof(uint16_t) + 3 * sizeof(int16_t);
+	if (name_index >= 0) {
+		return size + varuint64_size(name_index);
+	}
+
+	// New names are also added to the packet dictionary, the index is at most 4 bytes
+	return size + name.size() + 1 + 4;
+}
+
+void write_galaxy_systems_compact(NetworkPacket *packet, const SolarSystemTable &solar_systems,
+	const std::vector<uint32_t> &rows, const std::vector<std::string> &row_names,
+	GalaxyNameDictionary &names)
+{
+	assert(rows.size() == row_names.size());
+	const std::vector<uint64_t> &ids = solar_systems.GetIds();
+	std::vector<uint32_t> order(rows.size());
+	for (uint32_t i = 0; i < order.size(); i++) {
+		order[i] = i;
+	}
+
+	std::sort(order.begin(), order.end(), [&ids, &rows](const uint32_t a, const uint32_t b) {
+		return ids[rows[a]] < ids[rows[b]];
+	});
+
+	// Register new names first, the client adds them before reading entries
+	std::vector<uint32_t> name_indexes(rows.size());
+	std::vector<std::string> new_names;
+	for (size_t i = 0; i < rows.size(); i++) {
+		const std::string &name = row_names[order[i]];
+		if (!names.Find(name, name_indexes[i])) {
+			name_indexes[i] = names.Add(name);
+			new_names.push_back(name);
+		}
+	}
+
+	packet->WriteVarUInt64(new_names.size());
+	for (const auto &name: new_names) {
+		packet->WriteString(Urho3D::String(name.c_str()));
+	}
+
+	packet->WriteVarUInt64(rows.size());
+	uint64_t previous_id = 0;
+	for (size_t i = 0; i < rows.size(); i++) {
+		const SolarSystemHandle ss = solar_systems[rows[order[i]]];
+		packet->WriteVarUInt64(ss.GetId() - previous_id);
+		packet->WriteUShort(encode_solar_type_radius(ss.GetType(), ss.GetRadius()));
+		packet->WriteFixed16(ss.GetPosX(), GALAXY_POSITION_RANGE);
+		packet->WriteFixed16(ss.GetPosY(), GALAXY_POSITION_RANGE);
+		packet->WriteFixed16(ss.GetPosZ(), GALAXY_POSITION_RANGE);
+		packet->WriteVarUInt64(name_indexes[i]);
+		previous_id = ss.GetId();
+	}
+}
+
+/*
+ * Add or update received solar systems, returns the number of read solar systems.
+ * Counts are checked against the remaining bytes, reads past the end return 0
+ */
+uint32_t read_galaxy_systems_compact(NetworkPacket *packet, SolarSystemTable &solar_systems,
+	GalaxyNameDictionary &names)
+{
+	// Names are null terminated, they take at least one byte
+	const uint64_t new_name_count = packet->ReadVarUInt64();
+	if (new_name_count > packet->GetSize() - packet->GetPosition()) {
+		// Corrupted packet
+		return 0;
+	}
+
+	for (uint64_t i = 0; i < new_name_count; i++) {
+		if (packet->IsEof()) {
+			return 0;
+		}
+
+		names.Add(std::string(packet->ReadString().CString()));
+	}
+
+	const uint64_t count = packet->ReadVarUInt64();
+	if (count > (packet->GetSize() - packet->GetPosition()) / GALAXY_COMPACT_ENTRY_MIN_SIZE) {
+		return 0;
+	}
+
+	uint64_t id = 0;
+	for (uint64_t i = 0; i < count; i++) {
+		if (packet->GetSize() - packet->GetPosition() < GALAXY_COMPACT_ENTRY_MIN_SIZE) {
+			// Truncated packet
+			return i;
+		}
+
+		id += packet->ReadVarUInt64();
+		uint8_t type;
+		double radius;
+		decode_solar_type_radius(packet->ReadUShort(), type, radius);
+		const double pos_x = packet->ReadFixed16(GALAXY_POSITION_RANGE);
+		const double pos_y = packet->ReadFixed16(GALAXY_POSITION_RANGE);
+		const double pos_z = packet->ReadFixed16(GALAXY_POSITION_RANGE);
+		const uint64_t name_index = packet->ReadVarUInt64();
+		if (name_index >= names.size() || type >= SOLAR_TYPE_MAX) {
+			// Corrupted packet
+			return i;
+		}
+
+		uint32_t row;
+		if (!solar_systems.Find(id, row)) {
+			row = solar_systems.Add(id);
+		}
+
+		solar_systems.Set(row, (SolarType) type, radius, pos_x, pos_y, pos_z);
+		solar_systems.SetName(row, names.Get(name_index));
+	}
+
+	return count;
+}
+
+}
+}
+}
@@ -0,0 +1,84 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace spacel {
+namespace engine {
+
+class SolarSystemTable;
+
+namespace network {
+
+class NetworkPacket;
+
+// Solar system positions are normalized galaxy coordinates
+#define GALAXY_POSITION_RANGE 2.0
+// Smallest compact entry: one byte id delta, radius, position and name index
+#define GALAXY_COMPACT_ENTRY_MIN_SIZE (1 + sizeof(uint16_t) + 3 * sizeof(int16_t) + 1)
+
+/*
+ * Names sent to a session. Server and client append names in the same order, entries
+ * then refer to names by index. Index 0 is the empty name, used for derived names
+ */
+class GalaxyNameDictionary
+{
+public:
+	GalaxyNameDictionary() { Clear(); }
+
+	bool Find(const std::string &name, uint32_t &index) const;
+	uint32_t Add(const std::string &name);
+	const std::string &Get(const uint32_t index) const { return m_names[index]; }
+	const uint32_t size() const { return m_names.size(); }
+	void Clear();
+
+private:
+	std::unordered_map<std::string, uint32_t> m_indexes;
+	std::vector<std::string> m_names;
+};
+
+/*
+ * Compact SMSG_GALAXY_SYSTEMS_COMPACT encoding:
+ *   varint new name count, then new null terminated names
+ *   varint entry count, then entries sorted by id:
+ *     varint id delta, uint16 type (4 bits) and log radius (12 bits),
+ *     3 * int16 fixed point position, varint name index
+ */
+uint8_t varuint64_size(uint64_t value);
+uint16_t encode_solar_type_radius(const uint8_t type, const double radius);
+void decode_solar_type_radius(const uint16_t value, uint8_t &type, double &radius);
+
+// Upper bound of the entry size, the name is not in the dictionary if name_index is -1
+uint32_t galaxy_compact_entry_size(const uint64_t &id, const std::string &name,
+	const int64_t name_index);
+// row_names are the stored names of the rows
+void write_galaxy_systems_compact(NetworkPacket *packet, const SolarSystemTable &solar_systems,
+	const std::vector<uint32_t> &rows, const std::vector<std::string> &row_names,
+	GalaxyNameDictionary &names);
+uint32_t read_galaxy_systems_compact(NetworkPacket *packet, SolarSystemTable &solar_systems,
+	GalaxyNameDictionary &names);
+
+}
+}
+}
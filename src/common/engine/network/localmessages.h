@@ -0,0 +1,87 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "networkprotocol.h"
+#include "packetpool.h"
+#include "../space.h"
+
+namespace spacel {
+namespace engine {
+namespace network {
+
+/*
+ * Messages passed as is between the client and the server of the same process. Their
+ * packets keep the opcode, go through the same queues and are routed by the same
+ * handler tables, handlers only skip the payload deserialization
+ */
+
+struct GalaxySystemEntry
+{
+	uint64_t id;
+	SolarType type;
+	double radius;
+	double pos_x;
+	double pos_y;
+	double pos_z;
+	// Empty for derived names
+	std::string name;
+};
+
+// SMSG_GALAXY_SYSTEMS
+struct GalaxySystemsMessage: public LocalMessage
+{
+	std::vector<GalaxySystemEntry> systems;
+};
+
+// SMSG_GALAXY_SYSTEMS_REMOVE
+struct GalaxySystemsRemoveMessage: public LocalMessage
+{
+	std::vector<uint64_t> ids;
+};
+
+// CMSG_PLAYER_POSITION
+struct PlayerPositionMessage: public LocalMessage
+{
+	PlayerPositionMessage(const double x, const double y, const double z):
+		pos_x(x), pos_y(y), pos_z(z) {}
+
+	double pos_x;
+	double pos_y;
+	double pos_z;
+};
+
+/*
+ * Acquire a pooled packet carrying message, the payload is left empty
+ */
+template <typename T>
+inline NetworkPacket *make_local_packet(const uint16_t opcode, std::shared_ptr<T> message)
+{
+	NetworkPacket *packet = PacketPool::instance()->Acquire(opcode);
+	packet->SetLocalMessage(std::move(message));
+	return packet;
+}
+
+}
+}
+}
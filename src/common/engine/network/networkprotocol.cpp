@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include "networkprotocol.h"
 
@@ -10,6 +12,16 @@ NetworkPacket::NetworkPacket(const uint16_t o): Deserializer(2)
 	WriteUShort(o);
 }
 
+void NetworkPacket::Reset(const uint16_t o)
+{
+	buffer_.clear();
+	size_ = 0;
+	position_ = 0;
+	m_local_message.reset();
+	m_session_id = 0;
+	WriteUShort(o);
+}
+
 unsigned NetworkPacket::Read(void *dest, unsigned size)
 {
 	if (size + position_ > size_) {
@@ -20,28 +32,8 @@ unsigned NetworkPacket::Read(void *dest, unsigned size)
 		return 0;
 	}
 
-	unsigned char *srcPtr = &buffer_[position_];
-	unsigned char *destPtr = (unsigned char *)dest;
+	memcpy(dest, &buffer_[position_], size);
 	position_ += size;
-
-	unsigned copySize = size;
-	while (copySize >= sizeof(unsigned)) {
-		memmove(destPtr, srcPtr, sizeof(unsigned));
-		srcPtr += sizeof(unsigned);
-		destPtr += sizeof(unsigned);
-		copySize -= sizeof(unsigned);
-	}
-
-	if (copySize & sizeof(unsigned short)) {
-		memmove(destPtr, srcPtr, sizeof(unsigned short));
-		srcPtr += sizeof(unsigned short);
-		destPtr += sizeof(unsigned short);
-	}
-
-	if (copySize & 1) {
-		memmove(destPtr, srcPtr, 1);
-	}
-
 	return size;
 }
 
@@ -67,33 +59,61 @@ unsigned NetworkPacket::Seek(unsigned position)
 
 unsigned NetworkPacket::Write(const void *data, unsigned size)
 {
+	if (!size) {
+		return 0;
+	}
+
 	if (size + position_ > buffer_.size()) {
-		buffer_.resize(size + position_);
-		size_ = size + position_;
+		Grow(size + position_);
 	}
 
-	unsigned char *srcPtr = (unsigned char *)data;
-	unsigned copySize = size;
+	memcpy(&buffer_[position_], data, size);
+	position_ += size;
+	return size;
+}
 
-	while (copySize >= sizeof(unsigned)) {
-		memmove(&buffer_[position_], srcPtr, sizeof(unsigned));
-		srcPtr += sizeof(unsigned);
-		copySize -= sizeof(unsigned);
-		position_ += sizeof(unsigned);
+void NetworkPacket::WriteVarUInt64(uint64_t value)
+{
+	uint8_t bytes[10];
+	uint8_t count = 0;
+	while (value >= 0x80) {
+		bytes[count++] = (uint8_t) (value & 0x7F) | 0x80;
+		value >>= 7;
 	}
 
-	if (copySize & sizeof(unsigned short)) {
-		memmove(&buffer_[position_], srcPtr, sizeof(unsigned short));
-		srcPtr += sizeof(unsigned short);
-		position_ += sizeof(unsigned short);
+	bytes[count++] = (uint8_t) value;
+	Write(bytes, count);
+}
+
+uint64_t NetworkPacket::ReadVarUInt64()
+{
+	uint64_t value = 0;
+	for (uint8_t shift = 0; shift < 64 && !IsEof(); shift += 7) {
+		const uint8_t byte = ReadUByte();
+		value |= (uint64_t) (byte & 0x7F) << shift;
+		if (!(byte & 0x80)) {
+			break;
+		}
 	}
 
-	if (copySize & 1) {
-		memmove(&buffer_[position_], srcPtr, 1);
-		position_++;
+	return value;
+}
+
+void NetworkPacket::WriteFixed16(const double value, const double range)
+{
+	const double scaled = std::round(value / range * INT16_MAX);
+	// NaN is written as the origin, casting it is undefined
+	if (std::isnan(scaled)) {
+		WriteShort(0);
+		return;
 	}
 
-	return size;
+	WriteShort((int16_t) std::max<double>(std::min<double>(scaled, INT16_MAX), -INT16_MAX));
+}
+
+double NetworkPacket::ReadFixed16(const double range)
+{
+	return (double) ReadShort() * range / INT16_MAX;
 }
 
 }
@@ -19,9 +19,14 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
 #include <stddef.h>
 #include <stdint.h>
 #include <Urho3D/IO/MemoryBuffer.h>
+#include <utility>
 #include <vector>
 
 namespace spacel {
@@ -31,12 +36,63 @@ class Server;
 
 namespace network {
 
+/*
+ * Typed message attached to a packet by in-process senders, see localmessages.h.
+ * Handlers use it instead of deserializing the packet payload
+ */
+struct LocalMessage
+{
+	virtual ~LocalMessage() {}
+};
+
+typedef std::shared_ptr<const LocalMessage> LocalMessagePtr;
+
+/*
+ * Allocator default-initialising the new elements, growing a byte buffer leaves them
+ * uninitialised instead of zeroing bytes which are overwritten right after
+ */
+template <typename T>
+struct DefaultInitAllocator: public std::allocator<T>
+{
+	template <typename U>
+	struct rebind { typedef DefaultInitAllocator<U> other; };
+
+	DefaultInitAllocator() = default;
+	template <typename U>
+	DefaultInitAllocator(const DefaultInitAllocator<U> &) {}
+
+	template <typename U>
+	void construct(U *p) { ::new (static_cast<void *>(p)) U; }
+	template <typename U, typename... Args>
+	void construct(U *p, Args &&... args)
+	{
+		::new (static_cast<void *>(p)) U(std::forward<Args>(args)...);
+	}
+};
+
 class NetworkPacket: public Urho3D::Deserializer, public Urho3D::Serializer
 {
 public:
 	NetworkPacket(const uint16_t o);
 
 	const uint16_t GetOpcode();
+	// Empty the packet and write a new opcode, the buffer memory is kept
+	void Reset(const uint16_t o);
+	void Reserve(const unsigned size) { buffer_.reserve(size); }
+	const unsigned GetCapacity() const { return buffer_.capacity(); }
+	/// Opcode and payload bytes, GetSize() long.
+	const unsigned char *GetData() const { return buffer_.data(); }
+	const uint32_t GetSessionId() const { return m_session_id; }
+	void SetSessionId(const uint32_t session_id) { m_session_id = session_id; }
+
+	/// Attach a typed message, only for packets which don't leave the process.
+	void SetLocalMessage(const LocalMessagePtr &message) { m_local_message = message; }
+	/// Attached message if it has type T, nullptr otherwise.
+	template <typename T>
+	const T *GetLocalMessage() const
+	{
+		return dynamic_cast<const T *>(m_local_message.get());
+	}
 
 	/// Read bytes from the memory area. Return number of bytes actually read.
 	virtual unsigned Read(void *dest, unsigned size);
@@ -45,11 +101,79 @@ public:
 	/// Write bytes to the memory area.
 	virtual unsigned Write(const void *data, unsigned size);
 
+	/// Fixed width fast paths, one copy without going through the virtual Read/Write.
+	bool WriteUByte(const uint8_t value) { return WritePod(value); }
+	bool WriteUShort(const uint16_t value) { return WritePod(value); }
+	bool WriteShort(const int16_t value) { return WritePod(value); }
+	bool WriteUInt(const uint32_t value) { return WritePod(value); }
+	bool WriteInt(const int32_t value) { return WritePod(value); }
+	bool WriteUInt64(const uint64_t value) { return WritePod(value); }
+	bool WriteFloat(const float value) { return WritePod(value); }
+	bool WriteDouble(const double value) { return WritePod(value); }
+	uint8_t ReadUByte() { return ReadPod<uint8_t>(); }
+	uint16_t ReadUShort() { return ReadPod<uint16_t>(); }
+	int16_t ReadShort() { return ReadPod<int16_t>(); }
+	uint32_t ReadUInt() { return ReadPod<uint32_t>(); }
+	int32_t ReadInt() { return ReadPod<int32_t>(); }
+	uint64_t ReadUInt64() { return ReadPod<uint64_t>(); }
+	float ReadFloat() { return ReadPod<float>(); }
+	double ReadDouble() { return ReadPod<double>(); }
+
+	/// Write an unsigned integer using 7 bits per byte, small values take less space.
+	void WriteVarUInt64(uint64_t value);
+	/// Read an unsigned integer written by WriteVarUInt64.
+	uint64_t ReadVarUInt64();
+	/// Write a value in [-range, range] as a 16 bits fixed point, outside values are clamped.
+	void WriteFixed16(const double value, const double range);
+	/// Read a value written by WriteFixed16.
+	double ReadFixed16(const double range);
+
 private:
+	/// Make the buffer hold at least size bytes, the capacity grows geometrically and
+	/// the new bytes are left uninitialised.
+	inline void Grow(const unsigned size)
+	{
+		if (size > buffer_.capacity()) {
+			buffer_.reserve(std::max<size_t>(size, buffer_.capacity() * 2));
+		}
+
+		buffer_.resize(size);
+		size_ = size;
+	}
+
+	template <typename T>
+	inline bool WritePod(const T value)
+	{
+		const unsigned end = position_ + sizeof(T);
+		if (end > buffer_.size()) {
+			Grow(end);
+		}
+
+		memcpy(&buffer_[position_], &value, sizeof(T));
+		position_ = end;
+		return true;
+	}
+
+	template <typename T>
+	inline T ReadPod()
+	{
+		T value = T();
+		if (position_ + sizeof(T) <= size_) {
+			memcpy(&value, &buffer_[position_], sizeof(T));
+			position_ += sizeof(T);
+		} else {
+			// Truncated packet, read what remains
+			Read(&value, sizeof(T));
+		}
+
+		return value;
+	}
+
 	uint32_t m_session_id = 0;
+	LocalMessagePtr m_local_message;
 
-	/// Pointer to the memory area.
-	std::vector<unsigned char> buffer_;
+	/// Memory area, its size is size_.
+	std::vector<unsigned char, DefaultInitAllocator<unsigned char>> buffer_;
 };
 
 enum PacketOpcode
@@ -68,6 +192,9 @@ enum PacketOpcode
 	CMSG_CHARACTER_CONNECT,
 	SMSG_KICK,
 	SMSG_GALAXY_SYSTEMS,
+	CMSG_PLAYER_POSITION,
+	SMSG_GALAXY_SYSTEMS_REMOVE,
+	SMSG_GALAXY_SYSTEMS_COMPACT,
 	MSG_MAX,
 };
 
@@ -0,0 +1,95 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "opcodemetrics.h"
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <vector>
+
+namespace spacel {
+namespace engine {
+namespace network {
+
+void PacketRouterMetrics::Record(const uint16_t opcode, const char *name, const uint32_t size,
+	const uint64_t latency_ns)
+{
+	assert(opcode < MSG_MAX);
+	OpcodeMetrics &metrics = m_opcodes[opcode];
+	if (!metrics.name.load(std::memory_order_relaxed)) {
+		metrics.name.store(name, std::memory_order_relaxed);
+	}
+	metrics.size.Record(size);
+	metrics.latency.Record(latency_ns);
+}
+
+void PacketRouterMetrics::Reset()
+{
+	for (OpcodeMetrics &metrics: m_opcodes) {
+		metrics.size.Reset();
+		metrics.latency.Reset();
+	}
+}
+
+void PacketRouterMetrics::WriteReport(std::ostream &os) const
+{
+	std::vector<uint16_t> opcodes;
+	uint64_t total_time = 0, total_bytes = 0;
+	for (uint16_t opcode = 0; opcode < MSG_MAX; opcode++) {
+		if (m_opcodes[opcode].latency.GetCount() == 0) {
+			continue;
+		}
+
+		opcodes.push_back(opcode);
+		total_time += m_opcodes[opcode].latency.GetTotal();
+		total_bytes += m_opcodes[opcode].size.GetTotal();
+	}
+
+	std::sort(opcodes.begin(), opcodes.end(), [this] (uint16_t a, uint16_t b) {
+		return m_opcodes[a].latency.GetTotal() > m_opcodes[b].latency.GetTotal();
+	});
+
+	os << std::left << std::setw(28) << "opcode" << std::right << std::setw(10) << "count"
+		<< std::setw(8) << "time%" << std::setw(10) << "p50 us" << std::setw(10) << "p99 us"
+		<< std::setw(10) << "p999 us" << std::setw(10) << "max us" << std::setw(8) << "bytes%"
+		<< std::setw(10) << "p50 B" << std::setw(10) << "p99 B" << std::setw(10) << "max B"
+		<< std::endl;
+	os << std::fixed << std::setprecision(1);
+	for (const uint16_t opcode: opcodes) {
+		const OpcodeMetrics &metrics = m_opcodes[opcode];
+		const char *name = metrics.name.load(std::memory_order_relaxed);
+		os << std::left << std::setw(28) << (name ? name : "?") << std::right
+			<< std::setw(10) << metrics.latency.GetCount()
+			<< std::setw(8) << (total_time ?
+				100.0 * metrics.latency.GetTotal() / total_time : 0.0)
+			<< std::setw(10) << metrics.latency.GetPercentile(50) / 1000.0
+			<< std::setw(10) << metrics.latency.GetPercentile(99) / 1000.0
+			<< std::setw(10) << metrics.latency.GetPercentile(99.9) / 1000.0
+			<< std::setw(10) << metrics.latency.GetMax() / 1000.0
+			<< std::setw(8) << (total_bytes ?
+				100.0 * metrics.size.GetTotal() / total_bytes : 0.0)
+			<< std::setw(10) << metrics.size.GetPercentile(50)
+			<< std::setw(10) << metrics.size.GetPercentile(99)
+			<< std::setw(10) << metrics.size.GetMax() << std::endl;
+	}
+}
+
+}
+}
+}
@@ -0,0 +1,66 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include "networkprotocol.h"
+#include "../../histogram.h"
+
+namespace spacel {
+namespace engine {
+namespace network {
+
+struct OpcodeMetrics
+{
+	// Handler name, set on the first routed packet
+	std::atomic<const char *> name{nullptr};
+	// Opcode and payload bytes
+	Histogram size;
+	// Handler duration in nanoseconds
+	Histogram latency;
+};
+
+/*
+ * Count, size and handler latency of the routed packets, by opcode. Recorded by the routing
+ * thread, readable from any thread
+ */
+class PacketRouterMetrics
+{
+public:
+	PacketRouterMetrics() {}
+	~PacketRouterMetrics() {}
+
+	void Record(const uint16_t opcode, const char *name, const uint32_t size,
+		const uint64_t latency_ns);
+	const OpcodeMetrics &Get(const uint16_t opcode) const { return m_opcodes[opcode]; }
+	void Reset();
+
+	// One line by routed opcode, sorted by total handler time
+	void WriteReport(std::ostream &os) const;
+
+private:
+	OpcodeMetrics m_opcodes[MSG_MAX];
+};
+
+}
+}
+}
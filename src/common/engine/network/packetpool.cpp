@@ -0,0 +1,157 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include "packetpool.h"
+
+namespace spacel {
+namespace engine {
+namespace network {
+
+static inline uint32_t size_class_capacity(const uint8_t size_class)
+{
+	return PACKET_POOL_MIN_BUFFER_SIZE << (2 * size_class);
+}
+
+PacketPool::PacketPool()
+{
+	for (auto &size_hint: m_size_hints) {
+		size_hint.store(PACKET_POOL_MIN_BUFFER_SIZE, std::memory_order_relaxed);
+	}
+}
+
+PacketPool::~PacketPool()
+{
+	for (auto &size_class: m_size_classes) {
+		for (NetworkPacket *packet: size_class.free_packets) {
+			delete packet;
+		}
+	}
+}
+
+/*
+ * Local static, the pool is used by the client, server and network threads
+ */
+PacketPool *PacketPool::instance()
+{
+	static PacketPool pool;
+	return &pool;
+}
+
+NetworkPacket *PacketPool::Acquire(const uint16_t opcode)
+{
+	return Acquire(opcode, GetSizeHint(opcode));
+}
+
+NetworkPacket *PacketPool::Acquire(const uint16_t opcode, const uint32_t size_hint)
+{
+	// Smallest size class holding size_hint bytes
+	uint8_t class_index = 0;
+	while (class_index < PACKET_POOL_SIZE_CLASSES - 1 &&
+		size_class_capacity(class_index) < size_hint) {
+		class_index++;
+	}
+
+	NetworkPacket *packet = nullptr;
+	{
+		SizeClass &size_class = m_size_classes[class_index];
+		std::lock_guard<std::mutex> lock(size_class.mutex);
+		if (!size_class.free_packets.empty()) {
+			packet = size_class.free_packets.back();
+			size_class.free_packets.pop_back();
+		}
+	}
+
+	if (packet) {
+		m_reused_count.fetch_add(1, std::memory_order_relaxed);
+		packet->Reset(opcode);
+		return packet;
+	}
+
+	m_allocated_count.fetch_add(1, std::memory_order_relaxed);
+	packet = new NetworkPacket(opcode);
+	packet->Reserve(std::max(size_class_capacity(class_index), size_hint));
+	return packet;
+}
+
+void PacketPool::Release(NetworkPacket *packet)
+{
+	if (!packet) {
+		return;
+	}
+
+	// Remember how big packets of this opcode are, slowly forgetting old big ones
+	const uint16_t opcode = packet->GetSize() >= sizeof(uint16_t) ? packet->GetOpcode() : MSG_MAX;
+	if (opcode < MSG_MAX) {
+		const uint32_t size_hint = m_size_hints[opcode].load(std::memory_order_relaxed);
+		m_size_hints[opcode].store(std::max<uint32_t>(packet->GetSize(),
+			size_hint - size_hint / 8), std::memory_order_relaxed);
+	}
+
+	// Biggest size class the buffer can hold, too big buffers are not kept
+	const unsigned capacity = packet->GetCapacity();
+	if (capacity > size_class_capacity(PACKET_POOL_SIZE_CLASSES - 1) * 2) {
+		delete packet;
+		return;
+	}
+
+	uint8_t class_index = 0;
+	while (class_index < PACKET_POOL_SIZE_CLASSES - 1 &&
+		size_class_capacity(class_index + 1) <= capacity) {
+		class_index++;
+	}
+
+	// Attached messages can hold a lot of memory, don't keep them in the pool
+	packet->SetLocalMessage(nullptr);
+
+	if (capacity < size_class_capacity(class_index)) {
+		packet->Reserve(size_class_capacity(class_index));
+	}
+
+	SizeClass &size_class = m_size_classes[class_index];
+	{
+		std::lock_guard<std::mutex> lock(size_class.mutex);
+		if (size_class.free_packets.size() < PACKET_POOL_MAX_FREE_PACKETS) {
+			size_class.free_packets.push_back(packet);
+			return;
+		}
+	}
+
+	delete packet;
+}
+
+const uint32_t PacketPool::GetSizeHint(const uint16_t opcode) const
+{
+	if (opcode >= MSG_MAX) {
+		return PACKET_POOL_MIN_BUFFER_SIZE;
+	}
+
+	return m_size_hints[opcode].load(std::memory_order_relaxed);
+}
+
+void PacketPool::SetSizeHint(const uint16_t opcode, const uint32_t size_hint)
+{
+	if (opcode < MSG_MAX) {
+		m_size_hints[opcode].store(size_hint, std::memory_order_relaxed);
+	}
+}
+
+}
+}
+}
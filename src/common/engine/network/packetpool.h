@@ -0,0 +1,85 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "networkprotocol.h"
+
+namespace spacel {
+namespace engine {
+namespace network {
+
+// Buffer size classes are 64, 256, 1K, 4K, 16K and 64K bytes
+#define PACKET_POOL_SIZE_CLASSES 6
+#define PACKET_POOL_MIN_BUFFER_SIZE 64
+// Free packets kept per size class, the others are deleted
+#define PACKET_POOL_MAX_FREE_PACKETS 256
+
+/*
+ * Recycled packets sorted by buffer capacity. Packets can be acquired and released from
+ * any thread. Acquired packets reserve the usual size of their opcode, learnt from
+ * released packets, to avoid growing buffers while writing
+ */
+class PacketPool
+{
+public:
+	PacketPool();
+	~PacketPool();
+
+	static PacketPool *instance();
+
+	NetworkPacket *Acquire(const uint16_t opcode);
+	NetworkPacket *Acquire(const uint16_t opcode, const uint32_t size_hint);
+	void Release(NetworkPacket *packet);
+
+	const uint32_t GetSizeHint(const uint16_t opcode) const;
+	void SetSizeHint(const uint16_t opcode, const uint32_t size_hint);
+
+	const uint64_t GetAllocatedCount() const { return m_allocated_count; }
+	const uint64_t GetReusedCount() const { return m_reused_count; }
+
+private:
+	struct SizeClass
+	{
+		std::mutex mutex;
+		std::vector<NetworkPacket *> free_packets;
+	};
+
+	SizeClass m_size_classes[PACKET_POOL_SIZE_CLASSES];
+	std::atomic<uint32_t> m_size_hints[MSG_MAX];
+	std::atomic<uint64_t> m_allocated_count{0};
+	std::atomic<uint64_t> m_reused_count{0};
+};
+
+struct PacketReleaser
+{
+	void operator()(NetworkPacket *packet) const { PacketPool::instance()->Release(packet); }
+};
+
+// Received packet, given back to the pool once processed
+typedef std::unique_ptr<NetworkPacket, PacketReleaser> NetworkPacketPtr;
+
+}
+}
+}
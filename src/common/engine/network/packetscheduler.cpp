@@ -0,0 +1,101 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include "packetscheduler.h"
+#include "networkprotocol.h"
+#include "packetpool.h"
+
+namespace spacel {
+namespace engine {
+namespace network {
+
+PacketScheduler::~PacketScheduler()
+{
+	for (auto &session_queue: m_session_queues) {
+		for (NetworkPacket *packet: session_queue.second) {
+			PacketPool::instance()->Release(packet);
+		}
+	}
+}
+
+bool PacketScheduler::Push(NetworkPacket *packet)
+{
+	std::deque<NetworkPacket *> &session_queue = m_session_queues[packet->GetSessionId()];
+	// The session sends faster than its share of the ticks, don't let it fill the
+	// server queues
+	if (m_max_session_packets && session_queue.size() >= m_max_session_packets) {
+		PacketPool::instance()->Release(packet);
+		m_dropped_count++;
+		return false;
+	}
+
+	if (session_queue.empty()) {
+		m_ready_sessions.push_back(packet->GetSessionId());
+	}
+
+	session_queue.push_back(packet);
+	m_pending_count++;
+	return true;
+}
+
+NetworkPacket *PacketScheduler::Pop()
+{
+	if (m_ready_sessions.empty()) {
+		return nullptr;
+	}
+
+	const uint32_t session_id = m_ready_sessions.front();
+	m_ready_sessions.pop_front();
+
+	auto session_queue_it = m_session_queues.find(session_id);
+	NetworkPacket *packet = session_queue_it->second.front();
+	session_queue_it->second.pop_front();
+	m_pending_count--;
+
+	// The session goes back at the end of the round
+	if (session_queue_it->second.empty()) {
+		m_session_queues.erase(session_queue_it);
+	} else {
+		m_ready_sessions.push_back(session_id);
+	}
+
+	return packet;
+}
+
+void PacketScheduler::RemoveSession(const uint32_t session_id)
+{
+	auto session_queue_it = m_session_queues.find(session_id);
+	if (session_queue_it == m_session_queues.end()) {
+		return;
+	}
+
+	for (NetworkPacket *packet: session_queue_it->second) {
+		PacketPool::instance()->Release(packet);
+	}
+
+	m_pending_count -= session_queue_it->second.size();
+	m_session_queues.erase(session_queue_it);
+	m_ready_sessions.erase(std::remove(m_ready_sessions.begin(), m_ready_sessions.end(),
+		session_id), m_ready_sessions.end());
+}
+
+}
+}
+}
@@ -0,0 +1,68 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+
+namespace spacel {
+namespace engine {
+namespace network {
+
+class NetworkPacket;
+
+/*
+ * Received packets waiting to be processed, grouped by session. Pop returns packets
+ * round-robin between sessions, a flooding session only delays its own packets.
+ * With max_session_packets, the packets of a session beyond this count are dropped
+ */
+class PacketScheduler
+{
+public:
+	PacketScheduler(const size_t max_session_packets = 0):
+		m_max_session_packets(max_session_packets) {}
+	~PacketScheduler();
+
+	// Takes the packet ownership, returns false if it was dropped
+	bool Push(NetworkPacket *packet);
+	// Next packet to process, nullptr if there is none. The caller owns the packet
+	NetworkPacket *Pop();
+	// Drop pending packets of a session
+	void RemoveSession(const uint32_t session_id);
+
+	const size_t GetPendingCount() const { return m_pending_count; }
+	const size_t GetSessionCount() const { return m_ready_sessions.size(); }
+	const uint64_t GetDroppedCount() const { return m_dropped_count; }
+
+private:
+	// 0 if sessions have no limit
+	const size_t m_max_session_packets;
+	std::unordered_map<uint32_t, std::deque<NetworkPacket *>> m_session_queues;
+	// Sessions with pending packets, in round-robin order
+	std::deque<uint32_t> m_ready_sessions;
+	size_t m_pending_count = 0;
+	uint64_t m_dropped_count = 0;
+};
+
+}
+}
+}
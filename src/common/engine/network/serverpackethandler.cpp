@@ -41,6 +41,9 @@ const SMsgHandler smsgHandlerTable[MSG_MAX] = {
 	{"CMSG_CHARACTER_CONNECT", SESSION_STATE_CONNECTED, &Server::handlePacket_CharacterConnect},
 	null_command_handler,
 	null_command_handler,
+	{"CMSG_PLAYER_POSITION", SESSION_STATE_AUTHED, &Server::handlePacket_PlayerPosition},
+	null_command_handler,
+	null_command_handler,
 };
 }
 }
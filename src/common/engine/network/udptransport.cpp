@@ -0,0 +1,622 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "udptransport.h"
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <random>
+#include <Urho3D/IO/Log.h>
+#include "packetpool.h"
+#include "../server.h"
+
+namespace spacel {
+namespace engine {
+namespace network {
+
+// Sending queue batch popped by the server network thread
+#define UDP_SERVER_SEND_BATCH_SIZE 256
+// Idle wait of the server network thread, also the session expiration period
+#define UDP_SERVER_POLL_TIMEOUT_MS 100
+
+static inline uint64_t address_key(const sockaddr_in &address)
+{
+	return ((uint64_t) address.sin_addr.s_addr << 16) | address.sin_port;
+}
+
+static inline uint64_t rotl64(const uint64_t value, const uint8_t bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+/*
+ * SipHash-2-4 of two words, the result can't be guessed without the key
+ */
+static uint64_t siphash24(const uint64_t key[2], const uint64_t m0, const uint64_t m1)
+{
+	uint64_t v0 = key[0] ^ 0x736f6d6570736575ULL, v1 = key[1] ^ 0x646f72616e646f6dULL,
+		v2 = key[0] ^ 0x6c7967656e657261ULL, v3 = key[1] ^ 0x7465646279746573ULL;
+	auto round = [&v0, &v1, &v2, &v3] () {
+		v0 += v1;
+		v1 = rotl64(v1, 13) ^ v0;
+		v0 = rotl64(v0, 32);
+		v2 += v3;
+		v3 = rotl64(v3, 16) ^ v2;
+		v0 += v3;
+		v3 = rotl64(v3, 21) ^ v0;
+		v2 += v1;
+		v1 = rotl64(v1, 17) ^ v2;
+		v2 = rotl64(v2, 32);
+	};
+
+	// Message words, then the final block holding the message length
+	const uint64_t blocks[3] = { m0, m1, (uint64_t) 16 << 56 };
+	for (const uint64_t block: blocks) {
+		v3 ^= block;
+		round();
+		round();
+		v0 ^= block;
+	}
+
+	v2 ^= 0xff;
+	for (uint8_t i = 0; i < 4; i++) {
+		round();
+	}
+
+	return v0 ^ v1 ^ v2 ^ v3;
+}
+
+static inline uint64_t cookie_period(const std::chrono::steady_clock::time_point &now)
+{
+	return (uint64_t) std::chrono::duration_cast<std::chrono::seconds>(
+		now.time_since_epoch()).count() / UDP_COOKIE_PERIOD;
+}
+
+UDPTransport::UDPTransport(const PacketHandler &handler):
+	m_handler(handler), m_recv_buffer(UDP_RECV_BATCH_SIZE * UDP_MAX_DATAGRAM_SIZE)
+{
+	memset(&m_peer, 0, sizeof(m_peer));
+
+	std::random_device device;
+	for (uint64_t &key: m_cookie_key) {
+		key = ((uint64_t) device() << 32) | device();
+	}
+}
+
+UDPTransport::~UDPTransport()
+{
+	if (m_socket != -1) {
+		close(m_socket);
+	}
+
+	if (m_epoll != -1) {
+		close(m_epoll);
+	}
+
+	if (m_wakeup != -1) {
+		close(m_wakeup);
+	}
+}
+
+bool UDPTransport::OpenSocket()
+{
+	m_socket = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	m_epoll = epoll_create1(EPOLL_CLOEXEC);
+	m_wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (m_socket == -1 || m_epoll == -1 || m_wakeup == -1) {
+		URHO3D_LOGERRORF("Unable to create UDP transport: %s", strerror(errno));
+		return false;
+	}
+
+	// Bigger kernel buffers absorb bursts between two polls
+	const int buffer_size = 4 * 1024 * 1024;
+	setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+	setsockopt(m_socket, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+
+	epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.fd = m_socket;
+	epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_socket, &event);
+	event.data.fd = m_wakeup;
+	epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &event);
+	return true;
+}
+
+bool UDPTransport::Listen(const uint16_t port, const bool loopback_only)
+{
+	if (!OpenSocket()) {
+		return false;
+	}
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(loopback_only ? INADDR_LOOPBACK : INADDR_ANY);
+	if (bind(m_socket, (sockaddr *) &address, sizeof(address)) == -1) {
+		URHO3D_LOGERRORF("Unable to listen on UDP port %d: %s", port, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+bool UDPTransport::Connect(const std::string &address, const uint16_t port)
+{
+	if (!OpenSocket()) {
+		return false;
+	}
+
+	m_peer.sin_family = AF_INET;
+	m_peer.sin_port = htons(port);
+	if (inet_pton(AF_INET, address.c_str(), &m_peer.sin_addr) != 1) {
+		URHO3D_LOGERRORF("Invalid server address %s", address.c_str());
+		return false;
+	}
+
+	// Only datagrams from the server are received
+	if (connect(m_socket, (sockaddr *) &m_peer, sizeof(m_peer)) == -1) {
+		URHO3D_LOGERRORF("Unable to connect to %s:%d: %s", address.c_str(), port,
+			strerror(errno));
+		return false;
+	}
+
+	m_connected = true;
+	return true;
+}
+
+const uint16_t UDPTransport::GetLocalPort() const
+{
+	sockaddr_in address;
+	socklen_t address_len = sizeof(address);
+	if (getsockname(m_socket, (sockaddr *) &address, &address_len) == -1) {
+		return 0;
+	}
+
+	return ntohs(address.sin_port);
+}
+
+void UDPTransport::Wakeup()
+{
+	const uint64_t value = 1;
+	if (write(m_wakeup, &value, sizeof(value)) == -1) {
+		// Counter is already set, Poll will wake up
+	}
+}
+
+size_t UDPTransport::Poll(const int timeout_ms)
+{
+	epoll_event events[2];
+	const int event_count = epoll_wait(m_epoll, events, 2, timeout_ms);
+	bool readable = false;
+	for (int i = 0; i < event_count; i++) {
+		if (events[i].data.fd == m_wakeup) {
+			uint64_t value;
+			if (read(m_wakeup, &value, sizeof(value)) == -1) {
+				// Already reset
+			}
+		} else {
+			readable = true;
+		}
+	}
+
+	if (!readable) {
+		return 0;
+	}
+
+	mmsghdr messages[UDP_RECV_BATCH_SIZE];
+	iovec iovecs[UDP_RECV_BATCH_SIZE];
+	sockaddr_in addresses[UDP_RECV_BATCH_SIZE];
+	const uint64_t received_before = m_stats.packets_received;
+	int message_count;
+	do {
+		for (uint32_t i = 0; i < UDP_RECV_BATCH_SIZE; i++) {
+			iovecs[i].iov_base = &m_recv_buffer[i * UDP_MAX_DATAGRAM_SIZE];
+			iovecs[i].iov_len = UDP_MAX_DATAGRAM_SIZE;
+			memset(&messages[i], 0, sizeof(mmsghdr));
+			messages[i].msg_hdr.msg_iov = &iovecs[i];
+			messages[i].msg_hdr.msg_iovlen = 1;
+			messages[i].msg_hdr.msg_name = &addresses[i];
+			messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+		}
+
+		message_count = recvmmsg(m_socket, messages, UDP_RECV_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+		m_stats.recv_syscalls++;
+		if (message_count <= 0) {
+			break;
+		}
+
+		const auto now = std::chrono::steady_clock::now();
+		for (int i = 0; i < message_count; i++) {
+			const uint8_t *data = &m_recv_buffer[i * UDP_MAX_DATAGRAM_SIZE];
+			const size_t size = messages[i].msg_len;
+			if (m_connected) {
+				uint16_t magic = 0;
+				if (size >= UDP_DATAGRAM_HEADER_SIZE) {
+					memcpy(&magic, data, sizeof(magic));
+				}
+
+				if (magic == UDP_CHALLENGE_MAGIC) {
+					ReceiveCookie(data, size);
+					continue;
+				}
+
+				uint32_t session_id = GetSession(m_peer, now);
+				if (!session_id) {
+					session_id = CreateSession(m_peer, now);
+				}
+
+				ReadDatagram(data, size, session_id);
+				continue;
+			}
+
+			uint32_t session_id = GetSession(addresses[i], now);
+			if (!session_id) {
+				session_id = AcceptSession(addresses[i], data, size, now);
+			}
+
+			if (session_id) {
+				ReadDatagram(data, size, session_id);
+			}
+		}
+
+		m_stats.datagrams_received += message_count;
+	} while (message_count == UDP_RECV_BATCH_SIZE);
+
+	return m_stats.packets_received - received_before;
+}
+
+// Session id of the address, 0 if it has no session
+const uint32_t UDPTransport::GetSession(const sockaddr_in &address,
+	const std::chrono::steady_clock::time_point &now)
+{
+	auto session_it = m_sessions.find(address_key(address));
+	if (session_it == m_sessions.end()) {
+		return 0;
+	}
+
+	session_it->second.last_seen = now;
+	return session_it->second.id;
+}
+
+const uint32_t UDPTransport::CreateSession(const sockaddr_in &address,
+	const std::chrono::steady_clock::time_point &now)
+{
+	const uint64_t key = address_key(address);
+	const Session session = { m_next_session_id++, address, now };
+	m_sessions[key] = session;
+	m_session_addresses[session.id] = key;
+	return session.id;
+}
+
+const uint64_t UDPTransport::MakeCookie(const sockaddr_in &address,
+	const uint64_t period) const
+{
+	return siphash24(m_cookie_key, address_key(address), period);
+}
+
+/*
+ * Create the session of an unknown address if its datagram carries a valid cookie,
+ * otherwise send the cookie to the address. Returns the session id, 0 if the datagram
+ * is ignored
+ */
+const uint32_t UDPTransport::AcceptSession(const sockaddr_in &address, const uint8_t *data,
+	const size_t size, const std::chrono::steady_clock::time_point &now)
+{
+	// The answer must not be bigger than the datagram, spoofed addresses can't be
+	// flooded through the server
+	uint16_t magic = 0;
+	if (size >= UDP_DATAGRAM_HEADER_SIZE + UDP_COOKIE_SIZE) {
+		memcpy(&magic, data, sizeof(magic));
+	}
+
+	if (magic != UDP_DATAGRAM_MAGIC && magic != UDP_COOKIE_DATAGRAM_MAGIC) {
+		m_stats.dropped++;
+		return 0;
+	}
+
+	const uint64_t period = cookie_period(now);
+	if (magic == UDP_COOKIE_DATAGRAM_MAGIC) {
+		uint64_t cookie;
+		memcpy(&cookie, data + UDP_DATAGRAM_HEADER_SIZE, sizeof(cookie));
+		if (cookie == MakeCookie(address, period) ||
+			cookie == MakeCookie(address, period - 1)) {
+			return CreateSession(address, now);
+		}
+	}
+
+	uint8_t challenge[UDP_DATAGRAM_HEADER_SIZE + UDP_COOKIE_SIZE];
+	const uint16_t challenge_magic = UDP_CHALLENGE_MAGIC;
+	const uint64_t cookie = MakeCookie(address, period);
+	memcpy(challenge, &challenge_magic, sizeof(challenge_magic));
+	memcpy(challenge + UDP_DATAGRAM_HEADER_SIZE, &cookie, sizeof(cookie));
+	m_stats.send_syscalls++;
+	if (sendto(m_socket, challenge, sizeof(challenge), 0, (const sockaddr *) &address,
+		sizeof(address)) == -1) {
+		m_stats.dropped++;
+		return 0;
+	}
+
+	m_stats.challenges_sent++;
+	return 0;
+}
+
+/*
+ * Store the cookie sent by the server, the datagrams it ignored until now are sent
+ * again with it
+ */
+void UDPTransport::ReceiveCookie(const uint8_t *data, const size_t size)
+{
+	if (size != UDP_DATAGRAM_HEADER_SIZE + UDP_COOKIE_SIZE) {
+		m_stats.dropped++;
+		return;
+	}
+
+	// A new cookie is also sent when the server forgot the session, the datagrams
+	// sent in between are lost
+	memcpy(&m_cookie, data + UDP_DATAGRAM_HEADER_SIZE, sizeof(m_cookie));
+	if (m_has_cookie) {
+		return;
+	}
+
+	m_has_cookie = true;
+	for (const std::vector<uint8_t> &pending: m_pending_datagrams) {
+		std::vector<uint8_t> &datagram = NewDatagram(m_peer);
+		datagram.insert(datagram.end(),
+			pending.begin() + UDP_DATAGRAM_HEADER_SIZE + UDP_COOKIE_SIZE, pending.end());
+	}
+
+	m_pending_datagrams.clear();
+	FlushDatagrams();
+}
+
+/*
+ * Datagram layout: magic, then packets prefixed by their size
+ */
+void UDPTransport::ReadDatagram(const uint8_t *data, const size_t size,
+	const uint32_t session_id)
+{
+	uint16_t magic = 0;
+	if (size >= UDP_DATAGRAM_HEADER_SIZE) {
+		memcpy(&magic, data, sizeof(magic));
+	}
+
+	size_t offset = UDP_DATAGRAM_HEADER_SIZE;
+	if (magic == UDP_COOKIE_DATAGRAM_MAGIC && !m_connected) {
+		// The cookie was checked when the session was created
+		offset += UDP_COOKIE_SIZE;
+	} else if (magic != UDP_DATAGRAM_MAGIC) {
+		m_stats.dropped++;
+		return;
+	}
+
+	while (offset + UDP_FRAME_HEADER_SIZE <= size) {
+		uint16_t packet_size;
+		memcpy(&packet_size, data + offset, sizeof(packet_size));
+		offset += UDP_FRAME_HEADER_SIZE;
+		if (packet_size < sizeof(uint16_t) || offset + packet_size > size) {
+			m_stats.dropped++;
+			return;
+		}
+
+		uint16_t opcode;
+		memcpy(&opcode, data + offset, sizeof(opcode));
+		NetworkPacket *packet = PacketPool::instance()->Acquire(opcode, packet_size);
+		packet->Write(data + offset + sizeof(opcode), packet_size - sizeof(opcode));
+		packet->SetSessionId(session_id);
+		offset += packet_size;
+
+		m_stats.packets_received++;
+		m_handler(packet);
+	}
+}
+
+std::vector<uint8_t> &UDPTransport::NewDatagram(const sockaddr_in &address)
+{
+	if (m_send_datagram_count == m_send_datagrams.size()) {
+		m_send_datagrams.emplace_back();
+		m_send_addresses.emplace_back();
+	}
+
+	std::vector<uint8_t> &datagram = m_send_datagrams[m_send_datagram_count];
+	m_send_addresses[m_send_datagram_count] = address;
+	m_send_datagram_count++;
+
+	// Clients prove they receive the server datagrams with their cookie
+	const uint16_t magic = m_connected ? UDP_COOKIE_DATAGRAM_MAGIC : UDP_DATAGRAM_MAGIC;
+	datagram.resize(UDP_DATAGRAM_HEADER_SIZE);
+	memcpy(datagram.data(), &magic, sizeof(magic));
+	if (m_connected) {
+		datagram.resize(UDP_DATAGRAM_HEADER_SIZE + UDP_COOKIE_SIZE);
+		memcpy(datagram.data() + UDP_DATAGRAM_HEADER_SIZE, &m_cookie, sizeof(m_cookie));
+	}
+
+	return datagram;
+}
+
+size_t UDPTransport::Send(NetworkPacket **packets, const size_t count)
+{
+	// Datagram being filled for each session of this batch
+	std::unordered_map<uint64_t, size_t> open_datagrams;
+	const size_t header_size = UDP_DATAGRAM_HEADER_SIZE + (m_connected ? UDP_COOKIE_SIZE : 0);
+	for (size_t i = 0; i < count; i++) {
+		NetworkPacketPtr packet(packets[i]);
+		assert(!packet->GetLocalMessage<LocalMessage>());
+
+		uint64_t key = address_key(m_peer);
+		if (!m_connected) {
+			auto address_it = m_session_addresses.find(packet->GetSessionId());
+			if (address_it == m_session_addresses.end()) {
+				// Session expired
+				m_stats.dropped++;
+				continue;
+			}
+			key = address_it->second;
+		}
+
+		const unsigned packet_size = packet->GetSize();
+		if (packet_size > UDP_MAX_PACKET_SIZE) {
+			URHO3D_LOGERRORF("Packet %d is too big to be sent (%d bytes)",
+				packet->GetOpcode(), packet_size);
+			m_stats.dropped++;
+			continue;
+		}
+
+		const sockaddr_in &address = m_connected ? m_peer : m_sessions[key].address;
+		const auto open_it = open_datagrams.find(key);
+		std::vector<uint8_t> *datagram;
+		if (header_size + UDP_FRAME_HEADER_SIZE + packet_size > UDP_COALESCE_SIZE) {
+			// Sent alone, the open datagram can still take small packets
+			datagram = &NewDatagram(address);
+		} else if (open_it != open_datagrams.end() && m_send_datagrams[open_it->second].size() +
+			UDP_FRAME_HEADER_SIZE + packet_size <= UDP_COALESCE_SIZE) {
+			datagram = &m_send_datagrams[open_it->second];
+		} else {
+			datagram = &NewDatagram(address);
+			open_datagrams[key] = m_send_datagram_count - 1;
+		}
+
+		const uint16_t frame_size = packet_size;
+		const size_t offset = datagram->size();
+		datagram->resize(offset + UDP_FRAME_HEADER_SIZE + packet_size);
+		memcpy(datagram->data() + offset, &frame_size, sizeof(frame_size));
+		memcpy(datagram->data() + offset + UDP_FRAME_HEADER_SIZE, packet->GetData(), packet_size);
+		m_stats.packets_sent++;
+	}
+
+	// Without cookie the server ignores the datagrams, they are sent again once it
+	// answered
+	if (m_connected && !m_has_cookie) {
+		for (size_t i = 0; i < m_send_datagram_count &&
+			m_pending_datagrams.size() < UDP_MAX_PENDING_DATAGRAMS; i++) {
+			m_pending_datagrams.push_back(m_send_datagrams[i]);
+		}
+	}
+
+	return FlushDatagrams();
+}
+
+size_t UDPTransport::FlushDatagrams()
+{
+	mmsghdr messages[UDP_SEND_BATCH_SIZE];
+	iovec iovecs[UDP_SEND_BATCH_SIZE];
+	size_t sent = 0, delivered = 0;
+	while (sent < m_send_datagram_count) {
+		const size_t batch_size = std::min<size_t>(UDP_SEND_BATCH_SIZE,
+			m_send_datagram_count - sent);
+		for (size_t i = 0; i < batch_size; i++) {
+			std::vector<uint8_t> &datagram = m_send_datagrams[sent + i];
+			iovecs[i].iov_base = datagram.data();
+			iovecs[i].iov_len = datagram.size();
+			memset(&messages[i], 0, sizeof(mmsghdr));
+			messages[i].msg_hdr.msg_iov = &iovecs[i];
+			messages[i].msg_hdr.msg_iovlen = 1;
+			if (!m_connected) {
+				messages[i].msg_hdr.msg_name = &m_send_addresses[sent + i];
+				messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+			}
+		}
+
+		const int result = sendmmsg(m_socket, messages, batch_size, 0);
+		m_stats.send_syscalls++;
+		if (result <= 0) {
+			// Socket buffer is full or the datagram was refused, drop it like the network would
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				URHO3D_LOGWARNINGF("Unable to send datagram: %s", strerror(errno));
+			}
+			m_stats.dropped++;
+			sent++;
+			continue;
+		}
+
+		m_stats.datagrams_sent += result;
+		sent += result;
+		delivered += result;
+	}
+
+	m_send_datagram_count = 0;
+	return delivered;
+}
+
+size_t UDPTransport::ExpireSessions(const std::chrono::steady_clock::duration &timeout)
+{
+	const auto now = std::chrono::steady_clock::now();
+	size_t removed = 0;
+	for (auto session_it = m_sessions.begin(); session_it != m_sessions.end();) {
+		if (now - session_it->second.last_seen <= timeout) {
+			session_it++;
+			continue;
+		}
+
+		const uint32_t session_id = session_it->second.id;
+		m_session_addresses.erase(session_id);
+		session_it = m_sessions.erase(session_it);
+		removed++;
+		if (m_session_closed_handler) {
+			m_session_closed_handler(session_id);
+		}
+	}
+
+	return removed;
+}
+
+UDPServerThread::UDPServerThread(Server *server):
+	m_server(server),
+	m_transport([server](NetworkPacket *packet) { server->ReceivePacket(packet); })
+{
+	m_transport.SetSessionClosedHandler([server](const uint32_t session_id) {
+		server->CloseSession(session_id);
+	});
+}
+
+void UDPServerThread::ThreadFunction()
+{
+	NetworkPacket *packets[UDP_SERVER_SEND_BATCH_SIZE];
+	auto last_expiration = std::chrono::steady_clock::now();
+	while (shouldRun_) {
+		m_transport.Poll(UDP_SERVER_POLL_TIMEOUT_MS);
+
+		size_t packet_count;
+		while ((packet_count = m_server->PopSendingQueue(packets,
+			UDP_SERVER_SEND_BATCH_SIZE)) > 0) {
+			m_transport.Send(packets, packet_count);
+		}
+
+		const auto now = std::chrono::steady_clock::now();
+		if (now - last_expiration > std::chrono::milliseconds(UDP_SERVER_POLL_TIMEOUT_MS)) {
+			const size_t expired = m_transport.ExpireSessions(
+				std::chrono::seconds(UDP_SESSION_TIMEOUT));
+			if (expired > 0) {
+				URHO3D_LOGINFOF("%d network sessions timed out", (int) expired);
+			}
+			last_expiration = now;
+		}
+	}
+}
+
+}
+}
+}
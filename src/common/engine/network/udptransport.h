@@ -0,0 +1,211 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <netinet/in.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <Urho3D/Core/Thread.h>
+#include "networkprotocol.h"
+
+namespace spacel {
+namespace engine {
+
+class Server;
+
+namespace network {
+
+// Datagrams read or written by one recvmmsg/sendmmsg call
+#define UDP_RECV_BATCH_SIZE 32
+#define UDP_SEND_BATCH_SIZE 64
+#define UDP_MAX_DATAGRAM_SIZE 65507
+// Small packets are coalesced into datagrams up to this size, bigger packets are sent alone
+#define UDP_COALESCE_SIZE 1200
+// Datagram header, rejects stray traffic
+#define UDP_DATAGRAM_MAGIC 0x5350
+#define UDP_DATAGRAM_HEADER_SIZE sizeof(uint16_t)
+// Client datagrams, the header is followed by the cookie given by the server
+#define UDP_COOKIE_DATAGRAM_MAGIC 0x5351
+// Server answer to datagrams of unknown addresses, header and cookie only
+#define UDP_CHALLENGE_MAGIC 0x5352
+#define UDP_COOKIE_SIZE sizeof(uint64_t)
+// Each packet is prefixed by its size
+#define UDP_FRAME_HEADER_SIZE sizeof(uint16_t)
+#define UDP_MAX_PACKET_SIZE (UDP_MAX_DATAGRAM_SIZE - UDP_DATAGRAM_HEADER_SIZE - \
+	UDP_COOKIE_SIZE - UDP_FRAME_HEADER_SIZE)
+// Server sessions are forgotten after this silence, in seconds
+#define UDP_SESSION_TIMEOUT 30
+// Cookies are accepted during their period and the next one, in seconds
+#define UDP_COOKIE_PERIOD 30
+// Datagrams kept by a client until it receives its cookie, the next ones aren't sent again
+#define UDP_MAX_PENDING_DATAGRAMS 64
+
+/*
+ * Transport counters, readable from any thread
+ */
+struct UDPTransportStats
+{
+	std::atomic<uint64_t> packets_received{0};
+	std::atomic<uint64_t> packets_sent{0};
+	std::atomic<uint64_t> datagrams_received{0};
+	std::atomic<uint64_t> datagrams_sent{0};
+	std::atomic<uint64_t> recv_syscalls{0};
+	std::atomic<uint64_t> send_syscalls{0};
+	// Malformed datagrams, too big packets and datagrams the socket refused
+	std::atomic<uint64_t> dropped{0};
+	// Cookies sent to addresses without session
+	std::atomic<uint64_t> challenges_sent{0};
+};
+
+/*
+ * Non blocking IPv4 UDP socket driven by epoll. Received datagrams are read with recvmmsg,
+ * split into packets tagged with the sender session id and given to the packet handler.
+ * Sent packets are coalesced per session and written with sendmmsg.
+ *
+ * A listening transport only creates a session for an address which proved it receives
+ * the datagrams sent to it: unknown addresses get a stateless cookie, no bigger than
+ * their datagram, and must send it back. Connected transports keep their datagrams until
+ * they receive the cookie, then send them again.
+ *
+ * Poll, Send and ExpireSessions must be called from the same thread, Wakeup from any
+ * thread. Delivery and ordering are not guaranteed.
+ */
+class UDPTransport
+{
+public:
+	typedef std::function<void(NetworkPacket *packet)> PacketHandler;
+	typedef std::function<void(const uint32_t session_id)> SessionHandler;
+
+	UDPTransport(const PacketHandler &handler);
+	~UDPTransport();
+
+	// Accept datagrams from anyone, port 0 picks a free port
+	bool Listen(const uint16_t port, const bool loopback_only = false);
+	// Exchange datagrams with a single server, sent packets ignore their session id
+	bool Connect(const std::string &address, const uint16_t port);
+	const uint16_t GetLocalPort() const;
+
+	/*
+	 * Wait up to timeout_ms for datagrams or a Wakeup call, and hand received packets over.
+	 * Returns the number of received packets
+	 */
+	size_t Poll(const int timeout_ms);
+
+	/*
+	 * Send packets to their sessions and release them to the pool. Returns the number of
+	 * sent datagrams
+	 */
+	size_t Send(NetworkPacket **packets, const size_t count);
+
+	// Interrupt a waiting Poll call
+	void Wakeup();
+
+	// Forget sessions silent for longer than timeout, returns the number of removed sessions
+	size_t ExpireSessions(const std::chrono::steady_clock::duration &timeout);
+	// Called for each session removed by ExpireSessions, should be set before Poll
+	void SetSessionClosedHandler(const SessionHandler &handler)
+	{
+		m_session_closed_handler = handler;
+	}
+	const size_t GetSessionCount() const { return m_sessions.size(); }
+	// Connected transports only, the server cookie was received
+	const bool HasCookie() const { return m_has_cookie; }
+	const UDPTransportStats &GetStats() const { return m_stats; }
+
+private:
+	struct Session
+	{
+		uint32_t id;
+		sockaddr_in address;
+		std::chrono::steady_clock::time_point last_seen;
+	};
+
+	bool OpenSocket();
+	const uint32_t GetSession(const sockaddr_in &address,
+		const std::chrono::steady_clock::time_point &now);
+	const uint32_t CreateSession(const sockaddr_in &address,
+		const std::chrono::steady_clock::time_point &now);
+	const uint32_t AcceptSession(const sockaddr_in &address, const uint8_t *data,
+		const size_t size, const std::chrono::steady_clock::time_point &now);
+	const uint64_t MakeCookie(const sockaddr_in &address, const uint64_t period) const;
+	void ReceiveCookie(const uint8_t *data, const size_t size);
+	void ReadDatagram(const uint8_t *data, const size_t size, const uint32_t session_id);
+	std::vector<uint8_t> &NewDatagram(const sockaddr_in &address);
+	size_t FlushDatagrams();
+
+	PacketHandler m_handler;
+	SessionHandler m_session_closed_handler;
+	int m_socket = -1;
+	int m_epoll = -1;
+	int m_wakeup = -1;
+	bool m_connected = false;
+	sockaddr_in m_peer;
+
+	// Listening transports, key of the cookie hash
+	uint64_t m_cookie_key[2];
+	// Connected transports, cookie sent in each datagram header
+	uint64_t m_cookie = 0;
+	bool m_has_cookie = false;
+	// Datagrams sent before the cookie was received
+	std::vector<std::vector<uint8_t>> m_pending_datagrams;
+
+	uint32_t m_next_session_id = 1;
+	// Sessions by packed address and port
+	std::unordered_map<uint64_t, Session> m_sessions;
+	std::unordered_map<uint32_t, uint64_t> m_session_addresses;
+
+	std::vector<uint8_t> m_recv_buffer;
+	// Datagrams built by Send, buffers are kept between calls
+	std::vector<std::vector<uint8_t>> m_send_datagrams;
+	std::vector<sockaddr_in> m_send_addresses;
+	size_t m_send_datagram_count = 0;
+
+	UDPTransportStats m_stats;
+};
+
+/*
+ * Server network thread, receives packets from clients into the server receive queue and
+ * sends its sending queue
+ */
+class UDPServerThread: public Urho3D::Thread
+{
+public:
+	UDPServerThread(Server *server);
+	~UDPServerThread() {}
+
+	bool Listen(const uint16_t port) { return m_transport.Listen(port); }
+	void ThreadFunction();
+	// Called when the server queued packets to send
+	void Wakeup() { m_transport.Wakeup(); }
+	const UDPTransportStats &GetStats() const { return m_transport.GetStats(); }
+
+private:
+	Server *m_server;
+	UDPTransport m_transport;
+};
+
+}
+}
+}
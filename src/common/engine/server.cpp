@@ -22,37 +22,60 @@
 #include <Urho3D/IO/Log.h>
 #include <iostream>
 #include <chrono>
+#include <cmath>
 #include <thread>
 #include <fstream>
 #include <json/json.h>
 
 #include "databases/database-sqlite3.h"
+#include "databases/databasereadpool.h"
+#include "databases/databasewriter.h"
+#include "network/localmessages.h"
+#include "network/packetpool.h"
+#include "network/udptransport.h"
 #include "generators.h"
 #include "objectmanager.h"
 #include "space.h"
 #include "../../project_defines.h"
+#include "../porting.h"
+#include "galaxyinterest.h"
 #include "player.h"
+#include "shard.h"
+#include "solarsystemcache.h"
+#include "../jobsystem.h"
 
 namespace spacel {
 namespace engine {
 
 using namespace network;
 
-#define SERVER_LOOP_TIME 0.025f
+#define SERVER_PACKET_BATCH_SIZE 64
 
 Server::Server(const std::string &gamedatapath, const std::string &datapath,
 		const std::string &universe_name):
 		Thread(),
 		m_gamedatapath(gamedatapath),
 		m_datapath(datapath),
-		m_universe_name(universe_name)
+		m_universe_name(universe_name),
+		m_tick_scheduler(m_settings.getU32(SERVER_U32SETTING_TICK_RATE)),
+		m_packet_scheduler(SERVER_SESSION_PENDING_PACKETS),
+		m_tick_packet_time(std::chrono::steady_clock::duration::zero())
 {
 	m_loading_step = SERVERLOADINGSTEP_NOT_STARTED;
+	m_loading_progress = 0;
+	m_loading_total = 0;
+}
+
+Server::~Server()
+{
 }
 
 const bool Server::InitServer()
 {
+	PROFILE_SCOPE(m_profiler, "init_server");
 	m_loading_step = SERVERLOADINGSTEP_BEGIN_START;
+	m_settings.load((m_datapath + m_universe_name + DIR_DELIM + "server.json").c_str());
+
 	try {
 		m_db = new DatabaseSQLite3(m_datapath + m_universe_name);
 
@@ -60,30 +83,101 @@ const bool Server::InitServer()
 
 		// @TODO get the seed from database
 		UnivGen->SetSeed(180);
+		// The client creates its universes from the main menu, dedicated servers on their
+		// first start. Generation flags are updates of this row
+		if (!m_db->LoadUniverse(m_universe_name)) {
+			m_db->CreateUniverse(m_universe_name, UniverseGenerator::GetSeed());
+		}
+
 		bool galaxy_generated = m_db->IsUniverseGenerated(m_universe_name);
+		// Planets and derived names are generated again from their id, use the settings
+		// of the universe. New universes are generated with the default backend
+		if (galaxy_generated) {
+			UniverseGenerator::SetBackend(m_db->GetUniverseBackend(m_universe_name));
+			Universe::instance()->SetDerivedNames(
+				m_db->HasUniverseDerivedNames(m_universe_name));
+		} else {
+			// A legacy universe may have been loaded before by this process
+			UniverseGenerator::SetBackend(UNIVGEN_BACKEND_COUNTER);
+			Universe::instance()->SetDerivedNames(
+				m_settings.getBool(SERVER_BSETTING_SOLARSYSTEM_DERIVED_NAMES));
+		}
 
-		const auto start = std::chrono::system_clock::now();
-		if (!galaxy_generated) {
-			// Generate 1 galaxy with 1M solar systems
-			Galaxy *galaxy = Universe::instance()->CreateGalaxy(1000 * 1000);
-			// Save the galaxy and solar systems
-			m_db->BeginTransaction();
-			m_db->CreateGalaxy(galaxy);
-			for (const auto &ss: galaxy->solar_systems) {
-				m_db->CreateSolarSystem(ss.second);
+		const auto start = std::chrono::steady_clock::now();
+
+		// The galaxy and the game datas are independent, load them at the same time.
+		// Exceptions can't leave the jobs, they are reported through these flags
+		std::atomic<bool> galaxy_loaded(false), gamedatas_loaded(false), shards_inited(false);
+		TaskGraph loading;
+		const TaskGraph::TaskId galaxy_task = loading.AddTask([&] {
+			try {
+				PROFILE_SCOPE(m_profiler, "load_galaxy");
+				LoadGalaxy(galaxy_generated);
+				galaxy_loaded = true;
 			}
-			m_db->SetUniverseGenerated(m_universe_name, true);
-			m_db->CommitTransaction();
-		}
-		else {
-			Galaxy *galaxy = m_db->LoadGalaxy(1);
-			m_db->LoadSolarSystemsForGalaxy(galaxy);
-			Universe::instance()->SetGalaxy(galaxy);
+			catch (SQLiteException &e) {
+				URHO3D_LOGERROR(e.what());
+			}
+		});
+
+		loading.AddTask([&] {
+			PROFILE_SCOPE(m_profiler, "load_gamedatas");
+			gamedatas_loaded = LoadGameDatas();
+		});
+
+		loading.AddTask([&] {
+			if (!galaxy_loaded) {
+				return;
+			}
+
+			try {
+				PROFILE_SCOPE(m_profiler, "init_shards");
+				// The writer thread has its own connection, the tick never waits on it
+				m_db_writer = new DatabaseWriter(
+					new DatabaseSQLite3(m_datapath + m_universe_name),
+					m_settings.getU32(SERVER_U32SETTING_DATABASE_FLUSH_INTERVAL_MS));
+				m_db_writer->SetProfiler(&m_profiler);
+				m_db_writer->Run();
+
+				if (m_settings.getBool(SERVER_BSETTING_SOLARSYSTEM_PAGING)) {
+					const size_t cache_mb =
+						m_settings.getU32(SERVER_U32SETTING_SOLARSYSTEM_CACHE_MB);
+					m_solarsystem_cache = new SolarSystemCache(m_db,
+						Universe::instance()->GetGalaxy(1), cache_mb * 1024 * 1024);
+					m_solarsystem_cache->SetWriter(m_db_writer);
+					// Job system workers page solar systems in with their own connections
+					m_db_read_pool = new DatabaseReadPool(m_datapath + m_universe_name);
+					m_solarsystem_cache->SetReadPool(m_db_read_pool, JobSystem::instance());
+				}
+
+				uint32_t shard_count = m_settings.getU32(SERVER_U32SETTING_SHARDS);
+				if (shard_count == 0) {
+					shard_count = JobSystem::instance()->GetWorkerCount() + 1;
+				}
+				m_shards = new ShardSet(Universe::instance()->GetGalaxy(1), shard_count,
+					JobSystem::instance());
+				m_shards->SetProfiler(&m_profiler);
+				shards_inited = true;
+			}
+			catch (SQLiteException &e) {
+				URHO3D_LOGERROR(e.what());
+			}
+		}, { galaxy_task });
+
+		loading.Run(*JobSystem::instance());
+
+		if (!galaxy_loaded || !shards_inited) {
+			m_loading_step = SERVERLOADINGSTEP_FAILED;
+			return false;
 		}
 
-		auto end = std::chrono::system_clock::now();
+		auto end = std::chrono::steady_clock::now();
 		std::chrono::duration<double> elapsed_seconds = end - start;
 		std::cout << "Loading time: " << elapsed_seconds.count() << "s" << std::endl;
+
+		if (!gamedatas_loaded) {
+			m_loading_step = SERVERLOADINGSTEP_FAILED;
+		}
 	}
 	catch (SQLiteException &e) {
 		URHO3D_LOGERROR(e.what());
@@ -91,17 +185,71 @@ const bool Server::InitServer()
 		return false;
 	}
 
-	if (!LoadGameDatas()) {
-		m_loading_step = SERVERLOADINGSTEP_FAILED;
-	}
-
 	m_loading_step = SERVERLOADINGSTEP_GAMEDATAS_LOADED;
-	// @TODO more ?
+
+	if (!m_singleplayer_mode) {
+		const uint16_t port = m_port_override ? m_port_override :
+			m_settings.getU32(SERVER_U32SETTING_PORT);
+		m_network_thread = new UDPServerThread(this);
+		if (!m_network_thread->Listen(port)) {
+			delete m_network_thread;
+			m_network_thread = nullptr;
+			m_loading_step = SERVERLOADINGSTEP_FAILED;
+			return false;
+		}
+
+		SetPacketListener([this] { m_network_thread->Wakeup(); });
+		m_network_thread->Run();
+		URHO3D_LOGINFOF("Listening on UDP port %d", port);
+	}
 
 	m_loading_step = SERVERLOADINGSTEP_STARTED;
 	return true;
 }
 
+void Server::LoadGalaxy(const bool galaxy_generated)
+{
+	if (!galaxy_generated) {
+		// Generate 1 galaxy with 1M solar systems
+		Galaxy *galaxy = Universe::instance()->CreateGalaxy(1000 * 1000,
+			m_settings.getU32(SERVER_U32SETTING_GALAXY_GENERATION_THREADS));
+		// Save the galaxy and solar systems
+		m_loading_progress = 0;
+		m_loading_total = galaxy->solar_systems.size();
+		m_db->BeginBulkLoad();
+		m_db->BeginTransaction();
+		m_db->CreateGalaxy(galaxy);
+		m_db->CreateSolarSystems(galaxy, 0, galaxy->solar_systems.size(),
+			&m_loading_progress);
+		m_db->SetUniverseBackend(m_universe_name, UniverseGenerator::GetBackend());
+		m_db->SetUniverseDerivedNames(m_universe_name, Universe::instance()->HasDerivedNames());
+		m_db->SetUniverseGenerated(m_universe_name, true);
+		m_db->CommitTransaction();
+		m_db->EndBulkLoad();
+
+		if (m_settings.getBool(SERVER_BSETTING_SOLARSYSTEM_PAGING) &&
+			!Universe::instance()->HasDerivedNames()) {
+			// Solar systems are now saved, their names will be paged from the database
+			galaxy->solar_systems.ClearNames();
+		}
+		return;
+	}
+
+	Galaxy *galaxy = m_db->LoadGalaxy(1);
+	if (m_settings.getBool(SERVER_BSETTING_SOLARSYSTEM_PAGING)) {
+		// Positions stay in memory for the spatial index, names are paged while streaming
+		m_db->LoadSolarSystemPositionsForGalaxy(galaxy);
+		if (!Universe::instance()->HasDerivedNames()) {
+			galaxy->solar_systems.ClearNames();
+		}
+	} else {
+		m_db->LoadSolarSystemsForGalaxy(galaxy);
+	}
+	galaxy->spatial_index.Build(galaxy->solar_systems,
+		m_settings.getU32(SERVER_U32SETTING_GALAXY_GENERATION_THREADS));
+	Universe::instance()->SetGalaxy(galaxy);
+}
+
 const bool Server::LoadGameDatas()
 {
 	try {
@@ -198,6 +346,27 @@ const bool Server::LoadGameDatas()
 
 void Server::StopServer()
 {
+	if (m_network_thread) {
+		m_network_thread->Stop();
+		delete m_network_thread;
+		m_network_thread = nullptr;
+	}
+
+	m_settings.save((m_datapath + m_universe_name + DIR_DELIM + "server.json").c_str());
+
+	delete m_shards;
+	m_shards = nullptr;
+
+	delete m_solarsystem_cache;
+	m_solarsystem_cache = nullptr;
+
+	delete m_db_read_pool;
+	m_db_read_pool = nullptr;
+
+	// Pending objects are written before the writer stops
+	delete m_db_writer;
+	m_db_writer = nullptr;
+
 	delete m_db;
 	m_db = nullptr;
 }
@@ -210,26 +379,23 @@ void Server::ThreadFunction()
 		return;
 	}
 
-	float dtime = 0.0f;
+	m_tick_scheduler.SetTickRate(m_tick_rate_override ? m_tick_rate_override :
+		m_settings.getU32(SERVER_U32SETTING_TICK_RATE));
+	const float dtime = m_tick_scheduler.GetTickInterval();
+	uint64_t dropped_ticks = 0;
 	while (shouldRun_) {
-		const auto prev_time = std::chrono::system_clock::now();
-		Step(dtime);
-		const auto step_time = std::chrono::system_clock::now().time_since_epoch() -
-				prev_time.time_since_epoch();
-
-		// runtime is a float sec time
-		float runtime = std::chrono::duration_cast<std::chrono::milliseconds>(step_time).count() / 1000.0f;
-
-		// If step runtime < LOOP TIME, sleep for the diff time
-		if (runtime < SERVER_LOOP_TIME) {
-			// Convert back to ms from s
-			std::this_thread::sleep_for(std::chrono::milliseconds((uint32_t)((SERVER_LOOP_TIME - runtime) * 1000.0f)));
-			dtime = SERVER_LOOP_TIME;
+		const uint32_t ticks = m_tick_scheduler.Wait();
+
+		// Packets are handled as soon as they are received, not on the next tick
+		ProcessReceivedPackets();
+		for (uint32_t i = 0; i < ticks; i++) {
+			Step(dtime);
 		}
-		else {
-			URHO3D_LOGWARNINGF("Server thread lagging. Runtime %f > %f",
-				runtime, SERVER_LOOP_TIME);
-			dtime = runtime;
+
+		if (m_tick_scheduler.GetDroppedTicks() != dropped_ticks) {
+			URHO3D_LOGWARNINGF("Server thread lagging, %d ticks dropped",
+				(int) (m_tick_scheduler.GetDroppedTicks() - dropped_ticks));
+			dropped_ticks = m_tick_scheduler.GetDroppedTicks();
 		}
 	}
 
@@ -238,11 +404,88 @@ void Server::ThreadFunction()
 
 void Server::Step(const float dtime)
 {
-	// @TODO limit packet processing time
-	while (!m_packet_receive_queue.empty()) {
-		std::unique_ptr<NetworkPacket> pkt(m_packet_receive_queue.pop_front());
+	PROFILE_SCOPE(m_profiler, "server_step");
+	ProcessReceivedPackets();
+	StreamGalaxy();
+
+	m_profiler.RecordCounter("packets_processed", m_tick_processed_packets);
+	m_profiler.RecordCounter("receive_queue_depth", m_packet_receive_queue.size());
+	m_profiler.RecordCounter("pending_packets", m_packet_scheduler.GetPendingCount());
+	m_profiler.RecordCounter("sending_queue_depth", m_packet_sending_queue.size());
+	m_profiler.RecordCounter("dropped_packets", m_packet_metrics.dropped_packets);
+	const uint64_t allocations = PacketPool::instance()->GetAllocatedCount();
+	m_profiler.RecordCounter("packet_allocations", allocations - m_profiled_allocations);
+	m_profiled_allocations = allocations;
+	m_profiler.RecordCounter("db_pending_objects",
+		m_db_writer->GetMetrics().pending_objects);
+
+	// Start the next tick budget
+	m_packet_metrics.processed_last_tick = m_tick_processed_packets;
+	m_packet_metrics.receive_queue_depth = m_packet_receive_queue.size();
+	m_packet_metrics.pending_packets = m_packet_scheduler.GetPendingCount();
+	if (m_packet_scheduler.GetPendingCount() > 0) {
+		m_packet_metrics.budget_exhausted_ticks++;
+	}
+
+	m_tick_processed_packets = 0;
+	m_tick_packet_time = std::chrono::steady_clock::duration::zero();
+}
+
+/*
+ * Process received packets round-robin between sessions, within the packet count and
+ * time budgets of the current tick. Remaining packets are processed on next ticks
+ */
+void Server::ProcessReceivedPackets()
+{
+	PROFILE_SCOPE(m_profiler, "packet_drain");
+	// Keep at most one queue of pending packets, the receive queue drops packets when
+	// the server can't keep up. A session can't take more than its own share of it
+	NetworkPacket *packets[SERVER_PACKET_BATCH_SIZE];
+	size_t packet_count;
+	while (m_packet_scheduler.GetPendingCount() < SERVER_PACKET_QUEUE_SIZE &&
+		(packet_count = m_packet_receive_queue.pop_front(packets,
+			std::min<size_t>(SERVER_PACKET_BATCH_SIZE,
+			SERVER_PACKET_QUEUE_SIZE - m_packet_scheduler.GetPendingCount()))) > 0) {
+		for (size_t i = 0; i < packet_count; i++) {
+			if (!m_packet_scheduler.Push(packets[i])) {
+				m_packet_metrics.dropped_packets++;
+			}
+		}
+	}
+
+	// Packets received before a session was closed are already in the scheduler
+	RemoveClosedSessions();
+
+	const uint32_t max_packets = m_settings.getU32(SERVER_U32SETTING_PACKETS_PER_TICK);
+	const std::chrono::steady_clock::duration time_budget = std::chrono::microseconds(
+		m_settings.getU32(SERVER_U32SETTING_PACKET_TIME_BUDGET_US));
+	const auto start = std::chrono::steady_clock::now();
+	auto now = start;
+	while (m_tick_processed_packets < max_packets &&
+		m_tick_packet_time + (now - start) < time_budget) {
+		NetworkPacketPtr pkt(m_packet_scheduler.Pop());
+		if (!pkt) {
+			break;
+		}
+
 		pkt->Seek(2);
 		ProcessPacket(pkt.get());
+		m_tick_processed_packets++;
+		m_packet_metrics.processed_packets++;
+		now = std::chrono::steady_clock::now();
+	}
+
+	m_tick_packet_time += now - start;
+}
+
+void Server::RemoveClosedSessions()
+{
+	while (!m_closed_sessions.empty()) {
+		const uint32_t session_id = m_closed_sessions.pop_front();
+		m_packet_scheduler.RemoveSession(session_id);
+		if (m_shards) {
+			m_shards->RemoveSession(session_id);
+		}
 	}
 }
 
@@ -268,7 +511,11 @@ void Server::ProcessPacket(network::NetworkPacket *packet)
 void Server::RoutePacket(network::NetworkPacket *packet)
 {
 	const SMsgHandler &opHandle = smsgHandlerTable[packet->GetOpcode()];
+	const uint64_t start = m_profiler.GetTime();
 	(this->*opHandle.handler)(packet);
+	const uint64_t end = m_profiler.GetTime();
+	m_profiler.RecordScope(opHandle.name, start, end);
+	m_router_metrics.Record(packet->GetOpcode(), opHandle.name, packet->GetSize(), end - start);
 }
 
 void Server::handlePacket_Hello(NetworkPacket *packet)
@@ -279,11 +526,18 @@ void Server::handlePacket_Hello(NetworkPacket *packet)
 	URHO3D_LOGINFOF("Client version %d.%d.%d (proto %d) tell us hello",
 		major_version, minor_version, patch_version, protocol_version);
 
-	NetworkPacket *resp_packet = new NetworkPacket(SMSG_HELLO);
+	NetworkPacket *resp_packet = PacketPool::instance()->Acquire(SMSG_HELLO);
+	resp_packet->SetSessionId(packet->GetSessionId());
 	resp_packet->WriteUByte(0);
 	resp_packet->WriteUByte(0);
 	resp_packet->WriteUByte(PROJECT_VERSION_PATCH);
 	resp_packet->WriteUShort(PROTOCOL_VERSION);
+	// Clients generate derived solar system names themselves
+	resp_packet->WriteBool(Universe::instance()->HasDerivedNames());
+	if (Universe::instance()->HasDerivedNames()) {
+		resp_packet->WriteUInt64(UniverseGenerator::GetSeed());
+		resp_packet->WriteUByte(UniverseGenerator::GetBackend());
+	}
 	SendPacket(resp_packet);
 }
 
@@ -297,7 +551,8 @@ void Server::handlePacket_Auth(NetworkPacket *packet)
 #if 0
 
 	if (!auth_success) {
-		NetworkPacket *resp_packet = new NetworkPacket(SMSG_AUTH);
+		NetworkPacket *resp_packet = PacketPool::instance()->Acquire(SMSG_AUTH);
+		resp_packet->SetSessionId(packet->GetSessionId());
 		uint8_t resp_code = 0;
 		resp_packet->WriteUByte(resp_code);
 		if (resp_code == 2) {
@@ -308,7 +563,8 @@ void Server::handlePacket_Auth(NetworkPacket *packet)
 	}
 #endif
 
-	NetworkPacket *resp_packet = new NetworkPacket(SMSG_CHARACTER_LIST);
+	NetworkPacket *resp_packet = PacketPool::instance()->Acquire(SMSG_CHARACTER_LIST);
+	resp_packet->SetSessionId(packet->GetSessionId());
 	static const uint8_t character_number = 1;
 	resp_packet->WriteUByte(character_number);
 
@@ -321,21 +577,96 @@ void Server::handlePacket_Auth(NetworkPacket *packet)
 
 	SendPacket(resp_packet);
 
+	// Solar systems are streamed around the player, start at the galaxy center until the
+	// client sends its position
 	// @TODO Change this place in the future
-	NetworkPacket *galaxy_packet = new NetworkPacket(SMSG_GALAXY_SYSTEMS);
 	Galaxy *galaxy = Universe::instance()->GetGalaxy(1);
 	assert(galaxy);
-	galaxy_packet->WriteUInt(galaxy->solar_systems.size());
-	for (const auto &ss: galaxy->solar_systems) {
-		galaxy_packet->WriteUInt64(ss.first); // ID
-		galaxy_packet->WriteUByte(ss.second->type);
-		galaxy_packet->WriteDouble(ss.second->radius);
-		galaxy_packet->WriteDouble(ss.second->pos_x);
-		galaxy_packet->WriteDouble(ss.second->pos_y);
-		galaxy_packet->WriteDouble(ss.second->pos_z);
-		galaxy_packet->WriteString(Urho3D::String(ss.second->name.c_str()));
+	std::unique_ptr<GalaxyInterest> interest(new GalaxyInterest(galaxy,
+		m_settings.getFloat(SERVER_FLOATSETTING_GALAXY_INTEREST_RADIUS),
+		m_settings.getBool(SERVER_BSETTING_GALAXY_COMPACT_ENCODING)));
+	// Singleplayer client runs in this process, skip galaxy encoding
+	interest->SetLocalMessages(m_singleplayer_mode);
+	if (PagesSolarSystemNames()) {
+		interest->SetNameSource([this] (const uint64_t &id, std::string &name) {
+			return FindPagedSolarSystemName(id, name);
+		});
+	}
+	m_shards->AddSession(packet->GetSessionId(), std::move(interest), 0.0, 0.0, 0.0);
+}
+
+void Server::handlePacket_PlayerPosition(NetworkPacket *packet)
+{
+	double pos_x, pos_y, pos_z;
+	if (const PlayerPositionMessage *message = packet->GetLocalMessage<PlayerPositionMessage>()) {
+		pos_x = message->pos_x;
+		pos_y = message->pos_y;
+		pos_z = message->pos_z;
+	} else {
+		pos_x = packet->ReadDouble();
+		pos_y = packet->ReadDouble();
+		pos_z = packet->ReadDouble();
+	}
+
+	// Positions come from the client, they reach the spatial index and the galaxy encoding
+	if (!std::isfinite(pos_x) || !std::isfinite(pos_y) || !std::isfinite(pos_z)) {
+		URHO3D_LOGWARNINGF("Invalid position received from session %u",
+			packet->GetSessionId());
+		return;
 	}
-	SendPacket(galaxy_packet);
+
+	// Galaxy interest is updated by the shard owning the session, on next tick
+	m_shards->SetSessionPosition(packet->GetSessionId(), pos_x, pos_y, pos_z);
+}
+
+/*
+ * Tick the shards in parallel and send their pending galaxy updates, limited to a byte
+ * budget per session on each tick
+ */
+void Server::StreamGalaxy()
+{
+	PROFILE_SCOPE(m_profiler, "galaxy_stream");
+	const uint32_t byte_budget = m_settings.getU32(SERVER_U32SETTING_GALAXY_STREAM_BYTES_PER_TICK);
+	if (PagesSolarSystemNames()) {
+		// Load the names of the next streamed solar systems in parallel, before the shards
+		// read them one by one
+		std::vector<uint64_t> ids;
+		m_shards->CollectNextAdds(byte_budget, ids);
+		std::lock_guard<std::mutex> lock(m_solarsystem_cache_mutex);
+		m_solarsystem_cache->Prefetch(ids);
+	}
+
+	std::vector<NetworkPacket *> packets;
+	m_shards->Tick(byte_budget, packets);
+
+	// Only this thread pushes to the sending queue
+	for (NetworkPacket *galaxy_packet: packets) {
+		SendPacket(galaxy_packet);
+	}
+}
+
+/*
+ * Derived names are generated from the solar system ids, only stored names are paged
+ */
+const bool Server::PagesSolarSystemNames() const
+{
+	return m_solarsystem_cache && !Universe::instance()->HasDerivedNames();
+}
+
+/*
+ * Called by the shard ticks, only looks up the cache. Missing names are loaded by the
+ * prefetch of the next tick, the solar system is streamed then
+ */
+const bool Server::FindPagedSolarSystemName(const uint64_t &id, std::string &name)
+{
+	std::lock_guard<std::mutex> lock(m_solarsystem_cache_mutex);
+	const SolarSystem *ss = m_solarsystem_cache->Find(id);
+	if (!ss) {
+		return false;
+	}
+
+	name = ss->name;
+	return true;
 }
 
 void Server::handlePacket_Chat(NetworkPacket *packet)
@@ -22,13 +22,39 @@
 #include <Urho3D/Core/Thread.h>
 #include <string>
 #include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include "network/networkprotocol.h"
+#include "network/opcodemetrics.h"
+#include "network/packetpool.h"
+#include "network/packetscheduler.h"
+#include "serversettings.h"
+#include "../profiler.h"
 #include "../threadsafe_utils.h"
+#include "../time_utils.h"
 
 namespace spacel {
+
+
 namespace engine {
 
 class Database;
+class DatabaseReadPool;
+class DatabaseWriter;
+class SolarSystemCache;
+class ShardSet;
+
+namespace network {
+class UDPServerThread;
+}
+
+// Packet queues capacity. Received packets are dropped when their queue is full,
+// the server waits for the client to drain the sending queue
+#define SERVER_PACKET_QUEUE_SIZE 4096
+// Pending received packets kept per session, the next ones are dropped
+#define SERVER_SESSION_PENDING_PACKETS 256
 
 /*
  * Started and failed states should be at the end of the end
@@ -45,27 +71,86 @@ enum ServerLoadingStep
 	SERVERLOADINGSTEP_COUNT,
 };
 
+/*
+ * Received packet queues state, readable from any thread
+ */
+struct PacketQueueMetrics
+{
+	// Packets waiting in the receive queue
+	std::atomic<uint32_t> receive_queue_depth{0};
+	// Packets waiting for their session turn, carried over from previous ticks
+	std::atomic<uint32_t> pending_packets{0};
+	std::atomic<uint32_t> processed_last_tick{0};
+	std::atomic<uint64_t> processed_packets{0};
+	// Ticks which ended with pending packets because the budget was used
+	std::atomic<uint64_t> budget_exhausted_ticks{0};
+	// Packets dropped because the receive queue or their session queue was full
+	std::atomic<uint64_t> dropped_packets{0};
+};
+
 class Server: public Urho3D::Thread
 {
 public:
 	Server(const std::string &gamedatapath, const std::string &datapath,
 		   const std::string &universe_name);
+	~Server();
 	void ThreadFunction();
 
 	const ServerLoadingStep GetLoadingStep() const { return m_loading_step; }
+	// Progression of the current loading step, between 0 and 1
+	const float GetLoadingProgress() const
+	{
+		return m_loading_total ? (float) m_loading_progress / m_loading_total : 0.0f;
+	}
 	void SetSinglePlayerMode(const bool s) { m_singleplayer_mode = s; }
+	// Command line overrides of server.json, not saved. 0 keeps the configured value
+	void SetTickRate(const uint32_t tick_rate) { m_tick_rate_override = tick_rate; }
+	void SetPort(const uint16_t port) { m_port_override = port; }
+	/*
+	 * Takes the packet ownership. A full queue drops it instead of waiting, in
+	 * singleplayer the sender is also the consumer of the sending queue
+	 */
 	void ReceivePacket(network::NetworkPacket *packet)
 	{
-		m_packet_receive_queue.push_back(packet);
+		if (!m_packet_receive_queue.try_push(packet)) {
+			m_packet_metrics.dropped_packets++;
+			network::PacketPool::instance()->Release(packet);
+		}
+
+		m_tick_scheduler.Notify();
+	}
+
+	// Thread safe, the session packets and galaxy streaming are dropped on next tick
+	void CloseSession(const uint32_t session_id)
+	{
+		m_closed_sessions.push_back(session_id);
+		m_tick_scheduler.Notify();
 	}
 
 	void SendPacket(network::NetworkPacket *packet)
 	{
 		m_packet_sending_queue.push_back(packet);
+		if (m_packet_listener) {
+			m_packet_listener();
+		}
 	}
 
-	const bool IsSendingQueueEmpty() { return m_packet_sending_queue.empty(); }
-	network::NetworkPacket *PopSendingQueue() { return m_packet_sending_queue.pop_front(); }
+	const PacketQueueMetrics &GetPacketQueueMetrics() const { return m_packet_metrics; }
+
+	// Tick phases, packet handlers by opcode name and queue depths. Can be dumped from
+	// any thread
+	const Profiler &GetProfiler() const { return m_profiler; }
+	// Count, size and handler latency of the received packets, by opcode
+	const network::PacketRouterMetrics &GetRouterMetrics() const { return m_router_metrics; }
+
+	// Called when packets are sent, should be set before Run
+	void SetPacketListener(const std::function<void()> &listener) { m_packet_listener = listener; }
+
+	// Pop up to max_count sent packets, returns the number of popped packets
+	size_t PopSendingQueue(network::NetworkPacket **packets, const size_t max_count)
+	{
+		return m_packet_sending_queue.pop_front(packets, max_count);
+	}
 
 	void handlePacket_Null(network::NetworkPacket *packet) {};
 	void handlePacket_Hello(network::NetworkPacket *packet);
@@ -74,23 +159,67 @@ public:
 	void handlePacket_CharacterCreate(network::NetworkPacket *packet);
 	void handlePacket_CharacterRemove(network::NetworkPacket *packet);
 	void handlePacket_CharacterConnect(network::NetworkPacket *packet);
+	void handlePacket_PlayerPosition(network::NetworkPacket *packet);
 private:
 	const bool InitServer();
+	void LoadGalaxy(const bool galaxy_generated);
 	const bool LoadGameDatas();
 	void StopServer();
 	void Step(const float dtime);
+	void ProcessReceivedPackets();
+	void RemoveClosedSessions();
 	void ProcessPacket(network::NetworkPacket *packet);
 	void RoutePacket(network::NetworkPacket *packet);
+	void StreamGalaxy();
+	const bool PagesSolarSystemNames() const;
+	const bool FindPagedSolarSystemName(const uint64_t &id, std::string &name);
 
 	bool m_singleplayer_mode = false;
+	uint32_t m_tick_rate_override = 0;
+	uint16_t m_port_override = 0;
 	std::string m_gamedatapath = "";
 	std::string m_datapath = "";
 	std::string m_universe_name = "";
+	// Only used by the server thread after loading, writes go through m_db_writer
 	Database *m_db = nullptr;
+	DatabaseWriter *m_db_writer = nullptr;
+	/*
+	 * Only used when solar system paging is enabled, galaxy keeps the solar system
+	 * positions and the cache pages their names in while streaming
+	 */
+	SolarSystemCache *m_solarsystem_cache = nullptr;
+	// Shards look names up in the cache while ticking in parallel, they never load them
+	std::mutex m_solarsystem_cache_mutex;
+	DatabaseReadPool *m_db_read_pool = nullptr;
+	ServerSettings m_settings;
 	std::atomic<ServerLoadingStep> m_loading_step;
+	std::atomic<uint32_t> m_loading_progress;
+	std::atomic<uint32_t> m_loading_total;
+
+	TickScheduler m_tick_scheduler;
+	std::function<void()> m_packet_listener;
+	// Only when not in singleplayer mode
+	network::UDPServerThread *m_network_thread = nullptr;
+
+	// Packet processing budget of the current tick
+	network::PacketScheduler m_packet_scheduler;
+	uint32_t m_tick_processed_packets = 0;
+	std::chrono::steady_clock::duration m_tick_packet_time;
+	PacketQueueMetrics m_packet_metrics;
+
+	Profiler m_profiler;
+	network::PacketRouterMetrics m_router_metrics;
+	uint64_t m_profiled_allocations = 0;
+
+	// Sessions are simulated by galaxy region, shards tick on the shared job system
+	ShardSet *m_shards = nullptr;
 
-	SafeQueue<network::NetworkPacket *> m_packet_sending_queue;
-	SafeQueue<network::NetworkPacket *> m_packet_receive_queue;
+	// Only the server thread sends packets
+	SPSCQueue<network::NetworkPacket *, SERVER_PACKET_QUEUE_SIZE> m_packet_sending_queue;
+	// Packets are received from the client or network threads
+	MPSCQueue<network::NetworkPacket *, SERVER_PACKET_QUEUE_SIZE> m_packet_receive_queue;
+	// Sessions closed by the network thread
+	SafeQueue<uint32_t> m_closed_sessions;
 };
 
 }
@@ -0,0 +1,63 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "serversettings.h"
+
+namespace spacel {
+namespace engine {
+
+static SettingDefault<bool> s_bsettings[SERVER_BSETTINGS_MAX] = {
+		{ "solarsystem_paging", false }, // Read solar system names from the database while streaming
+		{ "galaxy_compact_encoding", true }, // Quantized galaxy streaming, old clients need false
+		{ "solarsystem_derived_names", false }, // Don't store names, only read when generating
+};
+
+static SettingDefault<uint32_t> s_u32settings[SERVER_U32SETTINGS_MAX] = {
+		{ "galaxy_generation_threads", 0 }, // Ranges run on the job system, 0 means one per thread
+		{ "solarsystem_cache_mb", 64 },
+		{ "galaxy_stream_bytes_per_tick", 32 * 1024 },
+		{ "server_tick_rate", 40 }, // Ticks per second
+		{ "server_packets_per_tick", 512 },
+		{ "server_packet_time_budget_us", 10000 }, // Packet processing time per tick
+		{ "server_port", 58000 }, // UDP port, unused in singleplayer
+		{ "server_shards", 0 }, // Galaxy regions ticked in parallel, 0 means one per thread
+		{ "database_flush_interval_ms", 1000 }, // Dirty objects are saved in one transaction
+};
+
+static SettingDefault<float> s_floatsettings[SERVER_FLOATSETTINGS_MAX] = {
+		{ "galaxy_interest_radius", 0.1f }, // In normalized galaxy coordinates
+};
+
+void ServerSettings::init()
+{
+	for (uint8_t i = 0; i < SERVER_BSETTINGS_MAX; ++i) {
+		registerBool(i, s_bsettings[i].default_value, s_bsettings[i].name);
+	}
+
+	for (uint8_t i = 0; i < SERVER_U32SETTINGS_MAX; ++i) {
+		registerU32(i, s_u32settings[i].default_value, s_u32settings[i].name);
+	}
+
+	for (uint8_t i = 0; i < SERVER_FLOATSETTINGS_MAX; ++i) {
+		registerFloat(i, s_floatsettings[i].default_value, s_floatsettings[i].name);
+	}
+}
+
+}
+}
@@ -0,0 +1,66 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../config.h"
+
+namespace spacel {
+namespace engine {
+
+enum ServerBoolSetting {
+	SERVER_BSETTING_SOLARSYSTEM_PAGING = 0,
+	SERVER_BSETTING_GALAXY_COMPACT_ENCODING,
+	SERVER_BSETTING_SOLARSYSTEM_DERIVED_NAMES,
+	SERVER_BSETTINGS_MAX,
+};
+
+enum ServerU32Setting {
+	SERVER_U32SETTING_GALAXY_GENERATION_THREADS = 0,
+	SERVER_U32SETTING_SOLARSYSTEM_CACHE_MB,
+	SERVER_U32SETTING_GALAXY_STREAM_BYTES_PER_TICK,
+	SERVER_U32SETTING_TICK_RATE,
+	SERVER_U32SETTING_PACKETS_PER_TICK,
+	SERVER_U32SETTING_PACKET_TIME_BUDGET_US,
+	SERVER_U32SETTING_PORT,
+	SERVER_U32SETTING_SHARDS,
+	SERVER_U32SETTING_DATABASE_FLUSH_INTERVAL_MS,
+	SERVER_U32SETTINGS_MAX,
+};
+
+enum ServerFloatSetting {
+	SERVER_FLOATSETTING_GALAXY_INTEREST_RADIUS = 0,
+	SERVER_FLOATSETTINGS_MAX,
+};
+
+class ServerSettings: public Config
+{
+public:
+	ServerSettings(): Config(SERVER_BSETTINGS_MAX, SERVER_U32SETTINGS_MAX,
+		SERVER_FLOATSETTINGS_MAX)
+	{
+		init();
+	}
+
+private:
+	virtual void init();
+};
+
+}
+}
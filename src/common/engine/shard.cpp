@@ -0,0 +1,244 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "shard.h"
+#include <cassert>
+#include <cmath>
+#include "galaxyinterest.h"
+#include "network/networkprotocol.h"
+#include "../jobsystem.h"
+#include "../profiler.h"
+
+namespace spacel {
+namespace engine {
+
+Shard::Shard(ShardSet *shard_set, const uint32_t index):
+	m_shard_set(shard_set), m_index(index)
+{
+}
+
+Shard::~Shard()
+{
+	assert(m_outgoing_packets.empty());
+}
+
+void Shard::Post(ShardMessage &&message)
+{
+	std::lock_guard<std::mutex> lock(m_inbox_mutex);
+	m_inbox.push_back(std::move(message));
+}
+
+void Shard::BeginTick()
+{
+	std::lock_guard<std::mutex> lock(m_inbox_mutex);
+	m_messages.swap(m_inbox);
+}
+
+void Shard::Tick(const uint32_t byte_budget)
+{
+	for (ShardMessage &message: m_messages) {
+		switch (message.type) {
+			case SHARD_MESSAGE_ADD_SESSION: {
+				if (m_removed_sessions.erase(message.session_id)) {
+					break;
+				}
+
+				// A newer position may have been sent while the session was handed over
+				auto early_it = m_early_positions.find(message.session_id);
+				if (early_it != m_early_positions.end()) {
+					message.pos_x = early_it->second.pos_x;
+					message.pos_y = early_it->second.pos_y;
+					message.pos_z = early_it->second.pos_z;
+					m_early_positions.erase(early_it);
+				}
+
+				SetSessionPosition(message.session_id, message.interest, message.pos_x,
+					message.pos_y, message.pos_z);
+				break;
+			}
+			case SHARD_MESSAGE_SESSION_POSITION: {
+				auto session_it = m_sessions.find(message.session_id);
+				if (session_it == m_sessions.end()) {
+					m_early_positions[message.session_id] = std::move(message);
+					break;
+				}
+
+				SetSessionPosition(message.session_id, session_it->second, message.pos_x,
+					message.pos_y, message.pos_z);
+				break;
+			}
+			case SHARD_MESSAGE_REMOVE_SESSION: {
+				m_early_positions.erase(message.session_id);
+				// Not handed over yet, it is dropped when it arrives
+				if (!m_sessions.erase(message.session_id)) {
+					m_removed_sessions.insert(message.session_id);
+				}
+				break;
+			}
+			default: assert(false);
+		}
+	}
+	m_messages.clear();
+
+	std::vector<network::NetworkPacket *> packets;
+	for (auto &session: m_sessions) {
+		if (!session.second->HasPendingUpdates()) {
+			continue;
+		}
+
+		session.second->Flush(byte_budget, packets);
+		for (network::NetworkPacket *packet: packets) {
+			packet->SetSessionId(session.first);
+			m_outgoing_packets.push_back(packet);
+		}
+
+		packets.clear();
+	}
+}
+
+void Shard::CollectNextAdds(const uint32_t byte_budget, std::vector<uint64_t> &ids) const
+{
+	for (const auto &session: m_sessions) {
+		session.second->GetNextAdds(byte_budget, ids);
+	}
+}
+
+void Shard::SetSessionPosition(const uint32_t session_id,
+	std::unique_ptr<GalaxyInterest> &interest, const double x, const double y, const double z)
+{
+	const uint32_t shard_index = m_shard_set->GetShardIndex(x, y);
+	if (shard_index == m_index) {
+		interest->SetPosition(x, y, z);
+		if (!m_sessions.count(session_id)) {
+			m_sessions[session_id] = std::move(interest);
+		}
+		return;
+	}
+
+	// Player left the shard region, the other shard gets the session on next tick
+	ShardMessage message = { SHARD_MESSAGE_ADD_SESSION, session_id, x, y, z,
+		std::move(interest) };
+	m_sessions.erase(session_id);
+	m_shard_set->GetShard(shard_index).Post(std::move(message));
+}
+
+ShardSet::ShardSet(const Galaxy *galaxy, const uint32_t shard_count, JobSystem *jobs):
+	m_galaxy(galaxy), m_jobs(jobs)
+{
+	assert(shard_count > 0);
+	for (uint32_t i = 0; i < shard_count; i++) {
+		m_shards.emplace_back(new Shard(this, i));
+	}
+}
+
+ShardSet::~ShardSet()
+{
+}
+
+const uint32_t ShardSet::GetShardIndex(const double x, const double y) const
+{
+	const double angle = std::atan2(y, x) + M_PI;
+	const uint32_t index = (uint32_t) (angle / (2.0 * M_PI) * m_shards.size());
+	return std::min<uint32_t>(index, m_shards.size() - 1);
+}
+
+void ShardSet::AddSession(const uint32_t session_id, std::unique_ptr<GalaxyInterest> interest,
+	const double x, const double y, const double z)
+{
+	// Added sessions start where the player is
+	const uint32_t shard_index = GetShardIndex(x, y);
+	m_session_shards[session_id] = shard_index;
+	ShardMessage message = { SHARD_MESSAGE_ADD_SESSION, session_id, x, y, z,
+		std::move(interest) };
+	m_shards[shard_index]->Post(std::move(message));
+}
+
+void ShardSet::SetSessionPosition(const uint32_t session_id, const double x, const double y,
+	const double z)
+{
+	auto shard_it = m_session_shards.find(session_id);
+	if (shard_it == m_session_shards.end()) {
+		return;
+	}
+
+	// The current owner hands the session over if the player left its region
+	ShardMessage message = { SHARD_MESSAGE_SESSION_POSITION, session_id, x, y, z, nullptr };
+	m_shards[shard_it->second]->Post(std::move(message));
+	shard_it->second = GetShardIndex(x, y);
+}
+
+void ShardSet::RemoveSession(const uint32_t session_id)
+{
+	auto shard_it = m_session_shards.find(session_id);
+	if (shard_it == m_session_shards.end()) {
+		return;
+	}
+
+	// Sent to the shard which owns the session once its pending messages are handled
+	ShardMessage message = { SHARD_MESSAGE_REMOVE_SESSION, session_id, 0.0, 0.0, 0.0,
+		nullptr };
+	m_shards[shard_it->second]->Post(std::move(message));
+	m_session_shards.erase(shard_it);
+}
+
+void ShardSet::CollectNextAdds(const uint32_t byte_budget, std::vector<uint64_t> &ids) const
+{
+	for (const auto &shard: m_shards) {
+		shard->CollectNextAdds(byte_budget, ids);
+	}
+}
+
+void ShardSet::Tick(const uint32_t byte_budget, std::vector<network::NetworkPacket *> &packets)
+{
+	// Tick boundary, messages posted by this tick wait for the next one
+	for (auto &shard: m_shards) {
+		shard->BeginTick();
+	}
+
+	Profiler *profiler = m_profiler;
+	auto tick = [profiler, byte_budget] (Shard *s) {
+		const uint64_t start = profiler ? profiler->GetTime() : 0;
+		s->Tick(byte_budget);
+		if (profiler) {
+			profiler->RecordScope("shard_tick", start, profiler->GetTime());
+		}
+	};
+
+	if (m_jobs) {
+		JobCounter counter;
+		for (auto &shard: m_shards) {
+			Shard *s = shard.get();
+			m_jobs->Submit([&tick, s] { tick(s); }, &counter);
+		}
+		m_jobs->Wait(counter);
+	} else {
+		for (auto &shard: m_shards) {
+			tick(shard.get());
+		}
+	}
+
+	for (auto &shard: m_shards) {
+		std::vector<network::NetworkPacket *> &outgoing = shard->GetOutgoingPackets();
+		packets.insert(packets.end(), outgoing.begin(), outgoing.end());
+		outgoing.clear();
+	}
+}
+
+}
+}
@@ -0,0 +1,154 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace spacel {
+
+class JobSystem;
+class Profiler;
+
+namespace engine {
+
+struct Galaxy;
+class GalaxyInterest;
+class ShardSet;
+
+namespace network {
+class NetworkPacket;
+}
+
+enum ShardMessageType
+{
+	// Session handed over with its galaxy interest
+	SHARD_MESSAGE_ADD_SESSION,
+	SHARD_MESSAGE_SESSION_POSITION,
+	SHARD_MESSAGE_REMOVE_SESSION,
+};
+
+struct ShardMessage
+{
+	ShardMessageType type;
+	uint32_t session_id;
+	double pos_x;
+	double pos_y;
+	double pos_z;
+	std::unique_ptr<GalaxyInterest> interest;
+};
+
+/*
+ * Galaxy region simulated on its own. A shard owns the sessions whose player is in its
+ * region, it only touches its own state while ticking and talks to other shards with
+ * messages. Messages posted during a tick are handled on the next tick
+ */
+class Shard
+{
+public:
+	Shard(ShardSet *shard_set, const uint32_t index);
+	~Shard();
+
+	// Thread safe
+	void Post(ShardMessage &&message);
+
+	// Take the messages posted until now, no shard may be ticking
+	void BeginTick();
+	// Handle the messages and stream galaxy updates of the shard sessions
+	void Tick(const uint32_t byte_budget);
+
+	// Append the solar systems each session may stream on next tick
+	void CollectNextAdds(const uint32_t byte_budget, std::vector<uint64_t> &ids) const;
+
+	// Packets produced by the last tick, with their session id
+	std::vector<network::NetworkPacket *> &GetOutgoingPackets() { return m_outgoing_packets; }
+	const size_t GetSessionCount() const { return m_sessions.size(); }
+	const bool HasSession(const uint32_t session_id) const
+	{
+		return m_sessions.find(session_id) != m_sessions.end();
+	}
+
+private:
+	void SetSessionPosition(const uint32_t session_id, std::unique_ptr<GalaxyInterest> &interest,
+		const double x, const double y, const double z);
+
+	ShardSet *m_shard_set;
+	uint32_t m_index;
+
+	std::mutex m_inbox_mutex;
+	std::vector<ShardMessage> m_inbox;
+	// Messages of the current tick
+	std::vector<ShardMessage> m_messages;
+
+	std::unordered_map<uint32_t, std::unique_ptr<GalaxyInterest>> m_sessions;
+	// Positions received before their session was handed over, the newest wins
+	std::unordered_map<uint32_t, ShardMessage> m_early_positions;
+	// Sessions removed while they were handed over to this shard
+	std::unordered_set<uint32_t> m_removed_sessions;
+	std::vector<network::NetworkPacket *> m_outgoing_packets;
+};
+
+/*
+ * Galaxy split into angular sectors around its center, one shard per sector. Shards tick
+ * in parallel on the job system, called from the server thread only
+ */
+class ShardSet
+{
+public:
+	// Without job system, shards tick one after another on the calling thread
+	ShardSet(const Galaxy *galaxy, const uint32_t shard_count, JobSystem *jobs = nullptr);
+	~ShardSet();
+
+	const uint32_t GetShardIndex(const double x, const double y) const;
+	const size_t GetShardCount() const { return m_shards.size(); }
+	Shard &GetShard(const uint32_t index) { return *m_shards[index]; }
+	const Galaxy *GetGalaxy() const { return m_galaxy; }
+
+	void AddSession(const uint32_t session_id, std::unique_ptr<GalaxyInterest> interest,
+		const double x, const double y, const double z);
+	void SetSessionPosition(const uint32_t session_id, const double x, const double y,
+		const double z);
+	// The session galaxy interest is destroyed by its shard on next tick
+	void RemoveSession(const uint32_t session_id);
+
+	// Shard ticks are recorded as "shard_tick" scopes when set
+	void SetProfiler(Profiler *profiler) { m_profiler = profiler; }
+
+	// Solar systems the next tick may stream, no shard may be ticking
+	void CollectNextAdds(const uint32_t byte_budget, std::vector<uint64_t> &ids) const;
+
+	// Tick every shard and append their outgoing packets
+	void Tick(const uint32_t byte_budget, std::vector<network::NetworkPacket *> &packets);
+
+private:
+	const Galaxy *m_galaxy;
+	JobSystem *m_jobs;
+	Profiler *m_profiler = nullptr;
+	std::vector<std::unique_ptr<Shard>> m_shards;
+	// Shard owning each session once posted messages are handled
+	std::unordered_map<uint32_t, uint32_t> m_session_shards;
+};
+
+}
+}
@@ -0,0 +1,169 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <Urho3D/IO/Log.h>
+#include "solarsystemcache.h"
+#include "databases/database-sqlite3.h"
+#include "databases/databasereadpool.h"
+#include "databases/databasewriter.h"
+#include "../jobsystem.h"
+
+namespace spacel {
+namespace engine {
+
+// Solar systems loaded by a prefetch job
+#define SOLARSYSTEM_PREFETCH_GRAIN 64
+
+SolarSystemCache::SolarSystemCache(Database *db, Galaxy *galaxy, const size_t memory_budget):
+	m_db(db), m_galaxy(galaxy), m_memory_budget(memory_budget)
+{
+	assert(m_db && m_galaxy);
+}
+
+SolarSystem *SolarSystemCache::Get(const uint64_t &id)
+{
+	auto index_it = m_index.find(id);
+	if (index_it != m_index.end()) {
+		m_hits++;
+		m_lru.splice(m_lru.begin(), m_lru, index_it->second.it);
+		return &m_lru.front();
+	}
+
+	m_misses++;
+	SolarSystem ss;
+	if (m_writer && m_writer->GetPendingSolarSystem(id, &ss)) {
+		if (ss.galaxy->id != m_galaxy->id) {
+			return nullptr;
+		}
+		ss.galaxy = m_galaxy;
+	} else if (!m_db->LoadSolarSystem(m_galaxy, id, &ss)) {
+		return nullptr;
+	}
+
+	Insert(std::move(ss));
+	return &m_lru.front();
+}
+
+SolarSystem *SolarSystemCache::Find(const uint64_t &id)
+{
+	auto index_it = m_index.find(id);
+	if (index_it == m_index.end()) {
+		return nullptr;
+	}
+
+	m_hits++;
+	m_lru.splice(m_lru.begin(), m_lru, index_it->second.it);
+	return &m_lru.front();
+}
+
+size_t SolarSystemCache::Prefetch(const std::vector<uint64_t> &ids)
+{
+	// Pending writes are served by Get, they must not be loaded from the database
+	std::vector<uint64_t> missing;
+	SolarSystem pending;
+	for (const uint64_t &id: ids) {
+		if (!Contains(id) && !(m_writer && m_writer->GetPendingSolarSystem(id, &pending))) {
+			missing.push_back(id);
+		}
+	}
+
+	std::vector<SolarSystem> loaded(missing.size());
+	std::vector<uint8_t> found(missing.size(), 0);
+	const auto load_range = [&](Database *db, const uint64_t begin, const uint64_t end) {
+		for (uint64_t i = begin; i < end; i++) {
+			found[i] = db->LoadSolarSystem(m_galaxy, missing[i], &loaded[i]) ? 1 : 0;
+		}
+	};
+
+	if (m_read_pool && m_jobs) {
+		m_jobs->ParallelFor(0, missing.size(), SOLARSYSTEM_PREFETCH_GRAIN,
+			[&](const uint64_t begin, const uint64_t end) {
+				// Exceptions can't leave the jobs, the range is reported as not found
+				try {
+					load_range(m_read_pool->Get(), begin, end);
+				}
+				catch (SQLiteException &e) {
+					URHO3D_LOGERROR(e.what());
+				}
+			});
+	} else {
+		load_range(m_db, 0, missing.size());
+	}
+
+	size_t count = 0;
+	for (size_t i = 0; i < missing.size(); i++) {
+		// Duplicated ids are loaded twice but cached once
+		if (found[i] && !Contains(missing[i])) {
+			Insert(std::move(loaded[i]));
+			count++;
+		}
+	}
+
+	m_misses += count;
+	return count;
+}
+
+void SolarSystemCache::Clear()
+{
+	m_lru.clear();
+	m_index.clear();
+	m_memory_usage = 0;
+}
+
+/*
+ * Estimated memory used by a cached solar system: list node, index node and name
+ */
+const size_t SolarSystemCache::EntrySize(const SolarSystem &ss)
+{
+	return sizeof(SolarSystem) + 2 * sizeof(void *) +
+		sizeof(std::pair<uint64_t, CacheEntry>) + sizeof(void *) +
+		ss.name.capacity() + ss.planets.capacity() * sizeof(Planet *);
+}
+
+/*
+ * Size is computed once, the caller can modify the returned object
+ */
+void SolarSystemCache::Insert(SolarSystem &&ss)
+{
+	const uint64_t id = ss.id;
+	const size_t entry_size = EntrySize(ss);
+	m_lru.push_front(std::move(ss));
+	m_index[id] = { m_lru.begin(), entry_size };
+	m_memory_usage += entry_size;
+	Evict();
+}
+
+/*
+ * Evict least recently used solar systems while over budget, the most recent one is
+ * always kept
+ */
+void SolarSystemCache::Evict()
+{
+	while (m_memory_usage > m_memory_budget && m_lru.size() > 1) {
+		auto index_it = m_index.find(m_lru.back().id);
+		assert(index_it != m_index.end());
+		m_memory_usage -= index_it->second.size;
+		m_index.erase(index_it);
+		m_lru.pop_back();
+	}
+}
+
+}
+}
@@ -0,0 +1,109 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "space.h"
+
+namespace spacel {
+
+class JobSystem;
+
+namespace engine {
+
+class Database;
+class DatabaseReadPool;
+class DatabaseWriter;
+
+/*
+ * Keeps the most recently used solar systems of a galaxy in memory and loads the other
+ * ones from the database on demand. Least recently used systems are evicted once the
+ * memory budget is exceeded.
+ * This is not thread safe
+ */
+class SolarSystemCache
+{
+public:
+	SolarSystemCache(Database *db, Galaxy *galaxy, const size_t memory_budget);
+	~SolarSystemCache() {}
+
+	/*
+	 * Returns nullptr if the solar system doesn't exist in this galaxy. The returned
+	 * pointer is valid until the next Get call
+	 */
+	SolarSystem *Get(const uint64_t &id);
+	// Returns nullptr if the solar system is not cached, nothing is loaded
+	SolarSystem *Find(const uint64_t &id);
+	const bool Contains(const uint64_t &id) const { return m_index.find(id) != m_index.end(); }
+	// Solar systems with a pending write are loaded from the writer instead of the database
+	void SetWriter(const DatabaseWriter *writer) { m_writer = writer; }
+	// Prefetch loads on the job system, each worker reads from its pool connection
+	void SetReadPool(DatabaseReadPool *pool, JobSystem *jobs)
+	{
+		m_read_pool = pool;
+		m_jobs = jobs;
+	}
+
+	/*
+	 * Load the solar systems which are not cached yet, in parallel when a read pool is set.
+	 * Returns the number of loaded solar systems
+	 */
+	size_t Prefetch(const std::vector<uint64_t> &ids);
+	void Clear();
+
+	const size_t size() const { return m_index.size(); }
+	const size_t GetMemoryUsage() const { return m_memory_usage; }
+	const size_t GetMemoryBudget() const { return m_memory_budget; }
+	const uint64_t GetHits() const { return m_hits; }
+	const uint64_t GetMisses() const { return m_misses; }
+
+private:
+	static const size_t EntrySize(const SolarSystem &ss);
+	void Insert(SolarSystem &&ss);
+	void Evict();
+
+	Database *m_db = nullptr;
+	const DatabaseWriter *m_writer = nullptr;
+	DatabaseReadPool *m_read_pool = nullptr;
+	JobSystem *m_jobs = nullptr;
+	Galaxy *m_galaxy = nullptr;
+	size_t m_memory_budget;
+	size_t m_memory_usage = 0;
+
+	struct CacheEntry
+	{
+		std::list<SolarSystem>::iterator it;
+		size_t size;
+	};
+
+	// Most recently used solar system is at the front
+	std::list<SolarSystem> m_lru;
+	std::unordered_map<uint64_t, CacheEntry> m_index;
+
+	uint64_t m_hits = 0;
+	uint64_t m_misses = 0;
+};
+
+}
+}
@@ -17,71 +17,279 @@
  * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include "space.h"
 #include "generators.h"
+#include "../jobsystem.h"
 
 #define _USE_MATH_DEFINES
 
 namespace spacel {
 namespace engine {
 
-Planet::~Planet()
+Universe::~Universe()
+{
+	for (auto &galaxy: m_galaxies) {
+		delete galaxy.second;
+	}
+
+	// @TODO save current new object ids
+}
+
+void SolarSystemHandle::ToSolarSystem(SolarSystem *ss) const
+{
+	ss->id = GetId();
+	ss->name = GetName();
+	ss->type = GetType();
+	ss->radius = GetRadius();
+	ss->pos_x = GetPosX();
+	ss->pos_y = GetPosY();
+	ss->pos_z = GetPosZ();
+}
+
+const std::string SolarSystemHandle::GetName() const
+{
+	return m_table->GetName(m_row);
+}
+
+const std::string SolarSystemHandle::GetStoredName() const
+{
+	return m_table->GetStoredName(m_row);
+}
+
+/*
+ * Materialize a solar system row as an object owned by the galaxy arena
+ */
+SolarSystem *Galaxy::CreateSolarSystemObject(const uint32_t row)
+{
+	SolarSystem *ss = arena.Create<SolarSystem>();
+	solar_systems[row].ToSolarSystem(ss);
+	ss->galaxy = this;
+	return ss;
+}
+
+const std::string SolarSystemTable::GetName(const uint32_t row) const
+{
+	if (m_name_lengths[row] == 0) {
+		// A derived name would differ from the cleared stored one
+		assert(!m_names_cleared);
+		return UnivGen->generate_solarsystem_name(m_ids[row]);
+	}
+
+	return GetStoredName(row);
+}
+
+/*
+ * Add an empty row for solar system id, attributes should be set with Set and SetName
+ */
+uint32_t SolarSystemTable::Add(const uint64_t &id)
+{
+	assert(m_index.find(id) == m_index.end());
+
+	const uint32_t row = m_ids.size();
+	m_ids.push_back(id);
+	m_types.push_back(SOLAR_TYPE_CLASSIC);
+	m_radius.push_back(0.0);
+	m_pos_x.push_back(0.0);
+	m_pos_y.push_back(0.0);
+	m_pos_z.push_back(0.0);
+	m_name_offsets.push_back(m_name_pool.size());
+	m_name_lengths.push_back(0);
+	m_index[id] = row;
+	return row;
+}
+
+uint32_t SolarSystemTable::Add(const SolarSystem *ss)
+{
+	const uint32_t row = Add(ss->id);
+	Set(row, ss->type, ss->radius, ss->pos_x, ss->pos_y, ss->pos_z);
+	SetName(row, ss->name);
+	return row;
+}
+
+/*
+ * Rows are independent, Set can be called on different rows from multiple threads
+ */
+void SolarSystemTable::Set(const uint32_t row, const SolarType type, const double radius,
+	const double pos_x, const double pos_y, const double pos_z)
+{
+	assert(row < m_ids.size());
+	m_types[row] = type;
+	m_radius[row] = radius;
+	m_pos_x[row] = pos_x;
+	m_pos_y[row] = pos_y;
+	m_pos_z[row] = pos_z;
+}
+
+void SolarSystemTable::SetName(const uint32_t row, const std::string &name)
+{
+	assert(row < m_ids.size());
+	assert(name.size() <= UINT8_MAX);
+	m_name_pool_garbage += m_name_lengths[row];
+	m_name_offsets[row] = m_name_pool.size();
+	m_name_lengths[row] = name.size();
+	m_name_pool += name;
+}
+
+bool SolarSystemTable::Remove(const uint64_t &id)
 {
-	for (auto &moon: moons) {
-		delete moon;
+	auto index_it = m_index.find(id);
+	if (index_it == m_index.end()) {
+		return false;
+	}
+
+	// Move the last row in place of the removed one
+	const uint32_t row = index_it->second, last_row = m_ids.size() - 1;
+	m_name_pool_garbage += m_name_lengths[row];
+	if (row != last_row) {
+		m_ids[row] = m_ids[last_row];
+		m_types[row] = m_types[last_row];
+		m_radius[row] = m_radius[last_row];
+		m_pos_x[row] = m_pos_x[last_row];
+		m_pos_y[row] = m_pos_y[last_row];
+		m_pos_z[row] = m_pos_z[last_row];
+		m_name_offsets[row] = m_name_offsets[last_row];
+		m_name_lengths[row] = m_name_lengths[last_row];
+		m_index[m_ids[row]] = row;
+	}
+
+	m_ids.pop_back();
+	m_types.pop_back();
+	m_radius.pop_back();
+	m_pos_x.pop_back();
+	m_pos_y.pop_back();
+	m_pos_z.pop_back();
+	m_name_offsets.pop_back();
+	m_name_lengths.pop_back();
+	m_index.erase(index_it);
+
+	if (m_name_pool_garbage > m_name_pool.size() / 2) {
+		CompactNamePool();
 	}
+	return true;
 }
-SolarSystem::~SolarSystem()
+
+bool SolarSystemTable::Find(const uint64_t &id, uint32_t &row) const
 {
-	for (auto &planet: planets) {
-		delete planet;
+	auto index_it = m_index.find(id);
+	if (index_it == m_index.end()) {
+		return false;
 	}
+
+	row = index_it->second;
+	return true;
 }
 
-Galaxy::~Galaxy()
+void SolarSystemTable::Reserve(const uint32_t count)
 {
-	for (auto &ss: solar_systems) {
-		delete ss.second;
+	m_ids.reserve(count);
+	m_types.reserve(count);
+	m_radius.reserve(count);
+	m_pos_x.reserve(count);
+	m_pos_y.reserve(count);
+	m_pos_z.reserve(count);
+	m_name_offsets.reserve(count);
+	m_name_lengths.reserve(count);
+	m_index.reserve(count);
+}
+
+void SolarSystemTable::Clear()
+{
+	m_ids.clear();
+	m_types.clear();
+	m_radius.clear();
+	m_pos_x.clear();
+	m_pos_y.clear();
+	m_pos_z.clear();
+	m_name_pool.clear();
+	m_name_offsets.clear();
+	m_name_lengths.clear();
+	m_name_pool_garbage = 0;
+	m_names_cleared = false;
+	m_index.clear();
+}
+
+void SolarSystemTable::ClearNames()
+{
+	std::string().swap(m_name_pool);
+	std::fill(m_name_offsets.begin(), m_name_offsets.end(), 0);
+	std::fill(m_name_lengths.begin(), m_name_lengths.end(), 0);
+	m_name_pool_garbage = 0;
+	m_names_cleared = true;
+}
+
+void SolarSystemTable::CompactNamePool()
+{
+	std::string name_pool;
+	name_pool.reserve(m_name_pool.size() - m_name_pool_garbage);
+	for (uint32_t row = 0; row < m_ids.size(); ++row) {
+		const uint32_t offset = name_pool.size();
+		name_pool.append(m_name_pool, m_name_offsets[row], m_name_lengths[row]);
+		m_name_offsets[row] = offset;
 	}
+
+	m_name_pool.swap(name_pool);
+	m_name_pool_garbage = 0;
 }
 
-Universe::~Universe()
+Galaxy *Universe::FindSolarSystem(const uint64_t &id, uint32_t &row)
 {
-	// Don't delete solar systems, it's done by deleting galaxies
 	for (auto &galaxy: m_galaxies) {
-		delete galaxy.second;
+		if (galaxy.second->solar_systems.Find(id, row)) {
+			return galaxy.second;
+		}
 	}
 
-	// @TODO save current new object ids
+	return nullptr;
 }
 
 /*
  * This function init solar system without its planets
  */
-SolarSystem *Universe::CreateSolarSystem(Galaxy *galaxy)
+SolarSystemHandle Universe::CreateSolarSystem(Galaxy *galaxy)
 {
-	while (m_solar_systems.find(m_next_solarsystem_id) != m_solar_systems.end()) {
+	uint32_t row;
+	while (FindSolarSystem(m_next_solarsystem_id, row)) {
 		m_next_solarsystem_id++;
 	}
 
-	SolarSystem *ss = new SolarSystem();
-	ss->id = m_next_solarsystem_id;
-	ss->name = UnivGen->generate_world_name();
-	ss->radius = UnivGen->generate_solarsystem_radius(m_next_solarsystem_id);
-	ss->type = (SolarType) UnivGen->generate_solarsystem_type(m_next_solarsystem_id);
+	row = galaxy->solar_systems.Add(m_next_solarsystem_id++);
 
-	// Note: positions are generated by galaxy itself
-	ss->galaxy = galaxy;
+	std::string name;
+	GenerateSolarSystem(galaxy->solar_systems, row, name);
+	if (!m_derived_names) {
+		galaxy->solar_systems.SetName(row, name);
+	}
 
-	galaxy->solar_systems[m_next_solarsystem_id] = ss;
-	m_solar_systems[m_next_solarsystem_id] = ss;
-	m_next_solarsystem_id++;
+	const SolarSystemHandle ss = galaxy->solar_systems[row];
+	galaxy->spatial_index.Insert(ss.GetId(), ss.GetPosX(), ss.GetPosY(), ss.GetPosZ());
 	return ss;
 }
 
-void Universe::CreateSolarSystemPhase2(SolarSystem *ss)
+/*
+ * Generate solar system attributes. Every attribute only depends on the universe seed
+ * and the solar system id, this is safe to call from multiple threads on different rows.
+ * The name is returned because the name pool can only be modified by one thread, it is
+ * left empty when names are derived
+ */
+void Universe::GenerateSolarSystem(SolarSystemTable &solar_systems, const uint32_t row,
+	std::string &name)
+{
+	static const GalaxyShape galaxy_shape;
+
+	const uint64_t ss_id = solar_systems.GetIds()[row];
+	double pos_x, pos_y, pos_z;
+	UnivGen->generate_solarsystem_galaxypos(ss_id, galaxy_shape, pos_x, pos_y, pos_z);
+	solar_systems.Set(row, (SolarType) UnivGen->generate_solarsystem_type(ss_id),
+		UnivGen->generate_solarsystem_radius(ss_id), pos_x, pos_y, pos_z);
+	if (!m_derived_names) {
+		name = UnivGen->generate_solarsystem_name(ss_id);
+	}
+}
+
+void Universe::CreateSolarSystemPhase2(Galaxy *galaxy, SolarSystem *ss)
 {
 	uint8_t planet_number = UnivGen->generate_solarsystem_planetnumber(ss);
 
@@ -92,9 +300,9 @@ void Universe::CreateSolarSystemPhase2(SolarSystem *ss)
 			m_next_galaxy_id++;
 		}*/
 
-		Planet *planet = new Planet();
+		Planet *planet = galaxy->arena.Create<Planet>();
 		planet->id = m_next_planet_id;
-		planet->name = UnivGen->generate_world_name();
+		planet->name = UnivGen->generate_planet_name(planet->id);
 		planet->type = (PlanetType) UnivGen->generate_planet_type(planet->id);
 		planet->radius = UnivGen->generate_planet_radius(planet->id, planet->type);
 		planet->distance_to_parent = UnivGen->
@@ -109,23 +317,15 @@ void Universe::CreateSolarSystemPhase2(SolarSystem *ss)
 
 bool Universe::RemoveSolarSystem(const uint64_t &id)
 {
-	SolarSystemMap::iterator ss_it = m_solar_systems.find(id);
-	if (ss_it == m_solar_systems.end()) {
+	uint32_t row;
+	Galaxy *galaxy = FindSolarSystem(id, row);
+	if (!galaxy) {
 		return false;
 	}
 
-	// If there is galaxy drop the pointer from the galaxy
-	if (Galaxy *galaxy = (*ss_it).second->galaxy) {
-		SolarSystemMap::iterator ss_galaxy_it = galaxy->solar_systems.find(id);
-		if (ss_galaxy_it != galaxy->solar_systems.end()) {
-			galaxy->solar_systems.erase(ss_galaxy_it);
-		}
-	}
-
-	// And then destroy object and reference in universe
-	delete (*ss_it).second;
-	m_solar_systems.erase(ss_it);
-	return true;
+	const SolarSystemHandle ss = galaxy->solar_systems[row];
+	galaxy->spatial_index.Remove(id, ss.GetPosX(), ss.GetPosY(), ss.GetPosZ());
+	return galaxy->solar_systems.Remove(id);
 }
 
 bool Universe::SetGalaxy(Galaxy *galaxy)
@@ -147,7 +347,7 @@ Galaxy *Universe::GetGalaxy(const uint64_t &id)
 	return m_galaxies[id];
 }
 
-Galaxy *Universe::CreateGalaxy(const uint64_t &max_solar_systems)
+Galaxy *Universe::CreateGalaxy(const uint64_t &max_solar_systems, uint32_t worker_count)
 {
 	// Increment id if there is galaxies
 	while (m_galaxies.find(m_next_galaxy_id) != m_galaxies.end()) {
@@ -156,30 +356,40 @@ Galaxy *Universe::CreateGalaxy(const uint64_t &max_solar_systems)
 
 	Galaxy *galaxy = new Galaxy();
 	galaxy->id = m_next_galaxy_id;
-	galaxy->name = UnivGen->generate_world_name();
-
-	uint8_t spiral_arms = 2;
-	uint16_t spiral_angle_degrees = 360;
-	float min_radius = 0.05, max_radius = 0.9, thickness = 0.1,
-		scatter_theta = M_PI / spiral_arms * 0.2,
-		scatter_radius = min_radius * 0.4,
-		spiral_b = spiral_angle_degrees / M_PI * min_radius / max_radius;
-
-	// Hardcoded but need some seed
-	for (uint32_t i = 0; i < max_solar_systems; ++i) {
-		SolarSystem *ss = CreateSolarSystem(galaxy);
-
-		float r = UnivGen->generate_galaxypos_radius(min_radius, max_radius);
-		float theta = spiral_b * log(r / max_radius) +
-				UnivGen->generate_galaxypos_gauss_random(scatter_theta);
-		r += UnivGen->generate_galaxypos_gauss_random(scatter_radius);
-		// assign to a spiral arm
-		theta += UnivGen->generate_galaxypos_urange(spiral_arms - 1) * M_PI * 2 / spiral_arms;
-		ss->pos_x = cos(theta) * r;
-		ss->pos_y = sin(theta) * r;
-		ss->pos_z = UnivGen->generate_galaxypos_gauss_random(thickness * 0.5);
+	galaxy->name = UnivGen->generate_galaxy_name(galaxy->id);
+
+	// Reserve solar system ids first, generated values only depend on them, then the
+	// result is the same whatever the worker number is
+	SolarSystemTable &solar_systems = galaxy->solar_systems;
+	solar_systems.Reserve(max_solar_systems);
+	for (uint64_t i = 0; i < max_solar_systems; ++i) {
+		uint32_t row;
+		while (FindSolarSystem(m_next_solarsystem_id, row)) {
+			m_next_solarsystem_id++;
+		}
+
+		solar_systems.Add(m_next_solarsystem_id++);
 	}
 
+	JobSystem *jobs = JobSystem::instance();
+	if (worker_count == 0) {
+		worker_count = jobs->GetWorkerCount() + 1;
+	}
+
+	std::vector<std::string> names(max_solar_systems);
+	jobs->ParallelFor(0, max_solar_systems, max_solar_systems / worker_count + 1,
+		[this, &solar_systems, &names] (uint64_t begin, uint64_t end) {
+			for (uint64_t row = begin; row < end; ++row) {
+				GenerateSolarSystem(solar_systems, row, names[row]);
+			}
+		});
+
+	for (uint64_t row = 0; !m_derived_names && row < max_solar_systems; ++row) {
+		solar_systems.SetName(row, names[row]);
+	}
+
+	galaxy->spatial_index.Build(solar_systems, worker_count);
+
 	m_galaxies[m_next_galaxy_id] = galaxy;
 
 	m_next_galaxy_id++;
@@ -193,7 +403,9 @@ bool Universe::RemoveGalaxy(const uint64_t &id)
 		return false;
 	}
 
+	// Every object of the galaxy is released with its arena
 	delete (*galaxy_it).second;
+	m_galaxies.erase(galaxy_it);
 	return true;
 }
 
@@ -20,8 +20,11 @@
 #pragma once
 
 #include <cstdint>
+#include <string>
 #include <vector>
 #include <unordered_map>
+#include "../arena_utils.h"
+#include "spatialindex.h"
 
 namespace spacel {
 
@@ -90,7 +93,6 @@ struct Moon: public StellarObject
  */
 struct Planet: public Moon
 {
-	~Planet();
 	std::vector<Moon *> moons;
 };
 
@@ -101,20 +103,142 @@ struct Galaxy; // Predefine for circular dep
 
 struct SolarSystem: public StellarPositionnedObject
 {
-	~SolarSystem();
 	SolarType type;
 	std::vector<Planet *> planets;
 	Galaxy *galaxy = nullptr;
 };
-typedef std::unordered_map<uint64_t, SolarSystem *> SolarSystemMap;
+
+class SolarSystemTable;
+
+/*
+ * Read only view on a SolarSystemTable row, it's valid until a solar system is removed
+ * from the table
+ */
+class SolarSystemHandle
+{
+public:
+	SolarSystemHandle(const SolarSystemTable *table, const uint32_t row):
+		m_table(table), m_row(row) {}
+
+	inline const uint32_t GetRow() const { return m_row; }
+	inline const uint64_t GetId() const;
+	inline const SolarType GetType() const;
+	inline const double GetRadius() const;
+	inline const double GetPosX() const;
+	inline const double GetPosY() const;
+	inline const double GetPosZ() const;
+	const std::string GetName() const;
+	const std::string GetStoredName() const;
+
+	// Copy the solar system into a standalone object
+	void ToSolarSystem(SolarSystem *ss) const;
+
+	inline SolarSystemHandle &operator++()
+	{
+		m_row++;
+		return *this;
+	}
+	inline const SolarSystemHandle &operator *() const { return *this; }
+	inline bool operator!=(const SolarSystemHandle &other) const { return m_row != other.m_row; }
+
+private:
+	const SolarSystemTable *m_table;
+	uint32_t m_row;
+};
+
+/*
+ * Columnar solar system storage: one contiguous array per attribute, names are stored in a
+ * single string pool. Rows are not stable, removing a solar system moves the last row
+ * in its place, use ids to keep references
+ */
+class SolarSystemTable
+{
+public:
+	SolarSystemTable() {}
+
+	uint32_t Add(const uint64_t &id);
+	uint32_t Add(const SolarSystem *ss);
+	void Set(const uint32_t row, const SolarType type, const double radius,
+		const double pos_x, const double pos_y, const double pos_z);
+	void SetName(const uint32_t row, const std::string &name);
+	bool Remove(const uint64_t &id);
+	bool Find(const uint64_t &id, uint32_t &row) const;
+	void Reserve(const uint32_t count);
+	void Clear();
+	/*
+	 * Forget the stored names and keep the other attributes, the names are read from
+	 * the database. They can't be derived anymore, GetName must not be called
+	 */
+	void ClearNames();
+
+	inline const uint32_t size() const { return m_ids.size(); }
+	inline const bool empty() const { return m_ids.empty(); }
+	inline SolarSystemHandle operator[](const uint32_t row) const
+	{
+		return SolarSystemHandle(this, row);
+	}
+	inline SolarSystemHandle begin() const { return SolarSystemHandle(this, 0); }
+	inline SolarSystemHandle end() const { return SolarSystemHandle(this, size()); }
+
+	const std::vector<uint64_t> &GetIds() const { return m_ids; }
+	const std::vector<uint8_t> &GetTypes() const { return m_types; }
+	const std::vector<double> &GetRadius() const { return m_radius; }
+	const std::vector<double> &GetPosX() const { return m_pos_x; }
+	const std::vector<double> &GetPosY() const { return m_pos_y; }
+	const std::vector<double> &GetPosZ() const { return m_pos_z; }
+	/*
+	 * Solar system name, names which are not stored are derived from the universe seed
+	 * and the solar system id
+	 */
+	const std::string GetName(const uint32_t row) const;
+	// Name kept in the name pool, empty if the name is derived
+	const std::string GetStoredName(const uint32_t row) const
+	{
+		return m_name_pool.substr(m_name_offsets[row], m_name_lengths[row]);
+	}
+
+private:
+	void CompactNamePool();
+
+	std::vector<uint64_t> m_ids;
+	std::vector<uint8_t> m_types;
+	std::vector<double> m_radius;
+	std::vector<double> m_pos_x;
+	std::vector<double> m_pos_y;
+	std::vector<double> m_pos_z;
+
+	std::string m_name_pool;
+	std::vector<uint32_t> m_name_offsets;
+	std::vector<uint8_t> m_name_lengths;
+	uint32_t m_name_pool_garbage = 0;
+	bool m_names_cleared = false;
+
+	std::unordered_map<uint64_t, uint32_t> m_index;
+};
+
+inline const uint64_t SolarSystemHandle::GetId() const { return m_table->GetIds()[m_row]; }
+inline const SolarType SolarSystemHandle::GetType() const
+{
+	return (SolarType) m_table->GetTypes()[m_row];
+}
+inline const double SolarSystemHandle::GetRadius() const { return m_table->GetRadius()[m_row]; }
+inline const double SolarSystemHandle::GetPosX() const { return m_table->GetPosX()[m_row]; }
+inline const double SolarSystemHandle::GetPosY() const { return m_table->GetPosY()[m_row]; }
+inline const double SolarSystemHandle::GetPosZ() const { return m_table->GetPosZ()[m_row]; }
 
 /*
  * Galaxies
  */
 struct Galaxy: public StellarPositionnedObject
 {
-	~Galaxy();
-	SolarSystemMap solar_systems;
+	SolarSystem *CreateSolarSystemObject(const uint32_t row);
+
+	SolarSystemTable solar_systems;
+	SolarSystemGrid spatial_index;
+
+	// Owns every SolarSystem, Planet and Moon object of this galaxy, they are all
+	// released with the galaxy
+	MonotonicArena arena;
 };
 typedef std::unordered_map<uint64_t, Galaxy *> GalaxyMap;
 
@@ -128,13 +252,14 @@ public:
 	~Universe();
 
 	bool SetGalaxy(Galaxy *galaxy);
-	Galaxy *CreateGalaxy(const uint64_t &max_solar_systems);
+	Galaxy *CreateGalaxy(const uint64_t &max_solar_systems, uint32_t worker_count = 1);
 	bool RemoveGalaxy(const uint64_t &id);
 	Galaxy *GetGalaxy(const uint64_t &id);
 
-	SolarSystem *CreateSolarSystem(Galaxy *galaxy);
-	void CreateSolarSystemPhase2(SolarSystem *ss);
+	SolarSystemHandle CreateSolarSystem(Galaxy *galaxy);
+	void CreateSolarSystemPhase2(Galaxy *galaxy, SolarSystem *ss);
 	bool RemoveSolarSystem(const uint64_t &id);
+	Galaxy *FindSolarSystem(const uint64_t &id, uint32_t &row);
 
 	void SetUniverseName(const std::string &name) {	m_name = name; }
 	const std::string GetUniverseName() const { return m_name; }
@@ -145,6 +270,10 @@ public:
 	void SetUniverseBirth(const uint32_t birth) { m_birth = birth; }
 	const uint32_t GetUniverseBirth() const { return m_birth; }
 
+	// Don't store solar system names, they are generated again when needed
+	void SetDerivedNames(const bool derived_names) { m_derived_names = derived_names; }
+	const bool HasDerivedNames() const { return m_derived_names; }
+
 	inline static Universe *instance()
 	{
 		if (!Universe::s_universe) {
@@ -154,7 +283,6 @@ public:
 		return Universe::s_universe;
 	}
 private:
-	SolarSystemMap m_solar_systems;
 	GalaxyMap m_galaxies;
 
 	uint64_t m_next_solarsystem_id = 1;
@@ -164,6 +292,10 @@ private:
 	std::string m_name;
 	uint64_t m_seed;
 	uint32_t m_birth;
+	bool m_derived_names = false;
+
+	void GenerateSolarSystem(SolarSystemTable &solar_systems, const uint32_t row,
+		std::string &name);
 
 	static Universe *s_universe;
 };
@@ -0,0 +1,380 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include "spatialindex.h"
+#include "space.h"
+#include "../jobsystem.h"
+
+namespace spacel {
+namespace engine {
+
+// Average number of solar systems per cell
+#define GRID_ENTRIES_PER_CELL 8
+#define GRID_MAX_DIM 512
+
+static const SpatialBox s_default_bounds = { -1.0, -1.0, -1.0, 1.0, 1.0, 1.0 };
+
+/*
+ * Size the grid to get cubic cells with GRID_ENTRIES_PER_CELL entries on average
+ */
+void SolarSystemGrid::InitGrid(const SpatialBox &bounds, const size_t expected_size)
+{
+	const double extent[3] = {
+		std::max(bounds.max_x - bounds.min_x, 1e-9),
+		std::max(bounds.max_y - bounds.min_y, 1e-9),
+		std::max(bounds.max_z - bounds.min_z, 1e-9),
+	};
+
+	const double cell_count = std::max<double>(expected_size / GRID_ENTRIES_PER_CELL, 1.0);
+	const double cell_size = std::cbrt(extent[0] * extent[1] * extent[2] / cell_count);
+
+	m_origin[0] = bounds.min_x;
+	m_origin[1] = bounds.min_y;
+	m_origin[2] = bounds.min_z;
+	for (uint8_t axis = 0; axis < 3; ++axis) {
+		m_dims[axis] = std::min<uint32_t>(std::max<double>(std::ceil(extent[axis] / cell_size),
+			1.0), GRID_MAX_DIM);
+		m_cell_size[axis] = extent[axis] / m_dims[axis];
+	}
+
+	m_cells.clear();
+	m_cells.resize(m_dims[0] * m_dims[1] * m_dims[2]);
+	m_size = 0;
+}
+
+const uint32_t SolarSystemGrid::CellCoord(const double v, const uint8_t axis) const
+{
+	const double c = std::floor((v - m_origin[axis]) / m_cell_size[axis]);
+	// NaN goes to the first cell, casting it is undefined
+	if (!(c > 0.0)) {
+		return 0;
+	}
+
+	return std::min<double>(c, m_dims[axis] - 1);
+}
+
+const SpatialBox SolarSystemGrid::CellBox(const uint32_t cx, const uint32_t cy,
+	const uint32_t cz) const
+{
+	// Border cells also hold clamped positions, they are unbounded outside of the grid
+	static const double inf = std::numeric_limits<double>::infinity();
+	return {
+		cx == 0 ? -inf : m_origin[0] + cx * m_cell_size[0],
+		cy == 0 ? -inf : m_origin[1] + cy * m_cell_size[1],
+		cz == 0 ? -inf : m_origin[2] + cz * m_cell_size[2],
+		cx == m_dims[0] - 1 ? inf : m_origin[0] + (cx + 1) * m_cell_size[0],
+		cy == m_dims[1] - 1 ? inf : m_origin[1] + (cy + 1) * m_cell_size[1],
+		cz == m_dims[2] - 1 ? inf : m_origin[2] + (cz + 1) * m_cell_size[2],
+	};
+}
+
+/*
+ * Rebuild the grid from the table. Cell indexes are computed in parallel, then entries are
+ * stored in reserved cells
+ */
+void SolarSystemGrid::Build(const SolarSystemTable &solar_systems, uint32_t worker_count)
+{
+	const uint32_t count = solar_systems.size();
+	const std::vector<double> &pos_x = solar_systems.GetPosX(),
+		&pos_y = solar_systems.GetPosY(), &pos_z = solar_systems.GetPosZ();
+
+	SpatialBox bounds = s_default_bounds;
+	if (count > 0) {
+		const auto x = std::minmax_element(pos_x.begin(), pos_x.end());
+		const auto y = std::minmax_element(pos_y.begin(), pos_y.end());
+		const auto z = std::minmax_element(pos_z.begin(), pos_z.end());
+		bounds = { *x.first, *y.first, *z.first, *x.second, *y.second, *z.second };
+	}
+
+	InitGrid(bounds, count);
+
+	JobSystem *jobs = JobSystem::instance();
+	if (worker_count == 0) {
+		worker_count = jobs->GetWorkerCount() + 1;
+	}
+
+	std::vector<uint32_t> cell_indexes(count);
+	jobs->ParallelFor(0, count, count / worker_count + 1, [&] (uint64_t begin, uint64_t end) {
+		for (uint64_t row = begin; row < end; ++row) {
+			cell_indexes[row] = PositionCellIndex(pos_x[row], pos_y[row], pos_z[row]);
+		}
+	});
+
+	std::vector<uint32_t> cell_sizes(m_cells.size(), 0);
+	for (const uint32_t cell: cell_indexes) {
+		cell_sizes[cell]++;
+	}
+
+	for (uint32_t cell = 0; cell < m_cells.size(); ++cell) {
+		m_cells[cell].reserve(cell_sizes[cell]);
+	}
+
+	const std::vector<uint64_t> &ids = solar_systems.GetIds();
+	for (uint32_t row = 0; row < count; ++row) {
+		m_cells[cell_indexes[row]].push_back({ ids[row], pos_x[row], pos_y[row], pos_z[row] });
+	}
+
+	m_size = count;
+}
+
+void SolarSystemGrid::Insert(const uint64_t &id, const double x, const double y,
+	const double z)
+{
+	if (m_cells.empty()) {
+		InitGrid(s_default_bounds, 0);
+	}
+
+	m_cells[PositionCellIndex(x, y, z)].push_back({ id, x, y, z });
+	m_size++;
+}
+
+bool SolarSystemGrid::Remove(const uint64_t &id, const double x, const double y,
+	const double z)
+{
+	if (m_cells.empty()) {
+		return false;
+	}
+
+	std::vector<Entry> &cell = m_cells[PositionCellIndex(x, y, z)];
+	for (auto &entry: cell) {
+		if (entry.id == id) {
+			entry = cell.back();
+			cell.pop_back();
+			m_size--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void SolarSystemGrid::Clear()
+{
+	m_cells.clear();
+	m_dims[0] = m_dims[1] = m_dims[2] = 0;
+	m_size = 0;
+}
+
+void SolarSystemGrid::QueryRadius(const double x, const double y, const double z,
+	const double radius, std::vector<uint64_t> &result) const
+{
+	if (m_cells.empty()) {
+		return;
+	}
+
+	const double radius_sq = radius * radius;
+	const uint32_t min_c[3] = { CellCoord(x - radius, 0), CellCoord(y - radius, 1),
+		CellCoord(z - radius, 2) };
+	const uint32_t max_c[3] = { CellCoord(x + radius, 0), CellCoord(y + radius, 1),
+		CellCoord(z + radius, 2) };
+
+	for (uint32_t cz = min_c[2]; cz <= max_c[2]; ++cz) {
+		for (uint32_t cy = min_c[1]; cy <= max_c[1]; ++cy) {
+			for (uint32_t cx = min_c[0]; cx <= max_c[0]; ++cx) {
+				for (const auto &entry: m_cells[CellIndex(cx, cy, cz)]) {
+					const double dx = entry.x - x, dy = entry.y - y, dz = entry.z - z;
+					if (dx * dx + dy * dy + dz * dz <= radius_sq) {
+						result.push_back(entry.id);
+					}
+				}
+			}
+		}
+	}
+}
+
+void SolarSystemGrid::QueryBox(const SpatialBox &box, std::vector<uint64_t> &result) const
+{
+	if (m_cells.empty()) {
+		return;
+	}
+
+	const uint32_t min_c[3] = { CellCoord(box.min_x, 0), CellCoord(box.min_y, 1),
+		CellCoord(box.min_z, 2) };
+	const uint32_t max_c[3] = { CellCoord(box.max_x, 0), CellCoord(box.max_y, 1),
+		CellCoord(box.max_z, 2) };
+
+	for (uint32_t cz = min_c[2]; cz <= max_c[2]; ++cz) {
+		for (uint32_t cy = min_c[1]; cy <= max_c[1]; ++cy) {
+			for (uint32_t cx = min_c[0]; cx <= max_c[0]; ++cx) {
+				for (const auto &entry: m_cells[CellIndex(cx, cy, cz)]) {
+					if (entry.x >= box.min_x && entry.x <= box.max_x &&
+						entry.y >= box.min_y && entry.y <= box.max_y &&
+						entry.z >= box.min_z && entry.z <= box.max_z) {
+						result.push_back(entry.id);
+					}
+				}
+			}
+		}
+	}
+}
+
+static inline double plane_distance(const SpatialPlane &p, const double x, const double y,
+	const double z)
+{
+	return p.a * x + p.b * y + p.c * z + p.d;
+}
+
+/*
+ * Cells fully outside of a plane are skipped, cells fully inside of every plane are added
+ * without testing their entries
+ */
+void SolarSystemGrid::QueryFrustum(const SpatialFrustum &frustum,
+	std::vector<uint64_t> &result) const
+{
+	for (uint32_t cz = 0; cz < m_dims[2]; ++cz) {
+		for (uint32_t cy = 0; cy < m_dims[1]; ++cy) {
+			for (uint32_t cx = 0; cx < m_dims[0]; ++cx) {
+				const std::vector<Entry> &cell = m_cells[CellIndex(cx, cy, cz)];
+				if (cell.empty()) {
+					continue;
+				}
+
+				const SpatialBox box = CellBox(cx, cy, cz);
+				bool outside = false, inside = true;
+				for (const auto &plane: frustum.planes) {
+					// Farthest and nearest corners along the plane normal
+					const double p_dist = plane_distance(plane,
+						plane.a >= 0 ? box.max_x : box.min_x,
+						plane.b >= 0 ? box.max_y : box.min_y,
+						plane.c >= 0 ? box.max_z : box.min_z);
+					const double n_dist = plane_distance(plane,
+						plane.a >= 0 ? box.min_x : box.max_x,
+						plane.b >= 0 ? box.min_y : box.max_y,
+						plane.c >= 0 ? box.min_z : box.max_z);
+					if (p_dist < 0) {
+						outside = true;
+						break;
+					}
+
+					// Unbounded border cells give NaN or infinite distances
+					if (!(n_dist >= 0) || std::isinf(n_dist)) {
+						inside = false;
+					}
+				}
+
+				if (outside) {
+					continue;
+				}
+
+				for (const auto &entry: cell) {
+					bool entry_inside = true;
+					for (uint8_t i = 0; i < 6 && !inside && entry_inside; ++i) {
+						entry_inside = plane_distance(frustum.planes[i], entry.x, entry.y,
+							entry.z) >= 0;
+					}
+
+					if (entry_inside) {
+						result.push_back(entry.id);
+					}
+				}
+			}
+		}
+	}
+}
+
+/*
+ * Visit cells ring by ring around the point until the kth nearest entry is nearer than any
+ * cell which was not visited
+ */
+void SolarSystemGrid::QueryNearest(const double x, const double y, const double z,
+	const uint32_t k, std::vector<uint64_t> &result) const
+{
+	if (m_cells.empty() || k == 0) {
+		return;
+	}
+
+	typedef std::pair<double, uint64_t> Candidate;
+	// Max heap, the farthest candidate is on top
+	std::priority_queue<Candidate> candidates;
+
+	const int32_t center[3] = { (int32_t) CellCoord(x, 0), (int32_t) CellCoord(y, 1),
+		(int32_t) CellCoord(z, 2) };
+	const double pos[3] = { x, y, z };
+	const int32_t max_ring = std::max(std::max(m_dims[0], m_dims[1]), m_dims[2]);
+
+	for (int32_t ring = 0; ring <= max_ring; ++ring) {
+		int32_t min_c[3], max_c[3];
+		for (uint8_t axis = 0; axis < 3; ++axis) {
+			min_c[axis] = std::max(center[axis] - ring, 0);
+			max_c[axis] = std::min(center[axis] + ring, (int32_t) m_dims[axis] - 1);
+		}
+
+		for (int32_t cz = min_c[2]; cz <= max_c[2]; ++cz) {
+			for (int32_t cy = min_c[1]; cy <= max_c[1]; ++cy) {
+				for (int32_t cx = min_c[0]; cx <= max_c[0]; ++cx) {
+					// Inner cells were visited by previous rings
+					if (std::abs(cx - center[0]) < ring && std::abs(cy - center[1]) < ring &&
+						std::abs(cz - center[2]) < ring) {
+						continue;
+					}
+
+					for (const auto &entry: m_cells[CellIndex(cx, cy, cz)]) {
+						const double dx = entry.x - x, dy = entry.y - y, dz = entry.z - z;
+						const double dist_sq = dx * dx + dy * dy + dz * dz;
+						if (candidates.size() < k) {
+							candidates.emplace(dist_sq, entry.id);
+						}
+						else if (dist_sq < candidates.top().first) {
+							candidates.pop();
+							candidates.emplace(dist_sq, entry.id);
+						}
+					}
+				}
+			}
+		}
+
+		if (candidates.size() < k) {
+			continue;
+		}
+
+		// Distance from the point to the nearest cell outside of the visited block
+		double outside_dist = std::numeric_limits<double>::infinity();
+		for (uint8_t axis = 0; axis < 3; ++axis) {
+			if (min_c[axis] > 0) {
+				outside_dist = std::min(outside_dist,
+					pos[axis] - (m_origin[axis] + min_c[axis] * m_cell_size[axis]));
+			}
+
+			if (max_c[axis] < (int32_t) m_dims[axis] - 1) {
+				outside_dist = std::min(outside_dist,
+					m_origin[axis] + (max_c[axis] + 1) * m_cell_size[axis] - pos[axis]);
+			}
+		}
+
+		if (outside_dist == std::numeric_limits<double>::infinity() ||
+			(outside_dist >= 0 && candidates.top().first <= outside_dist * outside_dist)) {
+			break;
+		}
+	}
+
+	const size_t offset = result.size();
+	result.resize(offset + candidates.size());
+	for (size_t i = result.size(); i > offset; --i) {
+		result[i - 1] = candidates.top().second;
+		candidates.pop();
+	}
+}
+
+}
+}
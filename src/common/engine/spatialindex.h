@@ -0,0 +1,102 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace spacel {
+namespace engine {
+
+class SolarSystemTable;
+
+struct SpatialBox
+{
+	double min_x, min_y, min_z;
+	double max_x, max_y, max_z;
+};
+
+// Points with a * x + b * y + c * z + d >= 0 are inside the plane
+struct SpatialPlane
+{
+	double a, b, c, d;
+};
+
+struct SpatialFrustum
+{
+	SpatialPlane planes[6];
+};
+
+/*
+ * Uniform grid over solar system positions. Cells are sized from the galaxy bounds at build
+ * time, positions inserted outside the bounds are stored in the border cells.
+ * Queries return solar system ids
+ */
+class SolarSystemGrid
+{
+public:
+	SolarSystemGrid() {}
+
+	void Build(const SolarSystemTable &solar_systems, uint32_t worker_count = 1);
+	void Insert(const uint64_t &id, const double x, const double y, const double z);
+	bool Remove(const uint64_t &id, const double x, const double y, const double z);
+	void Clear();
+
+	const size_t size() const { return m_size; }
+	const bool empty() const { return m_size == 0; }
+
+	void QueryRadius(const double x, const double y, const double z, const double radius,
+		std::vector<uint64_t> &result) const;
+	void QueryBox(const SpatialBox &box, std::vector<uint64_t> &result) const;
+	void QueryFrustum(const SpatialFrustum &frustum, std::vector<uint64_t> &result) const;
+	// Results are sorted from the nearest to the farthest
+	void QueryNearest(const double x, const double y, const double z, const uint32_t k,
+		std::vector<uint64_t> &result) const;
+
+private:
+	struct Entry
+	{
+		uint64_t id;
+		double x, y, z;
+	};
+
+	void InitGrid(const SpatialBox &bounds, const size_t expected_size);
+	const uint32_t CellCoord(const double v, const uint8_t axis) const;
+	const uint32_t PositionCellIndex(const double x, const double y, const double z) const
+	{
+		return CellIndex(CellCoord(x, 0), CellCoord(y, 1), CellCoord(z, 2));
+	}
+	const uint32_t CellIndex(const uint32_t cx, const uint32_t cy, const uint32_t cz) const
+	{
+		return (cz * m_dims[1] + cy) * m_dims[0] + cx;
+	}
+
+	const SpatialBox CellBox(const uint32_t cx, const uint32_t cy, const uint32_t cz) const;
+
+	std::vector<std::vector<Entry>> m_cells;
+	double m_origin[3] = { 0.0, 0.0, 0.0 };
+	double m_cell_size[3] = { 1.0, 1.0, 1.0 };
+	uint32_t m_dims[3] = { 0, 0, 0 };
+	size_t m_size = 0;
+};
+
+}
+}
@@ -0,0 +1,114 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "histogram.h"
+#include <algorithm>
+
+namespace spacel {
+
+Histogram::Histogram():
+	m_buckets(new std::atomic<uint64_t>[HISTOGRAM_BUCKETS])
+{
+	Reset();
+}
+
+const uint32_t Histogram::GetBucketIndex(const uint64_t value)
+{
+	if (value < HISTOGRAM_SUB_BUCKETS) {
+		return (uint32_t) value;
+	}
+
+	// Power of two of the value, then its next bits below the leading one
+	const uint32_t exponent = 63 - __builtin_clzll(value);
+	const uint32_t shift = exponent - HISTOGRAM_SUB_BUCKET_BITS;
+	return HISTOGRAM_SUB_BUCKETS * (shift + 1) +
+		(uint32_t) ((value >> shift) & (HISTOGRAM_SUB_BUCKETS - 1));
+}
+
+const uint64_t Histogram::GetBucketHighestValue(const uint32_t index)
+{
+	if (index < HISTOGRAM_SUB_BUCKETS) {
+		return index;
+	}
+
+	const uint32_t shift = index / HISTOGRAM_SUB_BUCKETS - 1;
+	const uint64_t lowest = (uint64_t) (HISTOGRAM_SUB_BUCKETS + index % HISTOGRAM_SUB_BUCKETS)
+		<< shift;
+	return lowest + ((1ULL << shift) - 1);
+}
+
+void Histogram::Record(const uint64_t value)
+{
+	m_buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+	m_count.fetch_add(1, std::memory_order_relaxed);
+	m_total.fetch_add(value, std::memory_order_relaxed);
+
+	uint64_t current = m_min.load(std::memory_order_relaxed);
+	while (value < current && !m_min.compare_exchange_weak(current, value,
+		std::memory_order_relaxed)) {
+	}
+
+	current = m_max.load(std::memory_order_relaxed);
+	while (value > current && !m_max.compare_exchange_weak(current, value,
+		std::memory_order_relaxed)) {
+	}
+}
+
+void Histogram::Reset()
+{
+	for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		m_buckets[i].store(0, std::memory_order_relaxed);
+	}
+	m_count = 0;
+	m_total = 0;
+	m_min = UINT64_MAX;
+	m_max = 0;
+}
+
+const uint64_t Histogram::GetMin() const
+{
+	return GetCount() ? m_min.load(std::memory_order_relaxed) : 0;
+}
+
+const double Histogram::GetMean() const
+{
+	const uint64_t count = GetCount();
+	return count ? (double) GetTotal() / count : 0.0;
+}
+
+const uint64_t Histogram::GetPercentile(const double percentile) const
+{
+	const uint64_t count = GetCount();
+	if (count == 0) {
+		return 0;
+	}
+
+	const uint64_t rank = std::max<uint64_t>(1,
+		(uint64_t) (count * std::min(percentile, 100.0) / 100.0 + 0.5));
+	uint64_t seen = 0;
+	for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		seen += m_buckets[i].load(std::memory_order_relaxed);
+		if (seen >= rank) {
+			return std::min(GetBucketHighestValue(i), GetMax());
+		}
+	}
+	return GetMax();
+}
+
+}
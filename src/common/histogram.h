@@ -0,0 +1,68 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace spacel {
+
+// Linear sub buckets per power of two, values are kept with a 1/32 relative precision
+#define HISTOGRAM_SUB_BUCKET_BITS 5
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_BUCKETS (HISTOGRAM_SUB_BUCKETS * (64 - HISTOGRAM_SUB_BUCKET_BITS + 1))
+
+/*
+ * HDR style histogram of 64 bits values: values below 64 are exact, larger values share
+ * their bucket with values at most 1/32 apart. Recording is lock-free and the histogram
+ * can be read from any thread while recording, reads are not a consistent snapshot
+ */
+class Histogram
+{
+public:
+	Histogram();
+	~Histogram() {}
+
+	void Record(const uint64_t value);
+	void Reset();
+
+	const uint64_t GetCount() const { return m_count.load(std::memory_order_relaxed); }
+	const uint64_t GetTotal() const { return m_total.load(std::memory_order_relaxed); }
+	const uint64_t GetMin() const;
+	const uint64_t GetMax() const { return m_max.load(std::memory_order_relaxed); }
+	const double GetMean() const;
+
+	// Highest value equivalent to the given percentile, in [0, 100]
+	const uint64_t GetPercentile(const double percentile) const;
+
+	static const uint32_t GetBucketIndex(const uint64_t value);
+	// Highest value stored in the bucket
+	static const uint64_t GetBucketHighestValue(const uint32_t index);
+
+private:
+	std::unique_ptr<std::atomic<uint64_t>[]> m_buckets;
+	std::atomic<uint64_t> m_count{0};
+	std::atomic<uint64_t> m_total{0};
+	std::atomic<uint64_t> m_min{UINT64_MAX};
+	std::atomic<uint64_t> m_max{0};
+};
+
+}
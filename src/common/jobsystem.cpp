@@ -0,0 +1,232 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jobsystem.h"
+#include <algorithm>
+#include <cassert>
+
+namespace spacel {
+
+// Worker running on this thread, jobs it submits go to its own queue
+static thread_local const JobSystem *s_worker_system = nullptr;
+static thread_local uint32_t s_worker_index = 0;
+
+JobSystem::JobSystem(uint32_t worker_count)
+{
+	if (worker_count == 0) {
+		worker_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	}
+
+	for (uint32_t i = 0; i < worker_count; i++) {
+		m_queues.emplace_back(new WorkerQueue());
+	}
+
+	for (uint32_t i = 0; i < worker_count; i++) {
+		m_workers.emplace_back(&JobSystem::WorkerFunction, this, i);
+	}
+}
+
+JobSystem *JobSystem::instance()
+{
+	static JobSystem jobs;
+	return &jobs;
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sleep_mutex);
+		m_running = false;
+	}
+	m_sleep_cv.notify_all();
+
+	for (auto &worker: m_workers) {
+		worker.join();
+	}
+}
+
+void JobSystem::Submit(const Job &job, JobCounter *counter)
+{
+	if (counter) {
+		counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	const uint32_t index = s_worker_system == this ? s_worker_index :
+		m_next_queue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+	{
+		std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+		m_queues[index]->jobs.push_back({ job, counter });
+	}
+
+	m_queued_count.fetch_add(1, std::memory_order_release);
+	{
+		// Workers check the queued count with this lock held before sleeping
+		std::lock_guard<std::mutex> lock(m_sleep_mutex);
+	}
+	m_sleep_cv.notify_one();
+}
+
+bool JobSystem::PopJob(const uint32_t index, QueuedJob &job)
+{
+	if (m_queued_count.load(std::memory_order_acquire) == 0) {
+		return false;
+	}
+
+	{
+		WorkerQueue &queue = *m_queues[index];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty()) {
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+			m_queued_count.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	for (uint32_t i = 1; i < m_queues.size(); i++) {
+		WorkerQueue &queue = *m_queues[(index + i) % m_queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty()) {
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+			m_queued_count.fetch_sub(1, std::memory_order_relaxed);
+			m_stolen_count.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::Execute(QueuedJob &job)
+{
+	job.job();
+	// Release the captured state now, the slot is reused for the next job
+	job.job = nullptr;
+	m_executed_count.fetch_add(1, std::memory_order_relaxed);
+	if (job.counter) {
+		job.counter->m_pending.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+void JobSystem::WorkerFunction(const uint32_t index)
+{
+	s_worker_system = this;
+	s_worker_index = index;
+
+	QueuedJob job;
+	while (true) {
+		if (PopJob(index, job)) {
+			Execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleep_mutex);
+		m_sleep_cv.wait(lock, [this] {
+			return !m_running || m_queued_count.load(std::memory_order_acquire) > 0;
+		});
+
+		if (!m_running) {
+			return;
+		}
+	}
+}
+
+void JobSystem::Wait(JobCounter &counter)
+{
+	const uint32_t index = s_worker_system == this ? s_worker_index :
+		m_next_queue.load(std::memory_order_relaxed) % m_queues.size();
+
+	QueuedJob job;
+	while (!counter.IsDone()) {
+		if (PopJob(index, job)) {
+			Execute(job);
+		} else {
+			// Remaining jobs are running on other threads
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::ParallelFor(const uint64_t begin, const uint64_t end, const uint64_t grain,
+	const std::function<void(uint64_t, uint64_t)> &fn)
+{
+	const uint64_t step = std::max<uint64_t>(grain, 1);
+	if (end <= begin) {
+		return;
+	}
+
+	// The calling thread takes the last range and helps with the others while waiting
+	JobCounter counter;
+	uint64_t range_begin = begin;
+	for (; end - range_begin > step; range_begin += step) {
+		const uint64_t range_end = range_begin + step;
+		Submit([&fn, range_begin, range_end] { fn(range_begin, range_end); }, &counter);
+	}
+
+	fn(range_begin, end);
+	Wait(counter);
+}
+
+TaskGraph::TaskId TaskGraph::AddTask(const Job &job, const std::vector<TaskId> &dependencies)
+{
+	const TaskId id = (TaskId) m_tasks.size();
+	m_tasks.emplace_back(new Task());
+	m_tasks.back()->job = job;
+	for (const TaskId &dependency: dependencies) {
+		assert(dependency < id);
+		m_tasks[dependency]->dependents.push_back(id);
+	}
+	m_tasks.back()->pending_dependencies = (uint32_t) dependencies.size();
+	return id;
+}
+
+void TaskGraph::SubmitTask(JobSystem &jobs, const TaskId id, JobCounter &counter)
+{
+	jobs.Submit([this, &jobs, id, &counter] {
+		Task &task = *m_tasks[id];
+		task.job();
+		// Dependents are submitted before this job is counted as done, Run can't return early
+		for (const TaskId &dependent: task.dependents) {
+			if (m_tasks[dependent]->pending_dependencies.fetch_sub(1,
+				std::memory_order_acq_rel) == 1) {
+				SubmitTask(jobs, dependent, counter);
+			}
+		}
+	}, &counter);
+}
+
+void TaskGraph::Run(JobSystem &jobs)
+{
+	// Collect the roots first, dependents reach 0 pending dependencies while we submit
+	std::vector<TaskId> roots;
+	for (TaskId id = 0; id < m_tasks.size(); id++) {
+		if (m_tasks[id]->pending_dependencies.load(std::memory_order_relaxed) == 0) {
+			roots.push_back(id);
+		}
+	}
+
+	JobCounter counter;
+	for (const TaskId &id: roots) {
+		SubmitTask(jobs, id, counter);
+	}
+	jobs.Wait(counter);
+}
+
+}
@@ -0,0 +1,194 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "threadsafe_utils.h"
+
+namespace spacel {
+
+typedef std::function<void()> Job;
+
+/*
+ * Number of unfinished jobs of a group, see JobSystem::Wait
+ */
+class JobCounter
+{
+public:
+	JobCounter() {}
+	const bool IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class JobSystem;
+	std::atomic<uint32_t> m_pending{0};
+};
+
+/*
+ * Fixed pool of worker threads, each one owning a job deque. Workers run their newest jobs
+ * first and steal the oldest jobs of other workers when they are out of work. Jobs can be
+ * submitted from any thread, including from jobs
+ */
+class JobSystem
+{
+public:
+	// 0 workers means one per hardware thread, minus the thread submitting jobs
+	JobSystem(uint32_t worker_count = 0);
+	~JobSystem();
+
+	// Shared by the server, the client and the generators
+	static JobSystem *instance();
+
+	void Submit(const Job &job, JobCounter *counter = nullptr);
+
+	/*
+	 * Run jobs until every job of counter is finished. The calling thread helps, waiting
+	 * from a job doesn't block a worker
+	 */
+	void Wait(JobCounter &counter);
+
+	/*
+	 * Call fn on consecutive sub ranges of [begin, end) of at most grain items, in parallel.
+	 * Returns once every sub range is done
+	 */
+	void ParallelFor(const uint64_t begin, const uint64_t end, const uint64_t grain,
+		const std::function<void(uint64_t, uint64_t)> &fn);
+
+	// Run fn on a worker, the result is read from the future
+	template <typename Fn>
+	std::future<typename std::result_of<Fn()>::type> Async(Fn fn)
+	{
+		typedef typename std::result_of<Fn()>::type Result;
+		std::shared_ptr<std::packaged_task<Result()>> task(
+			new std::packaged_task<Result()>(std::move(fn)));
+		std::future<Result> future = task->get_future();
+		Submit([task] { (*task)(); });
+		return future;
+	}
+
+	const uint32_t GetWorkerCount() const { return m_workers.size(); }
+	const uint64_t GetExecutedCount() const { return m_executed_count; }
+	const uint64_t GetStolenCount() const { return m_stolen_count; }
+
+private:
+	struct QueuedJob
+	{
+		Job job;
+		JobCounter *counter;
+	};
+
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<QueuedJob> jobs;
+	};
+
+	void WorkerFunction(const uint32_t index);
+	// Pop from the queue of index, or steal from the others
+	bool PopJob(const uint32_t index, QueuedJob &job);
+	void Execute(QueuedJob &job);
+
+	std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+	std::vector<std::thread> m_workers;
+	std::atomic<bool> m_running{true};
+
+	// Queued jobs, idle workers sleep while it is 0
+	std::atomic<uint32_t> m_queued_count{0};
+	std::mutex m_sleep_mutex;
+	std::condition_variable m_sleep_cv;
+
+	// Queue receiving the next job submitted from outside the workers
+	std::atomic<uint32_t> m_next_queue{0};
+	std::atomic<uint64_t> m_executed_count{0};
+	std::atomic<uint64_t> m_stolen_count{0};
+};
+
+/*
+ * Callbacks posted from any thread, run by the thread owning the queue. The UI thread gets
+ * job results this way
+ */
+class CallbackQueue
+{
+public:
+	void Post(const Job &callback) { m_callbacks.push_back(callback); }
+
+	// Run the callbacks posted until now, returns the number of run callbacks
+	size_t RunPending()
+	{
+		size_t count = m_callbacks.size();
+		for (size_t i = 0; i < count; i++) {
+			m_callbacks.pop_front()();
+		}
+		return count;
+	}
+
+private:
+	SafeQueue<Job> m_callbacks;
+};
+
+/*
+ * Run fn on a worker, then callback with its result on the thread owning queue
+ */
+template <typename Fn, typename Callback>
+void async_then(JobSystem &jobs, Fn fn, CallbackQueue &queue, Callback callback)
+{
+	jobs.Submit([fn, &queue, callback] {
+		auto result = fn();
+		queue.Post([result, callback] { callback(result); });
+	});
+}
+
+/*
+ * Jobs with dependencies, a job starts once every job it depends on is finished. Jobs are
+ * added before Run, a graph runs once
+ */
+class TaskGraph
+{
+public:
+	typedef uint32_t TaskId;
+
+	TaskId AddTask(const Job &job, const std::vector<TaskId> &dependencies = {});
+	const size_t size() const { return m_tasks.size(); }
+
+	// Returns once every task is finished, the calling thread helps
+	void Run(JobSystem &jobs);
+
+private:
+	struct Task
+	{
+		Job job;
+		std::vector<TaskId> dependents;
+		std::atomic<uint32_t> pending_dependencies{0};
+	};
+
+	void SubmitTask(JobSystem &jobs, const TaskId id, JobCounter &counter);
+
+	std::vector<std::unique_ptr<Task>> m_tasks;
+};
+
+}
@@ -0,0 +1,197 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "profiler.h"
+#include <algorithm>
+#include <iomanip>
+#include <json/json.h>
+
+namespace spacel {
+
+static std::atomic<uint32_t> s_next_thread_id(1);
+// Small ids are easier to read in traces than native thread ids
+static thread_local const uint32_t s_thread_id = s_next_thread_id.fetch_add(1);
+
+static_assert((PROFILER_EVENT_CAPACITY & (PROFILER_EVENT_CAPACITY - 1)) == 0,
+	"PROFILER_EVENT_CAPACITY must be a power of two");
+
+void ProfileStats::Add(const uint64_t value)
+{
+	count++;
+	total += value;
+	min = std::min(min, value);
+	max = std::max(max, value);
+
+	uint32_t bucket = 0;
+	while (bucket < PROFILER_HISTOGRAM_BUCKETS - 1 && (value >> (bucket + 1)) != 0) {
+		bucket++;
+	}
+	buckets[bucket]++;
+}
+
+const uint64_t ProfileStats::GetPercentile(const double percentile) const
+{
+	if (count == 0) {
+		return 0;
+	}
+
+	const uint64_t rank = std::max<uint64_t>(1, (uint64_t) (count * percentile / 100.0 + 0.5));
+	uint64_t seen = 0;
+	for (uint32_t bucket = 0; bucket < PROFILER_HISTOGRAM_BUCKETS; bucket++) {
+		seen += buckets[bucket];
+		if (seen >= rank) {
+			// The max is a tighter bound for the last bucket
+			return std::min<uint64_t>(max, (2ULL << bucket) - 1);
+		}
+	}
+	return max;
+}
+
+Profiler::Profiler():
+	m_events(new Event[PROFILER_EVENT_CAPACITY]),
+	m_origin(std::chrono::steady_clock::now())
+{
+}
+
+void Profiler::Record(const ProfileEventType type, const char *name, const uint64_t time,
+	const uint64_t value)
+{
+	if (!IsEnabled()) {
+		return;
+	}
+
+	const uint64_t index = m_next_event.fetch_add(1, std::memory_order_relaxed);
+	Event &event = m_events[index & (PROFILER_EVENT_CAPACITY - 1)];
+
+	// Readers skip the event until its sequence is set again
+	event.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	event.name.store(name, std::memory_order_relaxed);
+	event.time.store(time, std::memory_order_relaxed);
+	event.value.store(value, std::memory_order_relaxed);
+	event.thread.store(s_thread_id, std::memory_order_relaxed);
+	event.type.store((uint8_t) type, std::memory_order_relaxed);
+	event.sequence.store(index + 1, std::memory_order_release);
+}
+
+template <typename F>
+void Profiler::ForEachEvent(F callback) const
+{
+	const uint64_t end = m_next_event.load(std::memory_order_acquire);
+	const uint64_t begin = end > PROFILER_EVENT_CAPACITY ? end - PROFILER_EVENT_CAPACITY : 0;
+	for (uint64_t index = begin; index < end; index++) {
+		const Event &event = m_events[index & (PROFILER_EVENT_CAPACITY - 1)];
+		if (event.sequence.load(std::memory_order_acquire) != index + 1) {
+			// Being written or already overwritten
+			continue;
+		}
+
+		EventSnapshot snapshot;
+		snapshot.name = event.name.load(std::memory_order_relaxed);
+		snapshot.time = event.time.load(std::memory_order_relaxed);
+		snapshot.value = event.value.load(std::memory_order_relaxed);
+		snapshot.thread = event.thread.load(std::memory_order_relaxed);
+		snapshot.type = (ProfileEventType) event.type.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (event.sequence.load(std::memory_order_relaxed) != index + 1) {
+			continue;
+		}
+
+		callback(snapshot);
+	}
+}
+
+std::map<std::string, ProfileStats> Profiler::GetStats() const
+{
+	std::map<std::string, ProfileStats> stats;
+	ForEachEvent([&stats] (const EventSnapshot &event) {
+		ProfileStats &event_stats = stats[event.name];
+		event_stats.type = event.type;
+		event_stats.Add(event.value);
+	});
+	return stats;
+}
+
+void Profiler::WriteChromeTrace(std::ostream &os) const
+{
+	Json::Value events(Json::arrayValue);
+	ForEachEvent([&events] (const EventSnapshot &event) {
+		Json::Value trace_event;
+		trace_event["name"] = event.name;
+		trace_event["pid"] = 1;
+		trace_event["tid"] = event.thread;
+		// Trace timestamps are in microseconds
+		trace_event["ts"] = event.time / 1000.0;
+		if (event.type == PROFILE_EVENT_SCOPE) {
+			trace_event["ph"] = "X";
+			trace_event["dur"] = event.value / 1000.0;
+		}
+		else {
+			trace_event["ph"] = "C";
+			trace_event["args"]["value"] = (Json::UInt64) event.value;
+		}
+		events.append(trace_event);
+	});
+
+	Json::Value root;
+	root["traceEvents"] = events;
+	root["displayTimeUnit"] = "ms";
+
+	Json::StreamWriterBuilder builder;
+	builder["indentation"] = "";
+	std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+	writer->write(root, &os);
+}
+
+void Profiler::WriteStats(std::ostream &os) const
+{
+	const std::map<std::string, ProfileStats> stats = GetStats();
+	os << std::left << std::setw(32) << "scope" << std::right << std::setw(10) << "count"
+		<< std::setw(12) << "avg us" << std::setw(12) << "p50 us" << std::setw(12)
+		<< "p99 us" << std::setw(12) << "max us" << std::endl;
+	os << std::fixed << std::setprecision(1);
+	for (const auto &event_stats: stats) {
+		const ProfileStats &s = event_stats.second;
+		if (s.type != PROFILE_EVENT_SCOPE) {
+			continue;
+		}
+
+		os << std::left << std::setw(32) << event_stats.first << std::right
+			<< std::setw(10) << s.count << std::setw(12) << s.total / 1000.0 / s.count
+			<< std::setw(12) << s.GetPercentile(50) / 1000.0 << std::setw(12)
+			<< s.GetPercentile(99) / 1000.0 << std::setw(12) << s.max / 1000.0 << std::endl;
+	}
+
+	os << std::left << std::setw(32) << "counter" << std::right << std::setw(10) << "samples"
+		<< std::setw(12) << "avg" << std::setw(12) << "p50" << std::setw(12) << "p99"
+		<< std::setw(12) << "max" << std::endl;
+	for (const auto &event_stats: stats) {
+		const ProfileStats &s = event_stats.second;
+		if (s.type != PROFILE_EVENT_COUNTER) {
+			continue;
+		}
+
+		os << std::left << std::setw(32) << event_stats.first << std::right
+			<< std::setw(10) << s.count << std::setw(12) << (double) s.total / s.count
+			<< std::setw(12) << s.GetPercentile(50) << std::setw(12) << s.GetPercentile(99)
+			<< std::setw(12) << s.max << std::endl;
+	}
+}
+
+}
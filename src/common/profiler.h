@@ -0,0 +1,157 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace spacel {
+
+// Events kept by a profiler, older ones are overwritten. Must be a power of two
+#define PROFILER_EVENT_CAPACITY 65536
+// Bucket n of the histograms holds the values in [2^n, 2^(n+1))
+#define PROFILER_HISTOGRAM_BUCKETS 48
+
+enum ProfileEventType
+{
+	PROFILE_EVENT_SCOPE,
+	PROFILE_EVENT_COUNTER,
+};
+
+/*
+ * Aggregated values of the events sharing a name, durations in nanoseconds for scopes
+ */
+struct ProfileStats
+{
+	ProfileEventType type = PROFILE_EVENT_SCOPE;
+	uint64_t count = 0;
+	uint64_t total = 0;
+	uint64_t min = UINT64_MAX;
+	uint64_t max = 0;
+	uint64_t buckets[PROFILER_HISTOGRAM_BUCKETS] = {};
+
+	void Add(const uint64_t value);
+	// Upper bound of the bucket holding the given percentile, in [0, 100]
+	const uint64_t GetPercentile(const double percentile) const;
+};
+
+/*
+ * Scope durations and counter samples of a loop, recorded in a lock-free ring buffer.
+ * Events can be recorded from any thread and dumped at any time, events overwritten
+ * while dumping are skipped. Event names must outlive the profiler, use string literals
+ * or handler table names
+ */
+class Profiler
+{
+public:
+	Profiler();
+	~Profiler() {}
+
+	void SetEnabled(const bool enabled) { m_enabled = enabled; }
+	const bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+	// Nanoseconds since the profiler creation
+	const uint64_t GetTime() const
+	{
+		return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - m_origin).count();
+	}
+
+	void RecordScope(const char *name, const uint64_t start, const uint64_t end)
+	{
+		Record(PROFILE_EVENT_SCOPE, name, start, end - start);
+	}
+
+	void RecordCounter(const char *name, const uint64_t value)
+	{
+		Record(PROFILE_EVENT_COUNTER, name, GetTime(), value);
+	}
+
+	const uint64_t GetRecordedCount() const { return m_next_event.load(); }
+
+	// Aggregate the events still in the ring buffer by name
+	std::map<std::string, ProfileStats> GetStats() const;
+
+	// Chrome trace event format, load it in chrome://tracing
+	void WriteChromeTrace(std::ostream &os) const;
+	void WriteStats(std::ostream &os) const;
+
+private:
+	struct Event
+	{
+		// Event index + 1 once written, 0 while writing
+		std::atomic<uint64_t> sequence{0};
+		std::atomic<const char *> name{nullptr};
+		std::atomic<uint64_t> time{0};
+		std::atomic<uint64_t> value{0};
+		std::atomic<uint32_t> thread{0};
+		std::atomic<uint8_t> type{0};
+	};
+
+	struct EventSnapshot
+	{
+		const char *name;
+		uint64_t time;
+		uint64_t value;
+		uint32_t thread;
+		ProfileEventType type;
+	};
+
+	void Record(const ProfileEventType type, const char *name, const uint64_t time,
+		const uint64_t value);
+	template <typename F>
+	void ForEachEvent(F callback) const;
+
+	std::unique_ptr<Event[]> m_events;
+	std::atomic<uint64_t> m_next_event{0};
+	std::atomic<bool> m_enabled{true};
+	const std::chrono::steady_clock::time_point m_origin;
+};
+
+/*
+ * Record the duration of the enclosing scope
+ */
+class ProfileScope
+{
+public:
+	ProfileScope(Profiler &profiler, const char *name):
+		m_profiler(profiler), m_name(name), m_start(profiler.GetTime())
+	{
+	}
+
+	~ProfileScope() { m_profiler.RecordScope(m_name, m_start, m_profiler.GetTime()); }
+
+private:
+	Profiler &m_profiler;
+	const char *m_name;
+	const uint64_t m_start;
+};
+
+#define PROFILE_SCOPE_NAME_(line) profile_scope_##line
+#define PROFILE_SCOPE_NAME(line) PROFILE_SCOPE_NAME_(line)
+#define PROFILE_SCOPE(profiler, name) \
+	ProfileScope PROFILE_SCOPE_NAME(__LINE__)((profiler), (name))
+
+}
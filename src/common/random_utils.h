@@ -0,0 +1,140 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+namespace spacel {
+
+/*
+ * SplitMix64 mixing function, bijective on 64 bits with a good avalanche
+ */
+inline static uint64_t splitmix64(uint64_t x)
+{
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+/*
+ * Stateless counter based random number: the nth value of stream (seed, object id, attribute)
+ * is a pure function of its inputs, it costs a few multiplications and can be computed in any
+ * order, from any thread
+ */
+inline static uint64_t counter_random(const uint64_t seed, const uint64_t object_id,
+		const uint32_t attribute, const uint32_t n)
+{
+	const uint64_t key = splitmix64(splitmix64(seed ^ ((uint64_t) attribute << 48)) ^ object_id);
+	return splitmix64(key + (uint64_t) n * 0xD1B54A32D192ED03ULL);
+}
+
+/*
+ * Draw sequence over a counter_random stream, with distributions matching the
+ * MT19937Random interface
+ */
+class CounterRandom
+{
+public:
+	CounterRandom(const uint64_t seed, const uint64_t object_id, const uint32_t attribute):
+		m_seed(seed), m_object_id(object_id), m_attribute(attribute) {}
+
+	inline uint64_t next() { return counter_random(m_seed, m_object_id, m_attribute, m_n++); }
+
+	// [0, 1) with 53 bits of precision
+	inline double unit() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+	// [min, max)
+	template <typename T>
+	inline T uniform_real(const T min, const T max)
+	{
+		return (T) (min + (max - min) * unit());
+	}
+
+	// [min, max]
+	template <typename T>
+	inline T uniform_int(const T min, const T max)
+	{
+		const uint64_t range = (uint64_t) max - (uint64_t) min + 1;
+		return (T) (min + (uint64_t) (unit() * range));
+	}
+
+	template <typename T>
+	inline T normal(const T mean, const T stddev = 1)
+	{
+		// Box-Muller, 1 - unit() is in (0, 1] then the log is defined
+		const double u1 = 1.0 - unit(), u2 = unit();
+		return (T) (mean + stddev * std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2));
+	}
+
+private:
+	uint64_t m_seed;
+	uint64_t m_object_id;
+	uint32_t m_attribute;
+	uint32_t m_n = 0;
+};
+
+/*
+ * std::mt19937 with standard distributions, this reproduces values generated before
+ * CounterRandom was introduced
+ */
+class MT19937Random
+{
+public:
+	MT19937Random() {}
+	MT19937Random(const uint64_t seed): m_generator(seed) {}
+	/*
+	 * Independent stream of a seed. std::mt19937 only keeps the 32 low bits of an integer
+	 * seed, the seed sequence mixes the whole seed with the stream id
+	 */
+	MT19937Random(const uint64_t seed, const uint32_t stream)
+	{
+		std::seed_seq sequence{ (uint32_t) seed, (uint32_t) (seed >> 32), stream };
+		m_generator.seed(sequence);
+	}
+
+	template <typename T>
+	inline T uniform_real(const T min, const T max)
+	{
+		std::uniform_real_distribution<T> rnd(min, max);
+		return rnd(m_generator);
+	}
+
+	template <typename T>
+	inline T uniform_int(const T min, const T max)
+	{
+		std::uniform_int_distribution<T> rnd(min, max);
+		return rnd(m_generator);
+	}
+
+	template <typename T>
+	inline T normal(const T mean, const T stddev = 1)
+	{
+		std::normal_distribution<T> rnd(mean, stddev);
+		return rnd(m_generator);
+	}
+
+private:
+	std::mt19937 m_generator;
+};
+
+}
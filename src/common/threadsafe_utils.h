@@ -19,8 +19,14 @@
 
 #pragma once
 
-#include <queue>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
 
 namespace spacel {
 
@@ -65,4 +71,215 @@ private:
 	std::mutex m_mutex;
 	std::deque<T> m_queue;
 };
+
+#define QUEUE_CACHE_LINE_SIZE 64
+
+/*
+ * Lock-free bounded ring queue for one producer thread and one consumer thread.
+ * Capacity must be a power of two, push_back waits for the consumer when the queue is full
+ */
+template <typename T, size_t Capacity>
+class SPSCQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+		"SPSCQueue capacity must be a power of two");
+public:
+	SPSCQueue(): m_slots(Capacity) {}
+	~SPSCQueue() {}
+
+	// Consumer side
+	const bool empty() const
+	{
+		return m_head.load(std::memory_order_relaxed) == m_tail.load(std::memory_order_acquire);
+	}
+
+	size_t size() const
+	{
+		return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+	}
+
+	// Producer side, t is left untouched if the queue is full
+	template <typename U>
+	bool try_push(U &&t)
+	{
+		const size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head_cache == Capacity) {
+			m_head_cache = m_head.load(std::memory_order_acquire);
+			if (tail - m_head_cache == Capacity) {
+				return false;
+			}
+		}
+
+		m_slots[tail & (Capacity - 1)] = std::forward<U>(t);
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	void push_back(T t)
+	{
+		while (!try_push(std::move(t))) {
+			std::this_thread::yield();
+		}
+	}
+
+	bool try_pop(T &t)
+	{
+		return pop_front(&t, 1) == 1;
+	}
+
+	T pop_front()
+	{
+		T t = T();
+		try_pop(t);
+		return t;
+	}
+
+	// Pop up to max_count elements in one step, returns the number of popped elements
+	size_t pop_front(T *out, const size_t max_count)
+	{
+		const size_t head = m_head.load(std::memory_order_relaxed);
+		if (m_tail_cache - head < max_count) {
+			m_tail_cache = m_tail.load(std::memory_order_acquire);
+		}
+
+		const size_t count = std::min(m_tail_cache - head, max_count);
+		for (size_t i = 0; i < count; i++) {
+			out[i] = std::move(m_slots[(head + i) & (Capacity - 1)]);
+		}
+
+		m_head.store(head + count, std::memory_order_release);
+		return count;
+	}
+
+private:
+	std::vector<T> m_slots;
+
+	// Padding keeps each side on its own cache line. alignas would over-align the
+	// queue, which operator new doesn't honour before C++17
+	char m_head_padding[QUEUE_CACHE_LINE_SIZE];
+	// Consumer position and the last producer position it has seen
+	std::atomic<size_t> m_head{0};
+	size_t m_tail_cache = 0;
+
+	char m_tail_padding[QUEUE_CACHE_LINE_SIZE];
+	// Producer position and the last consumer position it has seen
+	std::atomic<size_t> m_tail{0};
+	size_t m_head_cache = 0;
+	char m_end_padding[QUEUE_CACHE_LINE_SIZE];
+};
+
+/*
+ * Lock-free bounded ring queue for many producer threads and one consumer thread.
+ * Each slot has a sequence number telling if it is free or written, producers reserve
+ * slots with a CAS on the tail. Capacity must be a power of two, push_back waits for the
+ * consumer when the queue is full
+ */
+template <typename T, size_t Capacity>
+class MPSCQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+		"MPSCQueue capacity must be a power of two");
+public:
+	MPSCQueue(): m_slots(new Slot[Capacity])
+	{
+		for (size_t i = 0; i < Capacity; i++) {
+			m_slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+	~MPSCQueue() {}
+
+	// Consumer side, a slot reserved by a producer is not visible until it is written
+	const bool empty() const
+	{
+		const size_t head = m_head.load(std::memory_order_relaxed);
+		return m_slots[head & (Capacity - 1)].sequence.load(std::memory_order_acquire) !=
+			head + 1;
+	}
+
+	size_t size() const
+	{
+		return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+	}
+
+	// t is left untouched if the queue is full
+	template <typename U>
+	bool try_push(U &&t)
+	{
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+		Slot *slot;
+		for (;;) {
+			slot = &m_slots[tail & (Capacity - 1)];
+			const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			const intptr_t diff = (intptr_t) sequence - (intptr_t) tail;
+			if (diff == 0) {
+				if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {
+				// The consumer didn't release this slot yet
+				return false;
+			} else {
+				tail = m_tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		slot->value = std::forward<U>(t);
+		slot->sequence.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	void push_back(T t)
+	{
+		while (!try_push(std::move(t))) {
+			std::this_thread::yield();
+		}
+	}
+
+	bool try_pop(T &t)
+	{
+		return pop_front(&t, 1) == 1;
+	}
+
+	T pop_front()
+	{
+		T t = T();
+		try_pop(t);
+		return t;
+	}
+
+	// Pop up to max_count elements in one step, returns the number of popped elements
+	size_t pop_front(T *out, const size_t max_count)
+	{
+		const size_t head = m_head.load(std::memory_order_relaxed);
+		size_t count = 0;
+		for (; count < max_count; count++) {
+			Slot &slot = m_slots[(head + count) & (Capacity - 1)];
+			if (slot.sequence.load(std::memory_order_acquire) != head + count + 1) {
+				break;
+			}
+
+			out[count] = std::move(slot.value);
+			// Free the slot for the next lap
+			slot.sequence.store(head + count + Capacity, std::memory_order_release);
+		}
+
+		m_head.store(head + count, std::memory_order_release);
+		return count;
+	}
+
+private:
+	struct Slot
+	{
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	std::unique_ptr<Slot[]> m_slots;
+	// Consumer and producer positions on their own cache lines, see SPSCQueue
+	char m_head_padding[QUEUE_CACHE_LINE_SIZE];
+	std::atomic<size_t> m_head{0};
+	char m_tail_padding[QUEUE_CACHE_LINE_SIZE];
+	std::atomic<size_t> m_tail{0};
+	char m_end_padding[QUEUE_CACHE_LINE_SIZE];
+};
 }
@@ -19,8 +19,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <ctime>
+#include <mutex>
 #include <string>
 
 namespace spacel {
@@ -50,4 +54,81 @@ inline static std::string timestamp_to_string(const uint64_t &timestamp, bool lo
 	}
 	return std::string(mbstr);
 }
+
+// Ticks late by more than this are dropped instead of being caught up
+#define TICK_SCHEDULER_MAX_CATCHUP_TICKS 5
+
+/*
+ * Fixed timestep scheduler on a monotonic clock. Wait returns when the next tick is due or
+ * as soon as Notify is called, threads don't need to poll their queues between ticks
+ */
+class TickScheduler
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	TickScheduler(const uint32_t tick_rate) { SetTickRate(tick_rate); }
+
+	void SetTickRate(const uint32_t tick_rate)
+	{
+		m_interval = std::chrono::duration_cast<Clock::duration>(
+			std::chrono::duration<double>(1.0 / std::max<uint32_t>(tick_rate, 1)));
+		m_next_tick = Clock::now() + m_interval;
+	}
+
+	// Tick duration in seconds
+	const float GetTickInterval() const
+	{
+		return std::chrono::duration<float>(m_interval).count();
+	}
+
+	// Number of ticks dropped because the thread was too late
+	const uint64_t GetDroppedTicks() const { return m_dropped_ticks; }
+
+	// Wake up the waiting thread, callable from any thread
+	void Notify()
+	{
+		if (!m_notified.exchange(true)) {
+			// Taking the lock ensures the waiter is either before its check or waiting
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_condition.notify_one();
+		}
+	}
+
+	/*
+	 * Wait for the next tick or a notification. Returns the number of ticks to run,
+	 * 0 means the thread was only notified
+	 */
+	uint32_t Wait()
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait_until(lock, m_next_tick, [this] { return m_notified.load(); });
+		}
+		m_notified.store(false);
+
+		const Clock::time_point now = Clock::now();
+		uint32_t ticks = 0;
+		while (m_next_tick <= now && ticks < TICK_SCHEDULER_MAX_CATCHUP_TICKS) {
+			m_next_tick += m_interval;
+			ticks++;
+		}
+
+		if (m_next_tick <= now) {
+			m_dropped_ticks += (now - m_next_tick) / m_interval + 1;
+			m_next_tick = now + m_interval;
+		}
+
+		return ticks;
+	}
+
+private:
+	Clock::duration m_interval;
+	Clock::time_point m_next_tick;
+	uint64_t m_dropped_ticks = 0;
+
+	std::atomic<bool> m_notified{false};
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+};
 }
@@ -0,0 +1,203 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <getopt.h>
+#include <csignal>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+#include <common/engine/generators.h>
+#include <common/engine/objectmanager.h>
+#include <common/engine/server.h>
+#include <common/engine/space.h>
+#include <common/porting.h>
+#include "project_defines.h"
+
+using namespace Urho3D;
+
+namespace spacel {
+
+// Init singletons
+engine::Universe *engine::Universe::s_universe = nullptr;
+engine::ObjectMgr *engine::ObjectMgr::s_objmgr = nullptr;
+engine::UniverseGenerator *engine::UniverseGenerator::s_univgen = nullptr;
+uint64_t engine::UniverseGenerator::s_seed = 0;
+engine::UniverseGeneratorBackend engine::UniverseGenerator::s_backend =
+	engine::UNIVGEN_BACKEND_COUNTER;
+
+}
+
+static std::atomic<bool> s_should_run(true);
+
+static std::atomic<bool> s_dump_profile(false);
+
+static void handle_stop_signal(int)
+{
+	s_should_run = false;
+}
+
+static void handle_profile_signal(int)
+{
+	s_dump_profile = true;
+}
+
+static void print_usage(const char *program)
+{
+	std::cout << "Usage: " << program << " [options]" << std::endl
+		<< "  --datapath PATH      Directory holding the universes (default: ./universe/)" << std::endl
+		<< "  --gamedatapath PATH  Game datas directory (default: ./Data/game/)" << std::endl
+		<< "  --universe NAME      Universe to host (default: default)" << std::endl
+		<< "  --tick-rate N        Server ticks per second, overrides server.json" << std::endl
+		<< "  --port N             UDP port, overrides server.json" << std::endl
+		<< "  --log-file PATH      Also write the log to this file" << std::endl
+		<< "  --profile-file PATH  Chrome trace written on SIGUSR1, stats and packet metrics" << std::endl
+		<< "                       are logged (default: spacel_profile.json)" << std::endl
+		<< "  --quiet              Don't write the log to the console" << std::endl
+		<< "  --help               Show this help" << std::endl;
+}
+
+static std::string with_trailing_delim(const std::string &path)
+{
+	if (path.empty() || path.back() == DIR_DELIM[0]) {
+		return path;
+	}
+
+	return path + DIR_DELIM;
+}
+
+static void dump_profile(const spacel::engine::Server *server, const std::string &path)
+{
+	std::ofstream trace_file(path, std::ofstream::binary);
+	if (!trace_file.good()) {
+		URHO3D_LOGERRORF("Unable to write the profile to %s", path.c_str());
+		return;
+	}
+	server->GetProfiler().WriteChromeTrace(trace_file);
+
+	std::ostringstream stats;
+	server->GetProfiler().WriteStats(stats);
+	stats << std::endl;
+	server->GetRouterMetrics().WriteReport(stats);
+	URHO3D_LOGINFOF("Profile written to %s\n%s", path.c_str(), stats.str().c_str());
+}
+
+int main(int argc, char *argv[])
+{
+	static const option long_options[] = {
+		{ "datapath", required_argument, nullptr, 'd' },
+		{ "gamedatapath", required_argument, nullptr, 'g' },
+		{ "universe", required_argument, nullptr, 'u' },
+		{ "tick-rate", required_argument, nullptr, 't' },
+		{ "port", required_argument, nullptr, 'p' },
+		{ "log-file", required_argument, nullptr, 'l' },
+		{ "profile-file", required_argument, nullptr, 'r' },
+		{ "quiet", no_argument, nullptr, 'q' },
+		{ "help", no_argument, nullptr, 'h' },
+		{ nullptr, 0, nullptr, 0 },
+	};
+
+	std::string datapath = "universe" DIR_DELIM, gamedatapath = "Data" DIR_DELIM "game" DIR_DELIM,
+		universe_name = "default", log_file = "", profile_file = "spacel_profile.json";
+	uint32_t tick_rate = 0, port = 0;
+	bool quiet = false;
+	int opt;
+	while ((opt = getopt_long(argc, argv, "d:g:u:t:p:l:r:qh", long_options, nullptr)) != -1) {
+		switch (opt) {
+			case 'd': datapath = with_trailing_delim(optarg); break;
+			case 'g': gamedatapath = with_trailing_delim(optarg); break;
+			case 'u': universe_name = optarg; break;
+			case 't': tick_rate = strtoul(optarg, nullptr, 10); break;
+			case 'p': port = strtoul(optarg, nullptr, 10); break;
+			case 'l': log_file = optarg; break;
+			case 'r': profile_file = optarg; break;
+			case 'q': quiet = true; break;
+			case 'h':
+				print_usage(argv[0]);
+				return 0;
+			default:
+				print_usage(argv[0]);
+				return 1;
+		}
+	}
+
+	if (port > 65535 || tick_rate > 1000 || universe_name.empty()) {
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	// Only the core and IO subsystems, no rendering, audio or UI
+	SharedPtr<Context> context(new Context());
+	context->RegisterSubsystem(new FileSystem(context));
+	Log *log = new Log(context);
+	context->RegisterSubsystem(log);
+	log->SetLevel(LOG_DEBUG);
+	log->SetQuiet(quiet);
+	if (!log_file.empty()) {
+		log->Open(log_file.c_str());
+	}
+
+	context->GetSubsystem<FileSystem>()->CreateDir((datapath + universe_name).c_str());
+
+	URHO3D_LOGINFOF("%s dedicated server, protocol %d", PROJECT_LABEL_SHORT, PROTOCOL_VERSION);
+
+	// The universe seed is stored but not read back yet, Server::InitServer uses a fixed one
+	spacel::engine::UniverseGenerator::SetSeed(180);
+
+	signal(SIGINT, handle_stop_signal);
+	signal(SIGTERM, handle_stop_signal);
+	signal(SIGUSR1, handle_profile_signal);
+
+	spacel::engine::Server *server = new spacel::engine::Server(gamedatapath, datapath,
+		universe_name);
+	server->SetTickRate(tick_rate);
+	server->SetPort(port);
+	server->Run();
+
+	int exit_code = 0;
+	while (s_should_run) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+		// Messages logged from other threads are written at the end of frames
+		log->SendEvent(E_ENDFRAME);
+
+		if (server->GetLoadingStep() == spacel::engine::SERVERLOADINGSTEP_FAILED) {
+			exit_code = 1;
+			break;
+		}
+
+		if (s_dump_profile.exchange(false)) {
+			dump_profile(server, profile_file);
+		}
+	}
+
+	URHO3D_LOGINFO("Stopping server");
+	server->Stop();
+	delete server;
+	log->SendEvent(E_ENDFRAME);
+	return exit_code;
+}
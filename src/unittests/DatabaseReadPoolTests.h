@@ -0,0 +1,177 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "../common/engine/databases/database-sqlite3.h"
+#include "../common/engine/databases/databasereadpool.h"
+#include "../common/engine/solarsystemcache.h"
+#include "../common/engine/space.h"
+#include "../common/jobsystem.h"
+
+namespace spacel {
+namespace unittests {
+
+class DatabaseReadPoolUnitTest : public CppUnit::TestFixture {
+private:
+public:
+	DatabaseReadPoolUnitTest() {}
+	virtual ~DatabaseReadPoolUnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("DatabaseReadPool");
+		suiteOfTests->addTest(new CppUnit::TestCaller<DatabaseReadPoolUnitTest>(
+				"Test1 - Connection per thread.",
+				&DatabaseReadPoolUnitTest::test_connections));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<DatabaseReadPoolUnitTest>(
+				"Test2 - Reads during a write transaction.",
+				&DatabaseReadPoolUnitTest::test_concurrent_write));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<DatabaseReadPoolUnitTest>(
+				"Test3 - Parallel cache prefetch.",
+				&DatabaseReadPoolUnitTest::test_prefetch));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp()
+	{
+		char path[] = "/tmp/spacelunittests.XXXXXX";
+		CPPUNIT_ASSERT(mkdtemp(path));
+		m_path = path;
+
+		engine::UniverseGenerator::SetSeed(180);
+		m_source = m_universe.CreateGalaxy(1000);
+		m_db = new engine::DatabaseSQLite3(m_path);
+		m_db->BeginTransaction();
+		m_db->CreateGalaxy(m_source);
+		m_db->CreateSolarSystems(m_source, 0, m_source->solar_systems.size());
+		m_db->CommitTransaction();
+	}
+
+	/// Teardown method
+	void tearDown()
+	{
+		delete m_db;
+		for (const char *file: { "universe.db", "universe.db-wal", "universe.db-shm" }) {
+			std::remove((m_path + "/" + file).c_str());
+		}
+		rmdir(m_path.c_str());
+	}
+
+protected:
+	void test_connections()
+	{
+		engine::DatabaseReadPool pool(m_path);
+		engine::Database *db = pool.Get();
+		CPPUNIT_ASSERT(pool.Get() == db);
+
+		std::vector<engine::Database *> thread_dbs(4, nullptr);
+		std::vector<uint8_t> loaded(4, 0);
+		std::vector<std::thread> threads;
+		for (uint32_t t = 0; t < 4; t++) {
+			threads.emplace_back([&, t] {
+				thread_dbs[t] = pool.Get();
+				engine::SolarSystem ss;
+				const engine::SolarSystemHandle source = m_source->solar_systems[t * 100];
+				loaded[t] = thread_dbs[t]->LoadSolarSystem(m_source, source.GetId(), &ss) &&
+					ss.radius == source.GetRadius();
+			});
+		}
+
+		for (std::thread &thread: threads) {
+			thread.join();
+		}
+
+		CPPUNIT_ASSERT(pool.GetConnectionCount() == 5);
+		for (uint32_t t = 0; t < 4; t++) {
+			CPPUNIT_ASSERT(loaded[t]);
+			CPPUNIT_ASSERT(thread_dbs[t] != db);
+		}
+	}
+
+	void test_concurrent_write()
+	{
+		engine::DatabaseReadPool pool(m_path);
+		const uint64_t id = m_source->solar_systems[0].GetId();
+		engine::SolarSystem ss;
+		m_source->solar_systems[0].ToSolarSystem(&ss);
+		ss.galaxy = m_source;
+		ss.radius = 42.0;
+
+		m_db->BeginTransaction();
+		m_db->SaveSolarSystem(ss);
+
+		// Readers see the last committed state without waiting for the writer
+		engine::SolarSystem read;
+		CPPUNIT_ASSERT(pool.Get()->LoadSolarSystem(m_source, id, &read));
+		CPPUNIT_ASSERT(read.radius == m_source->solar_systems[0].GetRadius());
+
+		m_db->CommitTransaction();
+		CPPUNIT_ASSERT(pool.Get()->LoadSolarSystem(m_source, id, &read));
+		CPPUNIT_ASSERT(read.radius == 42.0);
+	}
+
+	void test_prefetch()
+	{
+		engine::DatabaseReadPool pool(m_path);
+		JobSystem jobs(3);
+		engine::Galaxy galaxy;
+		galaxy.id = m_source->id;
+		engine::SolarSystemCache cache(m_db, &galaxy, 16 * 1024 * 1024);
+		cache.SetReadPool(&pool, &jobs);
+
+		std::vector<uint64_t> ids = m_source->solar_systems.GetIds();
+		// Already cached and unknown solar systems are skipped
+		cache.Get(ids[0]);
+		ids.push_back(1000 * 1000 * 1000);
+		CPPUNIT_ASSERT(cache.Prefetch(ids) == m_source->solar_systems.size() - 1);
+		CPPUNIT_ASSERT(cache.size() == m_source->solar_systems.size());
+		CPPUNIT_ASSERT(pool.GetConnectionCount() >= 1);
+
+		const uint64_t misses = cache.GetMisses();
+		const engine::SolarSystemHandle source = m_source->solar_systems[500];
+		engine::SolarSystem *ss = cache.Get(source.GetId());
+		CPPUNIT_ASSERT(ss && ss->galaxy == &galaxy && ss->name == source.GetName());
+		CPPUNIT_ASSERT(cache.GetMisses() == misses);
+	}
+
+	std::string m_path = "";
+	engine::Universe m_universe;
+	engine::Galaxy *m_source = nullptr;
+	engine::DatabaseSQLite3 *m_db = nullptr;
+};
+
+}
+}
@@ -0,0 +1,230 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sqlite3.h>
+#include <unistd.h>
+#include "../common/engine/databases/database-sqlite3.h"
+#include "../common/engine/space.h"
+
+namespace spacel {
+namespace unittests {
+
+class DatabaseSQLite3UnitTest : public CppUnit::TestFixture {
+private:
+public:
+	DatabaseSQLite3UnitTest() {}
+	virtual ~DatabaseSQLite3UnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("DatabaseSQLite3");
+		suiteOfTests->addTest(new CppUnit::TestCaller<DatabaseSQLite3UnitTest>(
+				"Test1 - Universe generator settings.",
+				&DatabaseSQLite3UnitTest::test_universe_backend));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<DatabaseSQLite3UnitTest>(
+				"Test2 - Universes created before the generator settings.",
+				&DatabaseSQLite3UnitTest::test_legacy_universe));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<DatabaseSQLite3UnitTest>(
+				"Test3 - Universe restart.",
+				&DatabaseSQLite3UnitTest::test_universe_restart));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<DatabaseSQLite3UnitTest>(
+				"Test4 - Solar system positions.",
+				&DatabaseSQLite3UnitTest::test_solarsystem_positions));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<DatabaseSQLite3UnitTest>(
+				"Test5 - Derived names are not saved.",
+				&DatabaseSQLite3UnitTest::test_save_derived_name));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp()
+	{
+		char path[] = "/tmp/spacelunittests.XXXXXX";
+		CPPUNIT_ASSERT(mkdtemp(path));
+		m_path = path;
+	}
+
+	/// Teardown method
+	void tearDown()
+	{
+		for (const char *file: { "universe.db", "universe.db-wal", "universe.db-shm" }) {
+			std::remove((m_path + "/" + file).c_str());
+		}
+		rmdir(m_path.c_str());
+	}
+
+protected:
+	void test_universe_backend()
+	{
+		engine::DatabaseSQLite3 db(m_path);
+		db.CreateUniverse("test", 180);
+		db.SetUniverseBackend("test", engine::UNIVGEN_BACKEND_COUNTER);
+		CPPUNIT_ASSERT(db.GetUniverseBackend("test") == engine::UNIVGEN_BACKEND_COUNTER);
+		db.SetUniverseBackend("test", engine::UNIVGEN_BACKEND_MT19937);
+		CPPUNIT_ASSERT(db.GetUniverseBackend("test") == engine::UNIVGEN_BACKEND_MT19937);
+
+		// Written by a newer version
+		db.SetUniverseBackend("test", engine::UNIVGEN_BACKEND_COUNT);
+		bool rejected = false;
+		try {
+			db.GetUniverseBackend("test");
+		}
+		catch (engine::SQLiteException &e) {
+			rejected = true;
+		}
+		CPPUNIT_ASSERT(rejected);
+
+		CPPUNIT_ASSERT(!db.HasUniverseDerivedNames("test"));
+		db.SetUniverseDerivedNames("test", true);
+		CPPUNIT_ASSERT(db.HasUniverseDerivedNames("test"));
+	}
+
+	void test_legacy_universe()
+	{
+		// Universe database as created before the generator settings were stored
+		sqlite3 *legacy;
+		CPPUNIT_ASSERT(sqlite3_open((m_path + "/universe.db").c_str(), &legacy) == SQLITE_OK);
+		CPPUNIT_ASSERT(sqlite3_exec(legacy, "CREATE TABLE `gameconfig` ("
+			"	universe_name VARCHAR(32) NOT NULL UNIQUE,"
+			"	seed INTEGER NOT NULL,"
+			"	universe_generated SMALLINT NOT NULL DEFAULT(0),"
+			"	universe_birth BIGINT NOT NULL"
+			");"
+			"INSERT INTO `gameconfig` VALUES ('legacy', 180, 1, 0);",
+			NULL, NULL, NULL) == SQLITE_OK);
+		sqlite3_close(legacy);
+
+		engine::DatabaseSQLite3 db(m_path);
+		CPPUNIT_ASSERT(db.IsUniverseGenerated("legacy"));
+		CPPUNIT_ASSERT(db.GetUniverseBackend("legacy") == engine::UNIVGEN_BACKEND_MT19937);
+		CPPUNIT_ASSERT(!db.HasUniverseDerivedNames("legacy"));
+	}
+
+	void test_universe_restart()
+	{
+		engine::Universe universe;
+		engine::Galaxy *galaxy = universe.CreateGalaxy(200);
+		{
+			// First start of a dedicated server, as done by Server::InitServer
+			engine::DatabaseSQLite3 db(m_path);
+			CPPUNIT_ASSERT(!db.LoadUniverse("restart"));
+			db.CreateUniverse("restart", 180);
+			CPPUNIT_ASSERT(!db.IsUniverseGenerated("restart"));
+
+			db.BeginTransaction();
+			db.CreateGalaxy(galaxy);
+			db.CreateSolarSystems(galaxy, 0, galaxy->solar_systems.size());
+			db.SetUniverseBackend("restart", engine::UNIVGEN_BACKEND_COUNTER);
+			db.SetUniverseGenerated("restart", true);
+			db.CommitTransaction();
+		}
+
+		// Restart loads the saved galaxy instead of generating it again
+		engine::DatabaseSQLite3 db(m_path);
+		CPPUNIT_ASSERT(db.LoadUniverse("restart"));
+		CPPUNIT_ASSERT(db.IsUniverseGenerated("restart"));
+		CPPUNIT_ASSERT(db.GetUniverseBackend("restart") == engine::UNIVGEN_BACKEND_COUNTER);
+
+		std::unique_ptr<engine::Galaxy> loaded(db.LoadGalaxy(galaxy->id));
+		CPPUNIT_ASSERT(loaded);
+		db.LoadSolarSystemsForGalaxy(loaded.get());
+		CPPUNIT_ASSERT(loaded->solar_systems.size() == galaxy->solar_systems.size());
+	}
+
+	void test_solarsystem_positions()
+	{
+		engine::Universe universe;
+		engine::Galaxy *galaxy = universe.CreateGalaxy(200);
+		engine::DatabaseSQLite3 db(m_path);
+		db.BeginTransaction();
+		db.CreateGalaxy(galaxy);
+		db.CreateSolarSystems(galaxy, 0, galaxy->solar_systems.size());
+		db.CommitTransaction();
+
+		// Names are not loaded, paged galaxies read them on demand
+		std::unique_ptr<engine::Galaxy> loaded(db.LoadGalaxy(galaxy->id));
+		db.LoadSolarSystemPositionsForGalaxy(loaded.get());
+		CPPUNIT_ASSERT(loaded->solar_systems.size() == galaxy->solar_systems.size());
+		for (const auto &ss: loaded->solar_systems) {
+			uint32_t row;
+			CPPUNIT_ASSERT(galaxy->solar_systems.Find(ss.GetId(), row));
+			const engine::SolarSystemHandle origin = galaxy->solar_systems[row];
+			CPPUNIT_ASSERT(ss.GetStoredName().empty());
+			CPPUNIT_ASSERT(ss.GetType() == origin.GetType() && ss.GetRadius() == origin.GetRadius());
+			CPPUNIT_ASSERT(ss.GetPosX() == origin.GetPosX() && ss.GetPosZ() == origin.GetPosZ());
+		}
+	}
+
+	void test_save_derived_name()
+	{
+		engine::Galaxy galaxy;
+		galaxy.id = 1;
+		engine::SolarSystem ss;
+		ss.id = 42;
+		ss.galaxy = &galaxy;
+		ss.type = engine::SOLAR_TYPE_CLASSIC;
+		ss.radius = 1.0;
+		ss.pos_x = ss.pos_y = ss.pos_z = 0.0;
+
+		engine::Universe::instance()->SetDerivedNames(true);
+		{
+			// Loaded solar systems carry their derived name, saving them keeps it empty
+			engine::DatabaseSQLite3 db(m_path);
+			db.CreateGalaxy(&galaxy);
+			db.SaveSolarSystem(ss);
+			engine::SolarSystem loaded;
+			CPPUNIT_ASSERT(db.LoadSolarSystem(&galaxy, ss.id, &loaded));
+			CPPUNIT_ASSERT(!loaded.name.empty());
+			db.SaveSolarSystem(loaded);
+		}
+		engine::Universe::instance()->SetDerivedNames(false);
+
+		sqlite3 *raw;
+		sqlite3_stmt *stmt;
+		CPPUNIT_ASSERT(sqlite3_open((m_path + "/universe.db").c_str(), &raw) == SQLITE_OK);
+		static const char *name_sql = "SELECT `solarsystem_name` FROM `solar_systems`";
+		CPPUNIT_ASSERT(sqlite3_prepare_v2(raw, name_sql, -1, &stmt, NULL) == SQLITE_OK);
+		CPPUNIT_ASSERT(sqlite3_step(stmt) == SQLITE_ROW);
+		CPPUNIT_ASSERT(sqlite3_column_bytes(stmt, 0) == 0);
+		sqlite3_finalize(stmt);
+		sqlite3_close(raw);
+	}
+
+	std::string m_path = "";
+};
+
+}
+}
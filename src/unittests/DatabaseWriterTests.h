@@ -0,0 +1,163 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include "../common/engine/databases/databasewriter.h"
+#include "../common/engine/solarsystemcache.h"
+#include "../common/engine/space.h"
+#include "TestDatabase.h"
+
+namespace spacel {
+namespace unittests {
+
+class DatabaseWriterUnitTest : public CppUnit::TestFixture {
+private:
+public:
+	DatabaseWriterUnitTest() {}
+	virtual ~DatabaseWriterUnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("DatabaseWriter");
+		suiteOfTests->addTest(new CppUnit::TestCaller<DatabaseWriterUnitTest>(
+				"Test1 - Coalesced writes and read-your-writes.",
+				&DatabaseWriterUnitTest::test_coalesce));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<DatabaseWriterUnitTest>(
+				"Test2 - Writer thread flush.",
+				&DatabaseWriterUnitTest::test_thread));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<DatabaseWriterUnitTest>(
+				"Test3 - Failed transaction is retried.",
+				&DatabaseWriterUnitTest::test_failed_transaction));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp()
+	{
+		m_galaxy.id = 1;
+	}
+
+	/// Teardown method
+	void tearDown() {}
+
+protected:
+	engine::SolarSystem MakeSolarSystem(const uint64_t id, const double radius)
+	{
+		engine::SolarSystem ss;
+		ss.id = id;
+		ss.name = "Sol";
+		ss.type = engine::SOLAR_TYPE_CLASSIC;
+		ss.pos_x = 0.5;
+		ss.pos_y = 0.25;
+		ss.pos_z = 0.0;
+		ss.radius = radius;
+		ss.galaxy = &m_galaxy;
+		return ss;
+	}
+
+	void test_coalesce()
+	{
+		TestDatabase *db = new TestDatabase();
+		engine::DatabaseWriter writer(db, 1000);
+
+		for (uint32_t i = 1; i <= 3; i++) {
+			writer.SaveSolarSystem(MakeSolarSystem(42, i));
+		}
+		CPPUNIT_ASSERT(writer.GetMetrics().pending_objects == 1);
+		CPPUNIT_ASSERT(writer.GetMetrics().coalesced_writes == 2);
+
+		// The cache reads the pending state before it is written
+		engine::Galaxy galaxy;
+		galaxy.id = 1;
+		engine::SolarSystemCache cache(db, &galaxy, 1024 * 1024);
+		cache.SetWriter(&writer);
+		engine::SolarSystem *ss = cache.Get(42);
+		CPPUNIT_ASSERT(ss && ss->radius == 3 && ss->galaxy == &galaxy);
+		CPPUNIT_ASSERT(db->rows.empty());
+
+		writer.Flush();
+		CPPUNIT_ASSERT(db->saves == 1 && db->commits == 1);
+		CPPUNIT_ASSERT(db->rows[42].radius == 3);
+
+		engine::SolarSystem pending;
+		CPPUNIT_ASSERT(!writer.GetPendingSolarSystem(42, &pending));
+		CPPUNIT_ASSERT(writer.GetMetrics().pending_objects == 0);
+		CPPUNIT_ASSERT(writer.GetMetrics().written_objects == 1);
+	}
+
+	void test_thread()
+	{
+		TestDatabase *db = new TestDatabase();
+		engine::DatabaseWriter writer(db, 1000);
+		writer.Run();
+
+		for (uint32_t i = 0; i < 1000; i++) {
+			writer.SaveSolarSystem(MakeSolarSystem(i % 100, i));
+		}
+
+		// Flush doesn't wait for the flush interval
+		const auto start = std::chrono::steady_clock::now();
+		writer.Flush();
+		CPPUNIT_ASSERT(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500));
+		CPPUNIT_ASSERT(db->rows.size() == 100);
+		CPPUNIT_ASSERT(db->rows[99].radius == 999);
+		CPPUNIT_ASSERT(db->saves == writer.GetMetrics().written_objects);
+
+		// Objects marked while stopping are written
+		writer.SaveSolarSystem(MakeSolarSystem(1000, 1));
+		writer.Shutdown();
+		CPPUNIT_ASSERT(db->rows.size() == 101);
+	}
+
+	void test_failed_transaction()
+	{
+		TestDatabase *db = new TestDatabase();
+		engine::DatabaseWriter writer(db, 1000);
+
+		db->fail_commits = 1;
+		writer.SaveSolarSystem(MakeSolarSystem(1, 1));
+		writer.Flush();
+		CPPUNIT_ASSERT(db->rows.empty());
+		CPPUNIT_ASSERT(writer.GetMetrics().failed_transactions == 1);
+
+		// The newest state wins over the failed batch
+		engine::SolarSystem pending;
+		CPPUNIT_ASSERT(writer.GetPendingSolarSystem(1, &pending) && pending.radius == 1);
+		writer.SaveSolarSystem(MakeSolarSystem(1, 2));
+		writer.Flush();
+		CPPUNIT_ASSERT(db->rows[1].radius == 2);
+		CPPUNIT_ASSERT(writer.GetMetrics().pending_objects == 0);
+	}
+
+	engine::Galaxy m_galaxy;
+};
+
+}
+}
@@ -0,0 +1,457 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include "../common/engine/galaxyinterest.h"
+#include "../common/engine/generators.h"
+#include "../common/engine/space.h"
+#include "../common/engine/network/galaxyencoding.h"
+#include "../common/engine/network/localmessages.h"
+#include "../common/engine/network/networkprotocol.h"
+
+namespace spacel {
+namespace unittests {
+
+class GalaxyInterestUnitTest : public CppUnit::TestFixture {
+private:
+public:
+	GalaxyInterestUnitTest() {}
+	virtual ~GalaxyInterestUnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("GalaxyInterest");
+		suiteOfTests->addTest(new CppUnit::TestCaller<GalaxyInterestUnitTest>("Test1 - Stream with byte budget.",
+				&GalaxyInterestUnitTest::test_stream_budget));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<GalaxyInterestUnitTest>("Test2 - Remove on move.",
+				&GalaxyInterestUnitTest::test_move));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<GalaxyInterestUnitTest>("Test3 - Compact primitives.",
+				&GalaxyInterestUnitTest::test_compact_primitives));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<GalaxyInterestUnitTest>("Test4 - Compact stream.",
+				&GalaxyInterestUnitTest::test_compact_stream));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<GalaxyInterestUnitTest>("Test5 - Derived names stream.",
+				&GalaxyInterestUnitTest::test_derived_names_stream));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<GalaxyInterestUnitTest>("Test6 - Local messages.",
+				&GalaxyInterestUnitTest::test_local_messages));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<GalaxyInterestUnitTest>("Test7 - Name source.",
+				&GalaxyInterestUnitTest::test_name_source));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<GalaxyInterestUnitTest>("Test8 - Corrupted compact packets.",
+				&GalaxyInterestUnitTest::test_corrupted_compact));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp()
+	{
+		engine::UniverseGenerator::SetSeed(180);
+		m_galaxy = m_universe.CreateGalaxy(5000);
+	}
+
+	/// Teardown method
+	void tearDown() {}
+
+protected:
+	void test_stream_budget()
+	{
+		engine::GalaxyInterest interest(m_galaxy, 0.3, false);
+		const engine::SolarSystemHandle center = m_galaxy->solar_systems[0];
+		interest.SetPosition(center.GetPosX(), center.GetPosY(), center.GetPosZ());
+
+		std::vector<uint64_t> in_range;
+		m_galaxy->spatial_index.QueryRadius(center.GetPosX(), center.GetPosY(),
+			center.GetPosZ(), 0.3, in_range);
+		CPPUNIT_ASSERT(in_range.size() > 10);
+
+		uint32_t ticks = 0;
+		std::vector<engine::network::NetworkPacket *> packets;
+		while (interest.HasPendingUpdates()) {
+			CPPUNIT_ASSERT(interest.Flush(256, packets) <= 256);
+			CPPUNIT_ASSERT(packets.size() == 1);
+
+			std::unique_ptr<engine::network::NetworkPacket> packet(packets[0]);
+			CPPUNIT_ASSERT(packet->GetOpcode() == engine::network::SMSG_GALAXY_SYSTEMS);
+			CPPUNIT_ASSERT(packet->GetSize() <= 256);
+
+			// The nearest solar system is sent first
+			packet->Seek(2);
+			CPPUNIT_ASSERT(packet->ReadUInt() > 0);
+			if (ticks == 0) {
+				CPPUNIT_ASSERT(packet->ReadUInt64() == center.GetId());
+			}
+
+			packets.clear();
+			ticks++;
+		}
+
+		CPPUNIT_ASSERT(ticks > 1);
+		CPPUNIT_ASSERT(interest.GetKnownCount() == in_range.size());
+		for (const uint64_t &id: in_range) {
+			CPPUNIT_ASSERT(interest.IsKnown(id));
+		}
+
+		// Known solar systems are not sent again
+		interest.SetPosition(center.GetPosX(), center.GetPosY(), center.GetPosZ());
+		CPPUNIT_ASSERT(!interest.HasPendingUpdates());
+	}
+
+	void test_move()
+	{
+		engine::GalaxyInterest interest(m_galaxy, 0.2, false);
+		interest.SetPosition(0.5, 0.0, 0.0);
+
+		std::vector<engine::network::NetworkPacket *> packets;
+		while (interest.HasPendingUpdates()) {
+			interest.Flush(64 * 1024, packets);
+		}
+
+		const size_t known_count = interest.GetKnownCount();
+		CPPUNIT_ASSERT(known_count > 0);
+
+		// Small moves keep systems near the boundary
+		interest.SetPosition(0.52, 0.0, 0.0);
+		while (interest.HasPendingUpdates()) {
+			interest.Flush(64 * 1024, packets);
+		}
+
+		for (auto packet: packets) {
+			CPPUNIT_ASSERT(packet->GetOpcode() == engine::network::SMSG_GALAXY_SYSTEMS);
+			delete packet;
+		}
+		packets.clear();
+
+		// Far away, everything is removed
+		interest.SetPosition(10.0, 10.0, 10.0);
+		CPPUNIT_ASSERT(interest.HasPendingUpdates());
+		while (interest.HasPendingUpdates()) {
+			interest.Flush(64 * 1024, packets);
+		}
+
+		CPPUNIT_ASSERT(interest.GetKnownCount() == 0);
+		uint32_t removed = 0;
+		for (auto packet: packets) {
+			CPPUNIT_ASSERT(packet->GetOpcode() == engine::network::SMSG_GALAXY_SYSTEMS_REMOVE);
+			packet->Seek(2);
+			removed += packet->ReadUInt();
+			delete packet;
+		}
+
+		CPPUNIT_ASSERT(removed >= known_count);
+	}
+
+	void test_compact_primitives()
+	{
+		const uint64_t values[] = { 0, 1, 127, 128, 16383, 16384, 1ULL << 35, UINT64_MAX };
+		engine::network::NetworkPacket packet(engine::network::SMSG_GALAXY_SYSTEMS_COMPACT);
+		for (const uint64_t &value: values) {
+			packet.WriteVarUInt64(value);
+		}
+
+		packet.WriteFixed16(0.123456, GALAXY_POSITION_RANGE);
+		packet.WriteFixed16(-1.9, GALAXY_POSITION_RANGE);
+		packet.WriteFixed16(5.0, GALAXY_POSITION_RANGE);
+
+		packet.Seek(2);
+		for (const uint64_t &value: values) {
+			CPPUNIT_ASSERT(packet.ReadVarUInt64() == value);
+		}
+
+		const double step = GALAXY_POSITION_RANGE / INT16_MAX;
+		CPPUNIT_ASSERT(std::abs(packet.ReadFixed16(GALAXY_POSITION_RANGE) - 0.123456) <= step);
+		CPPUNIT_ASSERT(std::abs(packet.ReadFixed16(GALAXY_POSITION_RANGE) + 1.9) <= step);
+		// Out of range values are clamped
+		CPPUNIT_ASSERT(std::abs(packet.ReadFixed16(GALAXY_POSITION_RANGE) -
+			GALAXY_POSITION_RANGE) <= step);
+		CPPUNIT_ASSERT(packet.IsEof());
+
+		CPPUNIT_ASSERT(engine::network::varuint64_size(127) == 1);
+		CPPUNIT_ASSERT(engine::network::varuint64_size(128) == 2);
+		CPPUNIT_ASSERT(engine::network::varuint64_size(UINT64_MAX) == 10);
+
+		uint8_t type;
+		double radius;
+		engine::network::decode_solar_type_radius(engine::network::encode_solar_type_radius(
+			engine::SOLAR_TYPE_PULSAR, 1.5e12), type, radius);
+		CPPUNIT_ASSERT(type == engine::SOLAR_TYPE_PULSAR);
+		CPPUNIT_ASSERT(std::abs(radius / 1.5e12 - 1.0) < 0.005);
+	}
+
+	void test_compact_stream()
+	{
+		const engine::SolarSystemHandle center = m_galaxy->solar_systems[0];
+		engine::GalaxyInterest compact_interest(m_galaxy, 0.3, true),
+			raw_interest(m_galaxy, 0.3, false);
+		compact_interest.SetPosition(center.GetPosX(), center.GetPosY(), center.GetPosZ());
+		raw_interest.SetPosition(center.GetPosX(), center.GetPosY(), center.GetPosZ());
+
+		uint32_t compact_size = 0, raw_size = 0;
+		engine::SolarSystemTable received;
+		engine::network::GalaxyNameDictionary names;
+		std::vector<engine::network::NetworkPacket *> packets;
+		while (compact_interest.HasPendingUpdates()) {
+			CPPUNIT_ASSERT(compact_interest.Flush(512, packets) <= 512);
+			for (auto packet: packets) {
+				CPPUNIT_ASSERT(packet->GetOpcode() ==
+					engine::network::SMSG_GALAXY_SYSTEMS_COMPACT);
+				compact_size += packet->GetSize();
+				packet->Seek(2);
+				CPPUNIT_ASSERT(engine::network::read_galaxy_systems_compact(packet, received,
+					names) > 0);
+				CPPUNIT_ASSERT(packet->IsEof());
+				delete packet;
+			}
+			packets.clear();
+		}
+
+		while (raw_interest.HasPendingUpdates()) {
+			raw_size += raw_interest.Flush(512, packets);
+			for (auto packet: packets) {
+				delete packet;
+			}
+			packets.clear();
+		}
+
+		CPPUNIT_ASSERT(received.size() == compact_interest.GetKnownCount());
+		const double step = GALAXY_POSITION_RANGE / INT16_MAX;
+		for (const auto &ss: received) {
+			uint32_t row;
+			CPPUNIT_ASSERT(m_galaxy->solar_systems.Find(ss.GetId(), row));
+			const engine::SolarSystemHandle origin = m_galaxy->solar_systems[row];
+			CPPUNIT_ASSERT(ss.GetType() == origin.GetType());
+			CPPUNIT_ASSERT(ss.GetName() == origin.GetName());
+			CPPUNIT_ASSERT(std::abs(ss.GetRadius() / origin.GetRadius() - 1.0) < 0.005);
+			CPPUNIT_ASSERT(std::abs(ss.GetPosX() - origin.GetPosX()) <= step);
+			CPPUNIT_ASSERT(std::abs(ss.GetPosY() - origin.GetPosY()) <= step);
+			CPPUNIT_ASSERT(std::abs(ss.GetPosZ() - origin.GetPosZ()) <= step);
+		}
+
+		// Names are mostly unique in a fresh session, the fixed fields shrink from 41 to 8 bytes
+		CPPUNIT_ASSERT(compact_size * 2 < raw_size);
+	}
+
+	void test_derived_names_stream()
+	{
+		engine::Universe universe;
+		universe.SetDerivedNames(true);
+		const engine::Galaxy *galaxy = universe.CreateGalaxy(5000);
+		const engine::SolarSystemHandle center = galaxy->solar_systems[0];
+		engine::GalaxyInterest interest(galaxy, 0.3, true);
+		interest.SetPosition(center.GetPosX(), center.GetPosY(), center.GetPosZ());
+
+		engine::SolarSystemTable received;
+		engine::network::GalaxyNameDictionary names;
+		std::vector<engine::network::NetworkPacket *> packets;
+		while (interest.HasPendingUpdates()) {
+			interest.Flush(512, packets);
+			for (auto packet: packets) {
+				packet->Seek(2);
+				// No name is sent
+				CPPUNIT_ASSERT(packet->ReadVarUInt64() == 0);
+				packet->Seek(2);
+				engine::network::read_galaxy_systems_compact(packet, received, names);
+				delete packet;
+			}
+			packets.clear();
+		}
+
+		CPPUNIT_ASSERT(received.size() == interest.GetKnownCount());
+		CPPUNIT_ASSERT(names.size() == 1);
+		for (const auto &ss: received) {
+			uint32_t row;
+			CPPUNIT_ASSERT(galaxy->solar_systems.Find(ss.GetId(), row));
+			CPPUNIT_ASSERT(ss.GetName() == galaxy->solar_systems[row].GetName());
+		}
+	}
+
+	void test_local_messages()
+	{
+		engine::GalaxyInterest interest(m_galaxy, 0.3, true);
+		interest.SetLocalMessages(true);
+		interest.SetPosition(0.5, 0.0, 0.0);
+
+		std::vector<engine::network::NetworkPacket *> packets;
+		size_t received = 0;
+		while (interest.HasPendingUpdates()) {
+			CPPUNIT_ASSERT(interest.Flush(256, packets) <= 256);
+			for (auto packet: packets) {
+				// Nothing is encoded, the packet only carries its opcode
+				CPPUNIT_ASSERT(packet->GetOpcode() == engine::network::SMSG_GALAXY_SYSTEMS);
+				CPPUNIT_ASSERT(packet->GetSize() == 2);
+
+				const engine::network::GalaxySystemsMessage *message =
+					packet->GetLocalMessage<engine::network::GalaxySystemsMessage>();
+				CPPUNIT_ASSERT(message && !message->systems.empty());
+				CPPUNIT_ASSERT(!packet->GetLocalMessage<engine::network::GalaxySystemsRemoveMessage>());
+				for (const engine::network::GalaxySystemEntry &entry: message->systems) {
+					uint32_t row;
+					CPPUNIT_ASSERT(m_galaxy->solar_systems.Find(entry.id, row));
+					const engine::SolarSystemHandle ss = m_galaxy->solar_systems[row];
+					CPPUNIT_ASSERT(entry.type == ss.GetType() && entry.radius == ss.GetRadius());
+					CPPUNIT_ASSERT(entry.pos_x == ss.GetPosX() && entry.pos_z == ss.GetPosZ());
+					CPPUNIT_ASSERT(entry.name == ss.GetStoredName());
+				}
+
+				received += message->systems.size();
+				delete packet;
+			}
+			packets.clear();
+		}
+
+		CPPUNIT_ASSERT(received > 0 && received == interest.GetKnownCount());
+
+		interest.SetPosition(10.0, 10.0, 10.0);
+		while (interest.HasPendingUpdates()) {
+			interest.Flush(256, packets);
+		}
+
+		size_t removed = 0;
+		for (auto packet: packets) {
+			CPPUNIT_ASSERT(packet->GetOpcode() == engine::network::SMSG_GALAXY_SYSTEMS_REMOVE);
+			const engine::network::GalaxySystemsRemoveMessage *message =
+				packet->GetLocalMessage<engine::network::GalaxySystemsRemoveMessage>();
+			CPPUNIT_ASSERT(message);
+			removed += message->ids.size();
+			delete packet;
+		}
+
+		CPPUNIT_ASSERT(removed == received && interest.GetKnownCount() == 0);
+	}
+
+	void test_name_source()
+	{
+		// Names are only known by the source, like with solar system paging
+		std::unordered_map<uint64_t, std::string> stored_names;
+		for (const auto &ss: m_galaxy->solar_systems) {
+			stored_names[ss.GetId()] = ss.GetStoredName();
+		}
+		m_galaxy->solar_systems.ClearNames();
+		CPPUNIT_ASSERT(m_galaxy->solar_systems[0].GetStoredName().empty());
+
+		// Every other lookup misses, like names which are not paged in yet
+		uint32_t source_calls = 0, misses = 0;
+		engine::GalaxyInterest interest(m_galaxy, 0.3, true);
+		interest.SetNameSource([&] (const uint64_t &id, std::string &name) {
+			if (source_calls++ % 2 == 0) {
+				misses++;
+				return false;
+			}
+
+			name = stored_names[id];
+			return true;
+		});
+		interest.SetPosition(0.5, 0.0, 0.0);
+
+		engine::SolarSystemTable received;
+		engine::network::GalaxyNameDictionary names;
+		std::vector<engine::network::NetworkPacket *> packets;
+		while (interest.HasPendingUpdates()) {
+			std::vector<uint64_t> next_adds;
+			interest.GetNextAdds(512, next_adds);
+			const size_t received_count = received.size();
+			interest.Flush(512, packets);
+			for (auto packet: packets) {
+				packet->Seek(2);
+				engine::network::read_galaxy_systems_compact(packet, received, names);
+				delete packet;
+			}
+			packets.clear();
+
+			// Every streamed solar system was announced, names can be prefetched
+			const std::unordered_set<uint64_t> announced(next_adds.begin(), next_adds.end());
+			for (uint32_t row = received_count; row < received.size(); row++) {
+				CPPUNIT_ASSERT(announced.count(received.GetIds()[row]));
+			}
+		}
+
+		CPPUNIT_ASSERT(received.size() > 0 && received.size() == interest.GetKnownCount());
+		CPPUNIT_ASSERT(misses > 0 && source_calls >= received.size() + misses);
+		for (const auto &ss: received) {
+			CPPUNIT_ASSERT(ss.GetName() == stored_names[ss.GetId()]);
+		}
+	}
+
+	void test_corrupted_compact()
+	{
+		engine::SolarSystemTable received;
+		engine::network::GalaxyNameDictionary names;
+
+		// Counts bigger than the packet
+		engine::network::NetworkPacket names_packet(engine::network::SMSG_GALAXY_SYSTEMS_COMPACT);
+		names_packet.WriteVarUInt64(UINT64_MAX);
+		names_packet.Seek(2);
+		CPPUNIT_ASSERT(engine::network::read_galaxy_systems_compact(&names_packet, received,
+			names) == 0);
+		CPPUNIT_ASSERT(names.size() == 1);
+
+		engine::network::NetworkPacket count_packet(engine::network::SMSG_GALAXY_SYSTEMS_COMPACT);
+		count_packet.WriteVarUInt64(0);
+		count_packet.WriteVarUInt64(1ULL << 40);
+		count_packet.Seek(2);
+		CPPUNIT_ASSERT(engine::network::read_galaxy_systems_compact(&count_packet, received,
+			names) == 0);
+		CPPUNIT_ASSERT(received.empty());
+
+		// Truncated packet, only the complete entries are read
+		engine::GalaxyInterest interest(m_galaxy, 0.3, true);
+		interest.SetPosition(0.5, 0.0, 0.0);
+		std::vector<engine::network::NetworkPacket *> packets;
+		interest.Flush(512, packets);
+		CPPUNIT_ASSERT(packets.size() == 1);
+		std::unique_ptr<engine::network::NetworkPacket> packet(packets[0]);
+
+		packet->Seek(2);
+		engine::network::GalaxyNameDictionary full_names;
+		const uint32_t count = engine::network::read_galaxy_systems_compact(packet.get(),
+			received, full_names);
+		CPPUNIT_ASSERT(count > 1);
+		received.Clear();
+
+		engine::network::NetworkPacket truncated(engine::network::SMSG_GALAXY_SYSTEMS_COMPACT);
+		truncated.Write(packet->GetData() + 2, packet->GetSize() - 2 - 5);
+		truncated.Seek(2);
+		const uint32_t truncated_count = engine::network::read_galaxy_systems_compact(&truncated,
+			received, names);
+		CPPUNIT_ASSERT(truncated_count < count && received.size() == truncated_count);
+	}
+
+private:
+	engine::Universe m_universe;
+	engine::Galaxy *m_galaxy = nullptr;
+};
+
+}
+}
@@ -61,6 +61,21 @@ public:
 
 		suiteOfTests->addTest(new CppUnit::TestCaller<GeneratorsUnitTest>("Test7 - Generate Solar System Planet Distance.",
 				&GeneratorsUnitTest::test_generate_planetdistance));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<GeneratorsUnitTest>("Test8 - Generate Solar System Name.",
+				&GeneratorsUnitTest::test_generate_solarsystem_name));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<GeneratorsUnitTest>("Test9 - Generate Solar System Galaxy Position.",
+				&GeneratorsUnitTest::test_generate_solarsystem_galaxypos));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<GeneratorsUnitTest>("Test10 - Counter Random Determinism.",
+				&GeneratorsUnitTest::test_counter_random));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<GeneratorsUnitTest>("Test11 - Counter Backend Ranges.",
+				&GeneratorsUnitTest::test_counter_backend_ranges));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<GeneratorsUnitTest>("Test12 - MT19937 Backend Streams.",
+				&GeneratorsUnitTest::test_mt19937_streams));
 		return suiteOfTests;
 	}
 
@@ -68,7 +83,10 @@ public:
 	void setUp() {}
 
 	/// Teardown method
-	void tearDown() {}
+	void tearDown()
+	{
+		engine::UniverseGenerator::SetBackend(engine::UNIVGEN_BACKEND_COUNTER);
+	}
 
 protected:
 	void test_generate_seed()
@@ -86,6 +104,7 @@ protected:
 
 	void test_generate_solarsystemradius()
 	{
+		engine::UniverseGenerator::SetBackend(engine::UNIVGEN_BACKEND_MT19937);
 		engine::UniverseGenerator::SetSeed(44887799);
 		double result = engine::UnivGen->generate_solarsystem_radius(
 			5448855);
@@ -94,6 +113,7 @@ protected:
 
 	void test_generate_solarsystemtype()
 	{
+		engine::UniverseGenerator::SetBackend(engine::UNIVGEN_BACKEND_MT19937);
 		engine::UniverseGenerator::SetSeed(487597);
 		uint8_t result = engine::UnivGen->generate_solarsystem_type(12487904);
 		CPPUNIT_ASSERT(result == 3);
@@ -101,6 +121,7 @@ protected:
 
 	void test_generate_solarsystem_planetnumber()
 	{
+		engine::UniverseGenerator::SetBackend(engine::UNIVGEN_BACKEND_MT19937);
 		engine::UniverseGenerator::SetSeed(4487899);
 		engine::SolarSystem solar_system;
 		solar_system.id = 697;
@@ -112,6 +133,7 @@ protected:
 
 	void test_generate_planettype()
 	{
+		engine::UniverseGenerator::SetBackend(engine::UNIVGEN_BACKEND_MT19937);
 		engine::UniverseGenerator::SetSeed(3698598);
 		uint8_t planet_type = engine::UnivGen->generate_planet_type(8891178656);
 		CPPUNIT_ASSERT(planet_type == 4);
@@ -119,6 +141,7 @@ protected:
 
 	void test_generate_planetdistance()
 	{
+		engine::UniverseGenerator::SetBackend(engine::UNIVGEN_BACKEND_MT19937);
 		engine::UniverseGenerator::SetSeed(5578824136);
 		engine::SolarSystem solar_system;
 		solar_system.radius = 1000 * 1000.0f * 1000.0f;
@@ -130,6 +153,86 @@ protected:
 		ss << planet_distance;
 		CPPUNIT_ASSERT(ss.str() == "7.05024e+08");
 	}
+
+	void test_generate_solarsystem_name()
+	{
+		engine::UniverseGenerator::SetSeed(7841236);
+		// Names only depend on the seed and the id, not on the call order
+		std::string name = engine::UnivGen->generate_solarsystem_name(4521);
+		engine::UnivGen->generate_solarsystem_name(4522);
+		CPPUNIT_ASSERT(name.length() > 3);
+		CPPUNIT_ASSERT(name == engine::UnivGen->generate_solarsystem_name(4521));
+	}
+
+	void test_generate_solarsystem_galaxypos()
+	{
+		engine::UniverseGenerator::SetSeed(7841236);
+		engine::GalaxyShape shape;
+		double x1, y1, z1, x2, y2, z2;
+		engine::UnivGen->generate_solarsystem_galaxypos(4521, shape, x1, y1, z1);
+		engine::UnivGen->generate_solarsystem_galaxypos(4522, shape, x2, y2, z2);
+		CPPUNIT_ASSERT(x1 != x2 || y1 != y2 || z1 != z2);
+
+		engine::UnivGen->generate_solarsystem_galaxypos(4521, shape, x2, y2, z2);
+		CPPUNIT_ASSERT(x1 == x2 && y1 == y2 && z1 == z2);
+	}
+
+	void test_counter_random()
+	{
+		CPPUNIT_ASSERT(counter_random(180, 5, 2, 0) == counter_random(180, 5, 2, 0));
+		CPPUNIT_ASSERT(counter_random(180, 5, 2, 0) != counter_random(180, 5, 2, 1));
+		CPPUNIT_ASSERT(counter_random(180, 5, 2, 0) != counter_random(180, 6, 2, 0));
+		CPPUNIT_ASSERT(counter_random(180, 5, 2, 0) != counter_random(180, 5, 3, 0));
+		CPPUNIT_ASSERT(counter_random(180, 5, 2, 0) != counter_random(181, 5, 2, 0));
+
+		// Uniform draws should be centered on 0.5
+		CounterRandom rnd(180, 5, 2);
+		double sum = 0.0;
+		for (uint32_t i = 0; i < 100000; i++) {
+			double v = rnd.unit();
+			CPPUNIT_ASSERT(v >= 0.0 && v < 1.0);
+			sum += v;
+		}
+		CPPUNIT_ASSERT(std::abs(sum / 100000 - 0.5) < 0.01);
+	}
+
+	void test_counter_backend_ranges()
+	{
+		engine::UniverseGenerator::SetSeed(44887799);
+		for (uint64_t id = 1; id < 10000; id++) {
+			double radius = engine::UnivGen->generate_solarsystem_radius(id);
+			CPPUNIT_ASSERT(radius >= 10 * 1000.0f * 1000.0f * 1000.0f);
+			CPPUNIT_ASSERT(radius < 20.0f * 1000.0f * 1000.0f * 1000.0f * 1000.0f);
+			CPPUNIT_ASSERT(engine::UnivGen->generate_solarsystem_type(id) < engine::SOLAR_TYPE_MAX);
+			CPPUNIT_ASSERT(engine::UnivGen->generate_planet_type(id) < engine::PLANET_TYPE_MAX);
+		}
+
+		CPPUNIT_ASSERT(engine::UnivGen->generate_solarsystem_radius(5448855) ==
+			engine::UnivGen->generate_solarsystem_radius(5448855));
+	}
+
+	void test_mt19937_streams()
+	{
+		// Streams of a seed are independent, the high bits of the seed are kept
+		const uint64_t seed = 7841236;
+		MT19937Random name_rnd(seed, 1), pos_rnd(seed, 2), high_rnd(seed + ((uint64_t) 1 << 36), 1);
+		const double name_draw = name_rnd.uniform_real<double>(0.0, 1.0);
+		CPPUNIT_ASSERT(name_draw != pos_rnd.uniform_real<double>(0.0, 1.0));
+		CPPUNIT_ASSERT(name_draw != high_rnd.uniform_real<double>(0.0, 1.0));
+
+		// Names of an id don't come from the same draws
+		engine::UniverseGenerator::SetBackend(engine::UNIVGEN_BACKEND_MT19937);
+		engine::UniverseGenerator::SetSeed(seed);
+		uint32_t same_names = 0;
+		for (uint64_t id = 1; id <= 1000; id++) {
+			const std::string ss_name = engine::UnivGen->generate_solarsystem_name(id);
+			if (ss_name == engine::UnivGen->generate_galaxy_name(id) &&
+				ss_name == engine::UnivGen->generate_planet_name(id)) {
+				same_names++;
+			}
+		}
+		CPPUNIT_ASSERT(same_names < 10);
+	}
 };
 
 }
@@ -0,0 +1,223 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../common/jobsystem.h"
+
+namespace spacel {
+namespace unittests {
+
+class JobSystemUnitTest : public CppUnit::TestFixture {
+private:
+public:
+	JobSystemUnitTest() {}
+	virtual ~JobSystemUnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("JobSystem");
+		suiteOfTests->addTest(new CppUnit::TestCaller<JobSystemUnitTest>("Test1 - Run jobs.",
+				&JobSystemUnitTest::test_run_jobs));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<JobSystemUnitTest>("Test2 - Nested waits.",
+				&JobSystemUnitTest::test_nested_waits));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<JobSystemUnitTest>("Test3 - Work stealing.",
+				&JobSystemUnitTest::test_work_stealing));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<JobSystemUnitTest>("Test4 - Parallel for.",
+				&JobSystemUnitTest::test_parallel_for));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<JobSystemUnitTest>("Test5 - Task graph.",
+				&JobSystemUnitTest::test_task_graph));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<JobSystemUnitTest>("Test6 - Async results.",
+				&JobSystemUnitTest::test_async));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp() {}
+
+	/// Teardown method
+	void tearDown() {}
+
+protected:
+	void test_run_jobs()
+	{
+		JobSystem jobs(3);
+		CPPUNIT_ASSERT(jobs.GetWorkerCount() == 3);
+
+		std::atomic<uint32_t> sum(0);
+		JobCounter counter;
+		CPPUNIT_ASSERT(counter.IsDone());
+		for (uint32_t i = 1; i <= 1000; i++) {
+			jobs.Submit([&sum, i] { sum += i; }, &counter);
+		}
+
+		jobs.Wait(counter);
+		CPPUNIT_ASSERT(counter.IsDone());
+		CPPUNIT_ASSERT(sum == 500500);
+		CPPUNIT_ASSERT(jobs.GetExecutedCount() == 1000);
+	}
+
+	// Sum of [begin, end), split in two jobs until ranges are small
+	static uint64_t parallel_sum(JobSystem &jobs, const uint64_t begin, const uint64_t end)
+	{
+		if (end - begin <= 64) {
+			uint64_t sum = 0;
+			for (uint64_t i = begin; i < end; i++) {
+				sum += i;
+			}
+			return sum;
+		}
+
+		const uint64_t middle = begin + (end - begin) / 2;
+		uint64_t left = 0;
+		JobCounter counter;
+		jobs.Submit([&jobs, &left, begin, middle] {
+			left = parallel_sum(jobs, begin, middle);
+		}, &counter);
+
+		const uint64_t right = parallel_sum(jobs, middle, end);
+		jobs.Wait(counter);
+		return left + right;
+	}
+
+	void test_nested_waits()
+	{
+		// Every job waits for its children, waiting workers keep running jobs
+		JobSystem jobs(2);
+		CPPUNIT_ASSERT(parallel_sum(jobs, 0, 100000) == 4999950000ULL);
+	}
+
+	void test_work_stealing()
+	{
+		JobSystem jobs(3);
+		std::atomic<uint32_t> done(0);
+		JobCounter counter;
+
+		// Children are queued on the worker running the parent, the others steal them
+		jobs.Submit([&jobs, &done] {
+			JobCounter children;
+			for (uint32_t i = 0; i < 64; i++) {
+				jobs.Submit([&done] {
+					std::this_thread::sleep_for(std::chrono::microseconds(500));
+					done++;
+				}, &children);
+			}
+			jobs.Wait(children);
+		}, &counter);
+
+		jobs.Wait(counter);
+		CPPUNIT_ASSERT(done == 64);
+		CPPUNIT_ASSERT(jobs.GetStolenCount() > 0);
+	}
+
+	void test_parallel_for()
+	{
+		JobSystem jobs(3);
+		std::vector<uint32_t> visits(10000, 0);
+		std::atomic<uint32_t> ranges(0);
+		jobs.ParallelFor(0, visits.size(), 1000, [&] (uint64_t begin, uint64_t end) {
+			CPPUNIT_ASSERT(end - begin <= 1000);
+			for (uint64_t i = begin; i < end; i++) {
+				visits[i]++;
+			}
+			ranges++;
+		});
+
+		CPPUNIT_ASSERT(ranges == 10);
+		CPPUNIT_ASSERT(std::count(visits.begin(), visits.end(), 1) == 10000);
+
+		// Empty ranges don't call fn
+		jobs.ParallelFor(5, 5, 1, [&] (uint64_t, uint64_t) { ranges++; });
+		CPPUNIT_ASSERT(ranges == 10);
+	}
+
+	void test_task_graph()
+	{
+		JobSystem jobs(3);
+		std::mutex order_mutex;
+		std::vector<uint32_t> order;
+		auto record = [&] (uint32_t task) {
+			return [&, task] {
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+				std::lock_guard<std::mutex> lock(order_mutex);
+				order.push_back(task);
+			};
+		};
+
+		// 0 and 1 are independent, 2 needs both, 3 needs 2
+		TaskGraph graph;
+		const TaskGraph::TaskId a = graph.AddTask(record(0));
+		const TaskGraph::TaskId b = graph.AddTask(record(1));
+		const TaskGraph::TaskId c = graph.AddTask(record(2), { a, b });
+		graph.AddTask(record(3), { c });
+		CPPUNIT_ASSERT(graph.size() == 4);
+
+		graph.Run(jobs);
+		CPPUNIT_ASSERT(order.size() == 4);
+		CPPUNIT_ASSERT(order[2] == 2);
+		CPPUNIT_ASSERT(order[3] == 3);
+	}
+
+	void test_async()
+	{
+		JobSystem jobs(2);
+		std::future<uint64_t> sum = jobs.Async([] {
+			uint64_t sum = 0;
+			for (uint64_t i = 0; i < 1000; i++) {
+				sum += i;
+			}
+			return sum;
+		});
+		CPPUNIT_ASSERT(sum.get() == 499500);
+
+		// Callbacks only run when the owning thread drains the queue
+		CallbackQueue queue;
+		std::atomic<bool> posted(false);
+		uint32_t result = 0;
+		async_then(jobs, [&posted] { posted = true; return 42u; }, queue,
+			[&result] (uint32_t value) { result = value; });
+
+		while (!posted || queue.RunPending() == 0) {
+			std::this_thread::yield();
+		}
+		CPPUNIT_ASSERT(result == 42);
+	}
+};
+
+}
+}
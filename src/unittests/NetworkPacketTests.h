@@ -0,0 +1,144 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include "../common/engine/network/networkprotocol.h"
+
+namespace spacel {
+namespace unittests {
+
+class NetworkPacketUnitTest : public CppUnit::TestFixture {
+private:
+public:
+	NetworkPacketUnitTest() {}
+	virtual ~NetworkPacketUnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("NetworkPacket");
+		suiteOfTests->addTest(new CppUnit::TestCaller<NetworkPacketUnitTest>("Test1 - Typed round trip.",
+				&NetworkPacketUnitTest::test_round_trip));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<NetworkPacketUnitTest>("Test2 - Truncated reads.",
+				&NetworkPacketUnitTest::test_truncated));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<NetworkPacketUnitTest>("Test3 - Buffer growth.",
+				&NetworkPacketUnitTest::test_growth));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp() {}
+
+	/// Teardown method
+	void tearDown() {}
+
+protected:
+	void test_round_trip()
+	{
+		engine::network::NetworkPacket packet(engine::network::SMSG_CHAT);
+		const uint32_t initial_capacity = packet.GetCapacity();
+		for (uint32_t i = 0; i < 1000; i++) {
+			packet.WriteUByte(i % 256);
+			packet.WriteShort(-(int16_t)i);
+			packet.WriteUInt64(i * 1000000007ULL);
+			packet.WriteDouble(i * 0.25);
+			packet.WriteString("system");
+		}
+
+		CPPUNIT_ASSERT(packet.GetSize() == 2 + 1000 * (1 + 2 + 8 + 8 + 7));
+		CPPUNIT_ASSERT(packet.GetCapacity() > initial_capacity);
+
+		packet.Seek(0);
+		CPPUNIT_ASSERT(packet.ReadUShort() == engine::network::SMSG_CHAT);
+		for (uint32_t i = 0; i < 1000; i++) {
+			CPPUNIT_ASSERT(packet.ReadUByte() == i % 256);
+			CPPUNIT_ASSERT(packet.ReadShort() == -(int16_t)i);
+			CPPUNIT_ASSERT(packet.ReadUInt64() == i * 1000000007ULL);
+			CPPUNIT_ASSERT(packet.ReadDouble() == i * 0.25);
+			CPPUNIT_ASSERT(packet.ReadString() == "system");
+		}
+		CPPUNIT_ASSERT(packet.IsEof());
+
+		// Overwriting in the middle doesn't change the size
+		packet.Seek(2);
+		packet.WriteUInt(0xDEADBEEF);
+		CPPUNIT_ASSERT(packet.GetSize() == 2 + 1000 * (1 + 2 + 8 + 8 + 7));
+		packet.Seek(2);
+		CPPUNIT_ASSERT(packet.ReadUInt() == 0xDEADBEEF);
+	}
+
+	void test_truncated()
+	{
+		engine::network::NetworkPacket packet(engine::network::SMSG_CHAT);
+		packet.WriteUShort(0x1234);
+		packet.Seek(2);
+
+		// Only the remaining bytes are read, the others stay zeroed
+		const uint64_t value = packet.ReadUInt64();
+		CPPUNIT_ASSERT(value == 0x1234);
+		CPPUNIT_ASSERT(packet.IsEof());
+		CPPUNIT_ASSERT(packet.ReadUInt() == 0);
+		CPPUNIT_ASSERT(packet.GetPosition() == 4);
+
+		char data[4];
+		CPPUNIT_ASSERT(packet.Read(data, 4) == 0);
+		CPPUNIT_ASSERT(packet.Write(data, 0) == 0);
+	}
+
+	void test_growth()
+	{
+		engine::network::NetworkPacket packet(engine::network::SMSG_CHAT);
+		uint32_t reallocations = 0;
+		unsigned capacity = packet.GetCapacity();
+		for (uint32_t i = 0; i < 100000; i++) {
+			packet.WriteUByte(i % 256);
+			if (packet.GetCapacity() != capacity) {
+				capacity = packet.GetCapacity();
+				reallocations++;
+			}
+		}
+
+		// Byte by byte writes don't reallocate on each write
+		CPPUNIT_ASSERT(reallocations <= 20);
+		CPPUNIT_ASSERT(packet.GetSize() == 2 + 100000);
+
+		packet.Seek(2);
+		for (uint32_t i = 0; i < 100000; i++) {
+			CPPUNIT_ASSERT(packet.ReadUByte() == i % 256);
+		}
+
+		// Reset keeps the memory
+		packet.Reset(engine::network::SMSG_HELLO);
+		CPPUNIT_ASSERT(packet.GetSize() == 2);
+		CPPUNIT_ASSERT(packet.GetCapacity() == capacity);
+	}
+};
+
+}
+}
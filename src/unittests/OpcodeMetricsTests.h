@@ -0,0 +1,140 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include <sstream>
+#include "../common/histogram.h"
+#include "../common/engine/network/opcodemetrics.h"
+
+namespace spacel {
+namespace unittests {
+
+using namespace engine::network;
+
+class OpcodeMetricsUnitTest : public CppUnit::TestFixture {
+private:
+public:
+	OpcodeMetricsUnitTest() {}
+	virtual ~OpcodeMetricsUnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("OpcodeMetrics");
+		suiteOfTests->addTest(new CppUnit::TestCaller<OpcodeMetricsUnitTest>(
+				"Test1 - Histogram buckets.", &OpcodeMetricsUnitTest::test_histogram_buckets));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<OpcodeMetricsUnitTest>(
+				"Test2 - Histogram percentiles.",
+				&OpcodeMetricsUnitTest::test_histogram_percentiles));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<OpcodeMetricsUnitTest>(
+				"Test3 - Router report.", &OpcodeMetricsUnitTest::test_router_report));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp() {}
+
+	/// Teardown method
+	void tearDown() {}
+
+protected:
+	void test_histogram_buckets()
+	{
+		// Small values are exact
+		for (uint64_t value = 0; value < 64; value++) {
+			CPPUNIT_ASSERT(Histogram::GetBucketHighestValue(
+				Histogram::GetBucketIndex(value)) == value);
+		}
+
+		// Larger values are within 1/32 of their bucket highest value
+		for (uint64_t value = 64; value < (1ULL << 62); value = value * 3 + 1) {
+			const uint32_t index = Histogram::GetBucketIndex(value);
+			const uint64_t highest = Histogram::GetBucketHighestValue(index);
+			CPPUNIT_ASSERT(index < HISTOGRAM_BUCKETS);
+			CPPUNIT_ASSERT(highest >= value);
+			CPPUNIT_ASSERT(highest - value <= value / HISTOGRAM_SUB_BUCKETS);
+			CPPUNIT_ASSERT(Histogram::GetBucketIndex(highest) == index);
+			CPPUNIT_ASSERT(Histogram::GetBucketIndex(highest + 1) == index + 1);
+		}
+
+		CPPUNIT_ASSERT(Histogram::GetBucketIndex(UINT64_MAX) == HISTOGRAM_BUCKETS - 1);
+	}
+
+	void test_histogram_percentiles()
+	{
+		Histogram histogram;
+		CPPUNIT_ASSERT(histogram.GetPercentile(99) == 0);
+		CPPUNIT_ASSERT(histogram.GetMin() == 0);
+
+		for (uint64_t value = 1; value <= 1000; value++) {
+			histogram.Record(value * 1000);
+		}
+
+		CPPUNIT_ASSERT(histogram.GetCount() == 1000);
+		CPPUNIT_ASSERT(histogram.GetMin() == 1000);
+		CPPUNIT_ASSERT(histogram.GetMax() == 1000000);
+		CPPUNIT_ASSERT(histogram.GetMean() == 500500.0);
+
+		const uint64_t p50 = histogram.GetPercentile(50);
+		CPPUNIT_ASSERT(p50 >= 500000 && p50 <= 500000 + 500000 / 32);
+		const uint64_t p99 = histogram.GetPercentile(99);
+		CPPUNIT_ASSERT(p99 >= 990000 && p99 <= 990000 + 990000 / 32);
+		CPPUNIT_ASSERT(histogram.GetPercentile(100) == 1000000);
+
+		histogram.Reset();
+		CPPUNIT_ASSERT(histogram.GetCount() == 0);
+		CPPUNIT_ASSERT(histogram.GetMax() == 0);
+	}
+
+	void test_router_report()
+	{
+		PacketRouterMetrics metrics;
+		for (uint32_t i = 0; i < 10; i++) {
+			metrics.Record(CMSG_HELLO, "CMSG_HELLO", 7, 1000);
+		}
+		metrics.Record(CMSG_PLAYER_POSITION, "CMSG_PLAYER_POSITION", 26, 50000);
+
+		CPPUNIT_ASSERT(metrics.Get(CMSG_HELLO).latency.GetCount() == 10);
+		CPPUNIT_ASSERT(metrics.Get(CMSG_HELLO).size.GetTotal() == 70);
+		CPPUNIT_ASSERT(metrics.Get(CMSG_AUTH).latency.GetCount() == 0);
+
+		// Opcodes are sorted by handler time, unused ones are not reported
+		std::ostringstream report;
+		metrics.WriteReport(report);
+		const std::string text = report.str();
+		CPPUNIT_ASSERT(text.find("CMSG_PLAYER_POSITION") < text.find("CMSG_HELLO"));
+		CPPUNIT_ASSERT(text.find("CMSG_AUTH") == std::string::npos);
+
+		metrics.Reset();
+		CPPUNIT_ASSERT(metrics.Get(CMSG_HELLO).latency.GetCount() == 0);
+	}
+};
+
+}
+}
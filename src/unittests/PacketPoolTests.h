@@ -0,0 +1,118 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include "../common/engine/network/networkprotocol.h"
+#include "../common/engine/network/packetpool.h"
+
+namespace spacel {
+namespace unittests {
+
+class PacketPoolUnitTest : public CppUnit::TestFixture {
+private:
+public:
+	PacketPoolUnitTest() {}
+	virtual ~PacketPoolUnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("PacketPool");
+		suiteOfTests->addTest(new CppUnit::TestCaller<PacketPoolUnitTest>("Test1 - Reuse packets.",
+				&PacketPoolUnitTest::test_reuse));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<PacketPoolUnitTest>("Test2 - Opcode size hints.",
+				&PacketPoolUnitTest::test_size_hints));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp() {}
+
+	/// Teardown method
+	void tearDown() {}
+
+protected:
+	void test_reuse()
+	{
+		engine::network::PacketPool pool;
+		engine::network::NetworkPacket *packet = pool.Acquire(engine::network::SMSG_CHAT, 100);
+		CPPUNIT_ASSERT(packet->GetCapacity() >= 256);
+		CPPUNIT_ASSERT(packet->GetOpcode() == engine::network::SMSG_CHAT);
+		packet->SetSessionId(12);
+		packet->WriteUInt(42);
+		pool.Release(packet);
+
+		// The same packet comes back empty
+		engine::network::NetworkPacket *reused = pool.Acquire(engine::network::SMSG_KICK, 200);
+		CPPUNIT_ASSERT(reused == packet);
+		CPPUNIT_ASSERT(pool.GetAllocatedCount() == 1 && pool.GetReusedCount() == 1);
+		CPPUNIT_ASSERT(reused->GetSize() == 2);
+		CPPUNIT_ASSERT(reused->GetSessionId() == 0);
+		CPPUNIT_ASSERT(reused->GetOpcode() == engine::network::SMSG_KICK);
+		reused->Seek(2);
+		CPPUNIT_ASSERT(reused->IsEof());
+
+		// Other size classes don't share packets
+		engine::network::NetworkPacket *big = pool.Acquire(engine::network::SMSG_KICK, 5000);
+		CPPUNIT_ASSERT(big != reused);
+		CPPUNIT_ASSERT(big->GetCapacity() >= 5000);
+		pool.Release(reused);
+		pool.Release(big);
+		CPPUNIT_ASSERT(pool.Acquire(engine::network::SMSG_KICK, 5000) == big);
+		pool.Release(big);
+	}
+
+	void test_size_hints()
+	{
+		engine::network::PacketPool pool;
+		CPPUNIT_ASSERT(pool.GetSizeHint(engine::network::SMSG_GALAXY_SYSTEMS) ==
+			PACKET_POOL_MIN_BUFFER_SIZE);
+
+		engine::network::NetworkPacket *packet =
+			pool.Acquire(engine::network::SMSG_GALAXY_SYSTEMS);
+		for (uint32_t i = 0; i < 1000; i++) {
+			packet->WriteUInt(i);
+		}
+		pool.Release(packet);
+
+		// Next packets of this opcode are big enough from the start
+		CPPUNIT_ASSERT(pool.GetSizeHint(engine::network::SMSG_GALAXY_SYSTEMS) == 4002);
+		packet = pool.Acquire(engine::network::SMSG_GALAXY_SYSTEMS);
+		CPPUNIT_ASSERT(packet->GetCapacity() >= 4002);
+		pool.Release(packet);
+
+		// Small packets slowly lower the hint
+		packet = pool.Acquire(engine::network::SMSG_GALAXY_SYSTEMS);
+		pool.Release(packet);
+		CPPUNIT_ASSERT(pool.GetSizeHint(engine::network::SMSG_GALAXY_SYSTEMS) < 4002);
+		CPPUNIT_ASSERT(pool.GetSizeHint(engine::network::SMSG_GALAXY_SYSTEMS) > 2000);
+	}
+};
+
+}
+}
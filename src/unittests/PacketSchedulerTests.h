@@ -0,0 +1,157 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include <memory>
+#include "../common/engine/network/networkprotocol.h"
+#include "../common/engine/network/packetscheduler.h"
+
+namespace spacel {
+namespace unittests {
+
+class PacketSchedulerUnitTest : public CppUnit::TestFixture {
+private:
+public:
+	PacketSchedulerUnitTest() {}
+	virtual ~PacketSchedulerUnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("PacketScheduler");
+		suiteOfTests->addTest(new CppUnit::TestCaller<PacketSchedulerUnitTest>("Test1 - Round-robin sessions.",
+				&PacketSchedulerUnitTest::test_round_robin));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<PacketSchedulerUnitTest>("Test2 - Remove session.",
+				&PacketSchedulerUnitTest::test_remove_session));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<PacketSchedulerUnitTest>("Test3 - Session packet limit.",
+				&PacketSchedulerUnitTest::test_session_limit));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp() {}
+
+	/// Teardown method
+	void tearDown() {}
+
+protected:
+	static engine::network::NetworkPacket *create_packet(const uint32_t session_id,
+		const uint32_t sequence)
+	{
+		engine::network::NetworkPacket *packet =
+			new engine::network::NetworkPacket(engine::network::CMSG_CHAT);
+		packet->SetSessionId(session_id);
+		packet->WriteUInt(sequence);
+		return packet;
+	}
+
+	void test_round_robin()
+	{
+		engine::network::PacketScheduler scheduler;
+		CPPUNIT_ASSERT(scheduler.Pop() == nullptr);
+
+		// Session 1 floods the server, session 2 sends a few packets
+		for (uint32_t i = 0; i < 100; i++) {
+			scheduler.Push(create_packet(1, i));
+		}
+
+		for (uint32_t i = 0; i < 3; i++) {
+			scheduler.Push(create_packet(2, i));
+		}
+
+		CPPUNIT_ASSERT(scheduler.GetPendingCount() == 103);
+		CPPUNIT_ASSERT(scheduler.GetSessionCount() == 2);
+
+		uint32_t next_sequences[3] = { 0, 0, 0 };
+		for (uint32_t i = 0; i < 103; i++) {
+			std::unique_ptr<engine::network::NetworkPacket> packet(scheduler.Pop());
+			CPPUNIT_ASSERT(packet);
+
+			// Sessions alternate while both have packets
+			const uint32_t session_id = packet->GetSessionId();
+			if (i < 6) {
+				CPPUNIT_ASSERT(session_id == i % 2 + 1);
+			} else {
+				CPPUNIT_ASSERT(session_id == 1);
+			}
+
+			packet->Seek(2);
+			CPPUNIT_ASSERT(packet->ReadUInt() == next_sequences[session_id]++);
+		}
+
+		CPPUNIT_ASSERT(scheduler.Pop() == nullptr);
+		CPPUNIT_ASSERT(scheduler.GetPendingCount() == 0);
+		CPPUNIT_ASSERT(scheduler.GetSessionCount() == 0);
+	}
+
+	void test_remove_session()
+	{
+		engine::network::PacketScheduler scheduler;
+		for (uint32_t i = 0; i < 10; i++) {
+			scheduler.Push(create_packet(i % 3, i));
+		}
+
+		scheduler.RemoveSession(1);
+		scheduler.RemoveSession(7);
+		CPPUNIT_ASSERT(scheduler.GetPendingCount() == 7);
+		CPPUNIT_ASSERT(scheduler.GetSessionCount() == 2);
+
+		while (engine::network::NetworkPacket *packet = scheduler.Pop()) {
+			CPPUNIT_ASSERT(packet->GetSessionId() != 1);
+			delete packet;
+		}
+
+		// Remaining packets are released by the scheduler
+		scheduler.Push(create_packet(4, 0));
+	}
+
+	void test_session_limit()
+	{
+		engine::network::PacketScheduler scheduler(10);
+
+		// Session 1 floods the server, only its first packets are kept
+		for (uint32_t i = 0; i < 100; i++) {
+			CPPUNIT_ASSERT(scheduler.Push(create_packet(1, i)) == (i < 10));
+		}
+
+		CPPUNIT_ASSERT(scheduler.Push(create_packet(2, 0)));
+		CPPUNIT_ASSERT(scheduler.GetPendingCount() == 11);
+		CPPUNIT_ASSERT(scheduler.GetDroppedCount() == 90);
+
+		// Processing packets makes room for the session again
+		std::unique_ptr<engine::network::NetworkPacket> packet(scheduler.Pop());
+		CPPUNIT_ASSERT(packet->GetSessionId() == 1);
+		CPPUNIT_ASSERT(scheduler.Push(create_packet(1, 100)));
+		CPPUNIT_ASSERT(!scheduler.Push(create_packet(1, 101)));
+		CPPUNIT_ASSERT(scheduler.GetDroppedCount() == 91);
+	}
+};
+
+}
+}
@@ -0,0 +1,172 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <json/json.h>
+#include "../common/profiler.h"
+
+namespace spacel {
+namespace unittests {
+
+class ProfilerUnitTest : public CppUnit::TestFixture {
+private:
+public:
+	ProfilerUnitTest() {}
+	virtual ~ProfilerUnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("Profiler");
+		suiteOfTests->addTest(new CppUnit::TestCaller<ProfilerUnitTest>("Test1 - Stats.",
+				&ProfilerUnitTest::test_stats));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<ProfilerUnitTest>("Test2 - Ring buffer.",
+				&ProfilerUnitTest::test_ring_buffer));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<ProfilerUnitTest>("Test3 - Chrome trace.",
+				&ProfilerUnitTest::test_chrome_trace));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<ProfilerUnitTest>("Test4 - Threads.",
+				&ProfilerUnitTest::test_threads));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp() {}
+
+	/// Teardown method
+	void tearDown() {}
+
+protected:
+	void test_stats()
+	{
+		Profiler profiler;
+		// 99 fast scopes and a slow one
+		for (uint64_t i = 0; i < 99; i++) {
+			profiler.RecordScope("tick", 1000 * i, 1000 * i + 1000);
+		}
+		profiler.RecordScope("tick", 0, 1000000);
+		profiler.RecordCounter("queue_depth", 3);
+		profiler.RecordCounter("queue_depth", 5);
+
+		const std::map<std::string, ProfileStats> stats = profiler.GetStats();
+		CPPUNIT_ASSERT(stats.size() == 2);
+
+		const ProfileStats &tick = stats.at("tick");
+		CPPUNIT_ASSERT(tick.type == PROFILE_EVENT_SCOPE);
+		CPPUNIT_ASSERT(tick.count == 100);
+		CPPUNIT_ASSERT(tick.min == 1000);
+		CPPUNIT_ASSERT(tick.max == 1000000);
+		// Percentiles are bucket upper bounds, 1000 is in [512, 1024)
+		CPPUNIT_ASSERT(tick.GetPercentile(50) == 1023);
+		CPPUNIT_ASSERT(tick.GetPercentile(99) == 1023);
+		CPPUNIT_ASSERT(tick.GetPercentile(100) == 1000000);
+
+		const ProfileStats &depth = stats.at("queue_depth");
+		CPPUNIT_ASSERT(depth.type == PROFILE_EVENT_COUNTER);
+		CPPUNIT_ASSERT(depth.count == 2);
+		CPPUNIT_ASSERT(depth.total == 8);
+
+		// Disabled profilers don't record
+		profiler.SetEnabled(false);
+		{
+			PROFILE_SCOPE(profiler, "tick");
+		}
+		CPPUNIT_ASSERT(profiler.GetRecordedCount() == 102);
+	}
+
+	void test_ring_buffer()
+	{
+		Profiler profiler;
+		for (uint64_t i = 0; i < PROFILER_EVENT_CAPACITY + 100; i++) {
+			profiler.RecordCounter(i < 100 ? "old" : "new", i);
+		}
+
+		// The oldest events are overwritten
+		const std::map<std::string, ProfileStats> stats = profiler.GetStats();
+		CPPUNIT_ASSERT(stats.find("old") == stats.end());
+		CPPUNIT_ASSERT(stats.at("new").count == PROFILER_EVENT_CAPACITY);
+		CPPUNIT_ASSERT(profiler.GetRecordedCount() == PROFILER_EVENT_CAPACITY + 100);
+	}
+
+	void test_chrome_trace()
+	{
+		Profiler profiler;
+		{
+			PROFILE_SCOPE(profiler, "server_step");
+			profiler.RecordCounter("pending_packets", 42);
+		}
+
+		std::stringstream trace;
+		profiler.WriteChromeTrace(trace);
+		Json::Value root;
+		trace >> root;
+
+		const Json::Value &events = root["traceEvents"];
+		CPPUNIT_ASSERT(events.size() == 2);
+		CPPUNIT_ASSERT(events[0]["name"].asString() == "pending_packets");
+		CPPUNIT_ASSERT(events[0]["ph"].asString() == "C");
+		CPPUNIT_ASSERT(events[0]["args"]["value"].asUInt64() == 42);
+		CPPUNIT_ASSERT(events[1]["name"].asString() == "server_step");
+		CPPUNIT_ASSERT(events[1]["ph"].asString() == "X");
+		CPPUNIT_ASSERT(events[1]["ts"].asDouble() <= events[0]["ts"].asDouble());
+		CPPUNIT_ASSERT(events[1]["dur"].isDouble());
+	}
+
+	void test_threads()
+	{
+		Profiler profiler;
+		std::vector<std::thread> threads;
+		for (uint32_t t = 0; t < 4; t++) {
+			threads.emplace_back([&profiler] {
+				for (uint32_t i = 0; i < 10000; i++) {
+					PROFILE_SCOPE(profiler, "job");
+				}
+			});
+		}
+
+		// Dumping while recording only skips the events being written
+		for (uint32_t i = 0; i < 10; i++) {
+			std::stringstream stats;
+			profiler.WriteStats(stats);
+		}
+
+		for (auto &thread: threads) {
+			thread.join();
+		}
+
+		CPPUNIT_ASSERT(profiler.GetRecordedCount() == 40000);
+		CPPUNIT_ASSERT(profiler.GetStats().at("job").count == 40000);
+	}
+};
+
+}
+}
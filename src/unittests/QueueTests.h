@@ -0,0 +1,156 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include <thread>
+#include <vector>
+#include "../common/threadsafe_utils.h"
+
+namespace spacel {
+namespace unittests {
+
+class QueueUnitTest : public CppUnit::TestFixture {
+private:
+public:
+	QueueUnitTest() {}
+	virtual ~QueueUnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("Queue");
+		suiteOfTests->addTest(new CppUnit::TestCaller<QueueUnitTest>("Test1 - SPSC bounds.",
+				&QueueUnitTest::test_spsc_bounds));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<QueueUnitTest>("Test2 - SPSC threads.",
+				&QueueUnitTest::test_spsc_threads));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<QueueUnitTest>("Test3 - MPSC bounds.",
+				&QueueUnitTest::test_mpsc_bounds));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<QueueUnitTest>("Test4 - MPSC threads.",
+				&QueueUnitTest::test_mpsc_threads));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp() {}
+
+	/// Teardown method
+	void tearDown() {}
+
+protected:
+	template <typename Queue>
+	void check_bounds(Queue &queue)
+	{
+		CPPUNIT_ASSERT(queue.empty());
+		CPPUNIT_ASSERT(queue.pop_front() == 0);
+
+		// Several laps to wrap around the ring
+		uint32_t next_push = 1, next_pop = 1;
+		for (uint32_t lap = 0; lap < 3; lap++) {
+			while (queue.try_push(next_push)) {
+				next_push++;
+			}
+			CPPUNIT_ASSERT(queue.size() == 8);
+
+			uint32_t values[5];
+			CPPUNIT_ASSERT(queue.pop_front(values, 5) == 5);
+			for (const uint32_t value: values) {
+				CPPUNIT_ASSERT(value == next_pop++);
+			}
+
+			CPPUNIT_ASSERT(queue.pop_front() == next_pop++);
+			CPPUNIT_ASSERT(queue.size() == 2);
+			CPPUNIT_ASSERT(queue.pop_front(values, 5) == 2);
+			CPPUNIT_ASSERT(values[0] == next_pop++ && values[1] == next_pop++);
+			CPPUNIT_ASSERT(queue.empty());
+		}
+	}
+
+	template <typename Queue>
+	void check_threads(Queue &queue, const uint32_t producer_count)
+	{
+		static const uint32_t VALUES_PER_PRODUCER = 100000;
+		std::vector<std::thread> producers;
+		for (uint32_t producer = 0; producer < producer_count; producer++) {
+			producers.emplace_back([&queue, producer] {
+				for (uint32_t i = 0; i < VALUES_PER_PRODUCER; i++) {
+					queue.push_back(((uint64_t) producer << 32) | i);
+				}
+			});
+		}
+
+		// Values of each producer are received in order
+		std::vector<uint32_t> next_values(producer_count, 0);
+		uint64_t received = 0;
+		while (received < (uint64_t) producer_count * VALUES_PER_PRODUCER) {
+			uint64_t values[32];
+			const size_t count = queue.pop_front(values, 32);
+			for (size_t i = 0; i < count; i++) {
+				const uint32_t producer = values[i] >> 32;
+				CPPUNIT_ASSERT(producer < producer_count);
+				CPPUNIT_ASSERT((uint32_t) values[i] == next_values[producer]);
+				next_values[producer]++;
+			}
+			received += count;
+		}
+
+		for (auto &producer: producers) {
+			producer.join();
+		}
+
+		CPPUNIT_ASSERT(queue.empty());
+	}
+
+	void test_spsc_bounds()
+	{
+		SPSCQueue<uint32_t, 8> queue;
+		check_bounds(queue);
+	}
+
+	void test_spsc_threads()
+	{
+		SPSCQueue<uint64_t, 256> queue;
+		check_threads(queue, 1);
+	}
+
+	void test_mpsc_bounds()
+	{
+		MPSCQueue<uint32_t, 8> queue;
+		check_bounds(queue);
+	}
+
+	void test_mpsc_threads()
+	{
+		MPSCQueue<uint64_t, 256> queue;
+		check_threads(queue, 4);
+	}
+};
+
+}
+}
@@ -0,0 +1,200 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "../common/jobsystem.h"
+#include "../common/engine/galaxyinterest.h"
+#include "../common/engine/generators.h"
+#include "../common/engine/shard.h"
+#include "../common/engine/space.h"
+#include "../common/engine/network/localmessages.h"
+#include "../common/engine/network/networkprotocol.h"
+
+namespace spacel {
+namespace unittests {
+
+class ShardUnitTest : public CppUnit::TestFixture {
+private:
+public:
+	ShardUnitTest() {}
+	virtual ~ShardUnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("Shard");
+		suiteOfTests->addTest(new CppUnit::TestCaller<ShardUnitTest>("Test1 - Galaxy sectors.",
+				&ShardUnitTest::test_sectors));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<ShardUnitTest>("Test2 - Session hand over.",
+				&ShardUnitTest::test_hand_over));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<ShardUnitTest>("Test3 - Parallel ticks.",
+				&ShardUnitTest::test_parallel_ticks));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<ShardUnitTest>("Test4 - Session removal.",
+				&ShardUnitTest::test_remove_session));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp()
+	{
+		engine::UniverseGenerator::SetSeed(180);
+		m_galaxy = m_universe.CreateGalaxy(5000);
+	}
+
+	/// Teardown method
+	void tearDown() {}
+
+protected:
+	std::unique_ptr<engine::GalaxyInterest> new_interest()
+	{
+		std::unique_ptr<engine::GalaxyInterest> interest(
+			new engine::GalaxyInterest(m_galaxy, 0.3, false));
+		interest->SetLocalMessages(true);
+		return interest;
+	}
+
+	// Tick until nothing is streamed, returns the solar systems added for each session
+	static std::unordered_map<uint32_t, size_t> stream(engine::ShardSet &shards)
+	{
+		std::unordered_map<uint32_t, size_t> received;
+		std::vector<engine::network::NetworkPacket *> packets;
+		do {
+			packets.clear();
+			shards.Tick(1024, packets);
+			for (engine::network::NetworkPacket *packet: packets) {
+				if (const engine::network::GalaxySystemsMessage *message =
+					packet->GetLocalMessage<engine::network::GalaxySystemsMessage>()) {
+					received[packet->GetSessionId()] += message->systems.size();
+				}
+				delete packet;
+			}
+		} while (!packets.empty());
+
+		return received;
+	}
+
+	void test_sectors()
+	{
+		engine::ShardSet shards(m_galaxy, 4);
+		CPPUNIT_ASSERT(shards.GetShardCount() == 4);
+		CPPUNIT_ASSERT(shards.GetShardIndex(-1.0, -0.01) == 0);
+		CPPUNIT_ASSERT(shards.GetShardIndex(0.01, -1.0) == 1);
+		CPPUNIT_ASSERT(shards.GetShardIndex(1.0, 0.01) == 2);
+		CPPUNIT_ASSERT(shards.GetShardIndex(-0.01, 1.0) == 3);
+		CPPUNIT_ASSERT(shards.GetShardIndex(-1.0, 0.0) == 3);
+	}
+
+	void test_hand_over()
+	{
+		engine::ShardSet shards(m_galaxy, 4);
+		shards.AddSession(7, new_interest(), 0.5, 0.01, 0.0);
+		CPPUNIT_ASSERT(stream(shards)[7] > 0);
+		CPPUNIT_ASSERT(shards.GetShard(2).HasSession(7));
+
+		// The old shard hands the session over at the end of the tick
+		shards.SetSessionPosition(7, -0.5, -0.01, 0.0);
+		std::vector<engine::network::NetworkPacket *> packets;
+		shards.Tick(1024, packets);
+		CPPUNIT_ASSERT(packets.empty());
+		CPPUNIT_ASSERT(!shards.GetShard(2).HasSession(7));
+		CPPUNIT_ASSERT(!shards.GetShard(0).HasSession(7));
+
+		// A position sent during the hand over is kept
+		shards.SetSessionPosition(7, -0.5, -0.02, 0.0);
+		CPPUNIT_ASSERT(stream(shards)[7] > 0);
+		CPPUNIT_ASSERT(shards.GetShard(0).HasSession(7));
+		CPPUNIT_ASSERT(shards.GetShard(0).GetSessionCount() == 1);
+
+		// Unknown sessions are ignored
+		shards.SetSessionPosition(8, 0.5, 0.0, 0.0);
+		CPPUNIT_ASSERT(stream(shards).empty());
+	}
+
+	void test_parallel_ticks()
+	{
+		// Same sessions on one serial shard and on 8 shards ticked by 3 workers
+		JobSystem jobs(3);
+		engine::ShardSet serial(m_galaxy, 1), parallel(m_galaxy, 8, &jobs);
+		for (uint32_t session_id = 1; session_id <= 32; session_id++) {
+			const double x = (session_id % 7) * 0.2 - 0.6, y = (session_id % 5) * 0.25 - 0.5;
+			serial.AddSession(session_id, new_interest(), x, y, 0.0);
+			parallel.AddSession(session_id, new_interest(), x, y, 0.0);
+		}
+
+		const std::unordered_map<uint32_t, size_t> serial_received = stream(serial);
+		CPPUNIT_ASSERT(serial_received.size() == 32);
+		CPPUNIT_ASSERT(stream(parallel) == serial_received);
+
+		size_t session_count = 0;
+		for (uint32_t i = 0; i < parallel.GetShardCount(); i++) {
+			session_count += parallel.GetShard(i).GetSessionCount();
+		}
+		CPPUNIT_ASSERT(session_count == 32);
+		CPPUNIT_ASSERT(jobs.GetExecutedCount() > 0);
+	}
+
+	void test_remove_session()
+	{
+		engine::ShardSet shards(m_galaxy, 4);
+		shards.AddSession(7, new_interest(), 0.5, 0.01, 0.0);
+		shards.AddSession(8, new_interest(), 0.5, 0.02, 0.0);
+		CPPUNIT_ASSERT(stream(shards).size() == 2);
+
+		shards.RemoveSession(7);
+		std::vector<engine::network::NetworkPacket *> packets;
+		shards.Tick(1024, packets);
+		CPPUNIT_ASSERT(!shards.GetShard(2).HasSession(7));
+		CPPUNIT_ASSERT(shards.GetShard(2).HasSession(8));
+
+		// Removed while it is handed over, the new shard drops it when it arrives
+		shards.SetSessionPosition(8, -0.5, -0.01, 0.0);
+		shards.RemoveSession(8);
+		shards.SetSessionPosition(8, -0.5, -0.02, 0.0);
+		CPPUNIT_ASSERT(stream(shards).empty());
+		shards.Tick(1024, packets);
+		for (uint32_t i = 0; i < shards.GetShardCount(); i++) {
+			CPPUNIT_ASSERT(shards.GetShard(i).GetSessionCount() == 0);
+		}
+
+		// Unknown sessions are ignored
+		shards.RemoveSession(9);
+		CPPUNIT_ASSERT(stream(shards).empty());
+	}
+
+private:
+	engine::Universe m_universe;
+	engine::Galaxy *m_galaxy = nullptr;
+};
+
+}
+}
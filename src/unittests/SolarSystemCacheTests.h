@@ -0,0 +1,128 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include "../common/engine/solarsystemcache.h"
+#include "../common/engine/space.h"
+#include "TestDatabase.h"
+
+namespace spacel {
+namespace unittests {
+
+class SolarSystemCacheUnitTest : public CppUnit::TestFixture {
+private:
+public:
+	SolarSystemCacheUnitTest() {}
+	virtual ~SolarSystemCacheUnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("SolarSystemCache");
+		suiteOfTests->addTest(new CppUnit::TestCaller<SolarSystemCacheUnitTest>(
+				"Test1 - Cache hits and misses.",
+				&SolarSystemCacheUnitTest::test_hits));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<SolarSystemCacheUnitTest>(
+				"Test2 - LRU eviction.",
+				&SolarSystemCacheUnitTest::test_eviction));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp()
+	{
+		engine::UniverseGenerator::SetSeed(180);
+		m_source = m_universe.CreateGalaxy(100);
+	}
+
+	/// Teardown method
+	void tearDown() {}
+
+protected:
+	void test_hits()
+	{
+		TestDatabase db(m_source);
+		engine::Galaxy galaxy;
+		engine::SolarSystemCache cache(&db, &galaxy, 1024 * 1024);
+
+		const engine::SolarSystemHandle ss_source = m_source->solar_systems[42];
+		// Find doesn't load
+		CPPUNIT_ASSERT(cache.Find(ss_source.GetId()) == nullptr && db.loads == 0);
+		engine::SolarSystem *ss = cache.Get(ss_source.GetId());
+		CPPUNIT_ASSERT(ss);
+		CPPUNIT_ASSERT(ss->id == ss_source.GetId());
+		CPPUNIT_ASSERT(ss->name == ss_source.GetName());
+		CPPUNIT_ASSERT(ss->galaxy == &galaxy);
+
+		CPPUNIT_ASSERT(cache.Get(ss_source.GetId()) == ss);
+		CPPUNIT_ASSERT(db.loads == 1);
+		CPPUNIT_ASSERT(cache.GetHits() == 1 && cache.GetMisses() == 1);
+		CPPUNIT_ASSERT(cache.Find(ss_source.GetId()) == ss && cache.GetHits() == 2);
+
+		// Unknown solar systems are not cached
+		CPPUNIT_ASSERT(cache.Get(1000 * 1000) == nullptr);
+		CPPUNIT_ASSERT(cache.size() == 1);
+	}
+
+	void test_eviction()
+	{
+		TestDatabase db(m_source);
+		engine::Galaxy galaxy;
+
+		// Find the size of a single entry to build a 10 entries budget
+		size_t entry_size;
+		{
+			engine::SolarSystemCache cache(&db, &galaxy, 1024 * 1024);
+			cache.Get(m_source->solar_systems[0].GetId());
+			entry_size = cache.GetMemoryUsage();
+		}
+
+		engine::SolarSystemCache cache(&db, &galaxy, entry_size * 10);
+		for (uint32_t row = 0; row < 10; ++row) {
+			CPPUNIT_ASSERT(cache.Get(m_source->solar_systems[row].GetId()));
+		}
+
+		CPPUNIT_ASSERT(cache.size() == 10);
+
+		// Use the first one, the second one is now the least recently used
+		cache.Get(m_source->solar_systems[0].GetId());
+		cache.Get(m_source->solar_systems[10].GetId());
+
+		CPPUNIT_ASSERT(cache.GetMemoryUsage() <= cache.GetMemoryBudget());
+		CPPUNIT_ASSERT(cache.Contains(m_source->solar_systems[0].GetId()));
+		CPPUNIT_ASSERT(!cache.Contains(m_source->solar_systems[1].GetId()));
+		CPPUNIT_ASSERT(cache.Contains(m_source->solar_systems[10].GetId()));
+	}
+
+private:
+	engine::Universe m_universe;
+	engine::Galaxy *m_source = nullptr;
+};
+
+}
+}
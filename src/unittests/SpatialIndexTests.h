@@ -0,0 +1,201 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include <algorithm>
+#include <limits>
+#include "../common/engine/generators.h"
+#include "../common/engine/space.h"
+
+namespace spacel {
+namespace unittests {
+
+class SpatialIndexUnitTest : public CppUnit::TestFixture {
+private:
+public:
+	SpatialIndexUnitTest() {}
+	virtual ~SpatialIndexUnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("SpatialIndex");
+		suiteOfTests->addTest(new CppUnit::TestCaller<SpatialIndexUnitTest>("Test1 - Radius query.",
+				&SpatialIndexUnitTest::test_radius));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<SpatialIndexUnitTest>("Test2 - Box and frustum queries.",
+				&SpatialIndexUnitTest::test_box_frustum));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<SpatialIndexUnitTest>("Test3 - Nearest query.",
+				&SpatialIndexUnitTest::test_nearest));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<SpatialIndexUnitTest>("Test4 - Index updates.",
+				&SpatialIndexUnitTest::test_updates));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<SpatialIndexUnitTest>("Test5 - Non finite positions.",
+				&SpatialIndexUnitTest::test_non_finite));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp()
+	{
+		engine::UniverseGenerator::SetSeed(180);
+		m_galaxy = m_universe.CreateGalaxy(5000, 4);
+	}
+
+	/// Teardown method
+	void tearDown() {}
+
+protected:
+	void test_radius()
+	{
+		CPPUNIT_ASSERT(m_galaxy->spatial_index.size() == 5000);
+		for (const auto &center: m_galaxy->solar_systems) {
+			if (center.GetRow() % 500 != 0) {
+				continue;
+			}
+
+			std::vector<uint64_t> result;
+			m_galaxy->spatial_index.QueryRadius(center.GetPosX(), center.GetPosY(),
+				center.GetPosZ(), 0.1, result);
+
+			std::vector<uint64_t> expected;
+			for (const auto &ss: m_galaxy->solar_systems) {
+				const double dx = ss.GetPosX() - center.GetPosX(),
+					dy = ss.GetPosY() - center.GetPosY(), dz = ss.GetPosZ() - center.GetPosZ();
+				if (dx * dx + dy * dy + dz * dz <= 0.1 * 0.1) {
+					expected.push_back(ss.GetId());
+				}
+			}
+
+			CPPUNIT_ASSERT(!expected.empty());
+			std::sort(result.begin(), result.end());
+			std::sort(expected.begin(), expected.end());
+			CPPUNIT_ASSERT(result == expected);
+		}
+	}
+
+	void test_box_frustum()
+	{
+		const engine::SpatialBox box = { -0.3, -0.2, -0.02, 0.4, 0.5, 0.03 };
+		std::vector<uint64_t> expected;
+		for (const auto &ss: m_galaxy->solar_systems) {
+			if (ss.GetPosX() >= box.min_x && ss.GetPosX() <= box.max_x &&
+				ss.GetPosY() >= box.min_y && ss.GetPosY() <= box.max_y &&
+				ss.GetPosZ() >= box.min_z && ss.GetPosZ() <= box.max_z) {
+				expected.push_back(ss.GetId());
+			}
+		}
+
+		CPPUNIT_ASSERT(!expected.empty());
+		std::sort(expected.begin(), expected.end());
+
+		std::vector<uint64_t> result;
+		m_galaxy->spatial_index.QueryBox(box, result);
+		std::sort(result.begin(), result.end());
+		CPPUNIT_ASSERT(result == expected);
+
+		// The same box as a frustum
+		const engine::SpatialFrustum frustum = {{
+			{ 1, 0, 0, -box.min_x }, { -1, 0, 0, box.max_x },
+			{ 0, 1, 0, -box.min_y }, { 0, -1, 0, box.max_y },
+			{ 0, 0, 1, -box.min_z }, { 0, 0, -1, box.max_z },
+		}};
+
+		result.clear();
+		m_galaxy->spatial_index.QueryFrustum(frustum, result);
+		std::sort(result.begin(), result.end());
+		CPPUNIT_ASSERT(result == expected);
+	}
+
+	void test_nearest()
+	{
+		const double points[][3] = { { 0.0, 0.0, 0.0 }, { 0.5, -0.3, 0.01 }, { 3.0, 3.0, 1.0 } };
+		for (const auto &p: points) {
+			std::vector<std::pair<double, uint64_t>> expected;
+			for (const auto &ss: m_galaxy->solar_systems) {
+				const double dx = ss.GetPosX() - p[0], dy = ss.GetPosY() - p[1],
+					dz = ss.GetPosZ() - p[2];
+				expected.push_back({ dx * dx + dy * dy + dz * dz, ss.GetId() });
+			}
+
+			std::sort(expected.begin(), expected.end());
+
+			std::vector<uint64_t> result;
+			m_galaxy->spatial_index.QueryNearest(p[0], p[1], p[2], 20, result);
+			CPPUNIT_ASSERT(result.size() == 20);
+			for (uint32_t i = 0; i < 20; ++i) {
+				CPPUNIT_ASSERT(result[i] == expected[i].second);
+			}
+		}
+	}
+
+	void test_updates()
+	{
+		engine::SolarSystemHandle ss = m_universe.CreateSolarSystem(m_galaxy);
+		const uint64_t id = ss.GetId();
+		CPPUNIT_ASSERT(m_galaxy->spatial_index.size() == 5001);
+
+		std::vector<uint64_t> result;
+		m_galaxy->spatial_index.QueryNearest(ss.GetPosX(), ss.GetPosY(), ss.GetPosZ(), 1,
+			result);
+		CPPUNIT_ASSERT(result.size() == 1 && result[0] == id);
+
+		CPPUNIT_ASSERT(m_universe.RemoveSolarSystem(id));
+		CPPUNIT_ASSERT(m_galaxy->spatial_index.size() == 5000);
+
+		result.clear();
+		m_galaxy->spatial_index.QueryRadius(0.0, 0.0, 0.0, 10.0, result);
+		CPPUNIT_ASSERT(result.size() == 5000);
+		CPPUNIT_ASSERT(std::find(result.begin(), result.end(), id) == result.end());
+	}
+
+	void test_non_finite()
+	{
+		const double nan = std::numeric_limits<double>::quiet_NaN(),
+			inf = std::numeric_limits<double>::infinity();
+
+		std::vector<uint64_t> result;
+		m_galaxy->spatial_index.QueryRadius(nan, 0.0, nan, 10.0, result);
+		CPPUNIT_ASSERT(result.empty());
+
+		m_galaxy->spatial_index.QueryRadius(inf, -inf, 0.0, 10.0, result);
+		CPPUNIT_ASSERT(result.empty());
+
+		// Clamped to the border cells, every system is still reachable
+		m_galaxy->spatial_index.QueryNearest(inf, 0.0, 0.0, 5, result);
+		CPPUNIT_ASSERT(result.size() == 5);
+	}
+
+private:
+	engine::Universe m_universe;
+	engine::Galaxy *m_galaxy = nullptr;
+};
+
+}
+}
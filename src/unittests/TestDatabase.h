@@ -0,0 +1,123 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <unordered_map>
+#include "../common/engine/databases/database-sqlite3.h"
+#include "../common/engine/space.h"
+
+namespace spacel {
+namespace unittests {
+
+/*
+ * Database keeping solar systems in memory, shared by the tests which don't need SQLite.
+ * Solar systems are loaded from the saved rows then from the source galaxy table, loads,
+ * saves and commits are counted and commits can be made to fail
+ */
+class TestDatabase: public engine::Database
+{
+public:
+	TestDatabase(const engine::Galaxy *source = nullptr): m_source(source) {}
+
+	void BeginTransaction() { m_transaction.clear(); }
+	void CommitTransaction()
+	{
+		if (fail_commits > 0) {
+			fail_commits--;
+			throw engine::SQLiteException("database is locked");
+		}
+
+		for (const auto &ss: m_transaction) {
+			rows[ss.first] = ss.second;
+		}
+		m_transaction.clear();
+		commits++;
+	}
+
+	void RollbackTransaction() { m_transaction.clear(); }
+	void CreateGalaxy(engine::Galaxy *galaxy) {}
+	engine::Galaxy *LoadGalaxy(const uint64_t &galaxy_id) { return nullptr; }
+	void CreateSolarSystem(const engine::Galaxy *galaxy, const engine::SolarSystemHandle &ss) {}
+	void CreateSolarSystems(const engine::Galaxy *galaxy, const uint32_t begin,
+		const uint32_t end, std::atomic<uint32_t> *progress = nullptr) {}
+	engine::SolarSystem *LoadSolarSystem(engine::Galaxy *galaxy, const uint64_t &ss_id)
+	{
+		return nullptr;
+	}
+
+	bool LoadSolarSystem(engine::Galaxy *galaxy, const uint64_t &ss_id,
+		engine::SolarSystem *ss)
+	{
+		uint32_t row;
+		auto it = rows.find(ss_id);
+		if (it != rows.end()) {
+			(*ss) = it->second;
+		} else if (m_source && m_source->solar_systems.Find(ss_id, row)) {
+			m_source->solar_systems[row].ToSolarSystem(ss);
+		} else {
+			return false;
+		}
+
+		loads++;
+		ss->galaxy = galaxy;
+		return true;
+	}
+
+	void SaveSolarSystem(const engine::SolarSystem &ss)
+	{
+		m_transaction[ss.id] = ss;
+		saves++;
+	}
+
+	void LoadSolarSystemsForGalaxy(engine::Galaxy *galaxy) {}
+	void LoadSolarSystemPositionsForGalaxy(engine::Galaxy *galaxy) {}
+	void CreateUniverse(const std::string &name, const uint64_t &seed) {}
+	const bool LoadUniverse(const std::string &name) { return true; }
+	void SetUniverseGenerated(const std::string &name, bool generated) {}
+	const bool IsUniverseGenerated(const std::string &name) { return true; }
+	void SetUniverseBackend(const std::string &name,
+		const engine::UniverseGeneratorBackend backend) {}
+	const engine::UniverseGeneratorBackend GetUniverseBackend(const std::string &name)
+	{
+		return engine::UNIVGEN_BACKEND_COUNTER;
+	}
+	void SetUniverseDerivedNames(const std::string &name, const bool derived_names) {}
+	const bool HasUniverseDerivedNames(const std::string &name) { return false; }
+
+	// Committed solar systems
+	std::unordered_map<uint64_t, engine::SolarSystem> rows;
+	uint32_t loads = 0;
+	uint32_t saves = 0;
+	uint32_t commits = 0;
+	uint32_t fail_commits = 0;
+
+private:
+	void Open() {}
+	void UpdateSchema() {}
+	bool Close() { return true; }
+	void CheckDatabase() {}
+
+	const engine::Galaxy *m_source;
+	std::unordered_map<uint64_t, engine::SolarSystem> m_transaction;
+};
+
+}
+}
@@ -26,6 +26,7 @@
 #include <cppunit/TestSuite.h>
 #include <cppunit/TestCase.h>
 
+#include <thread>
 #include "../common/time_utils.h"
 
 namespace spacel {
@@ -49,6 +50,12 @@ public:
 		suiteOfTests->addTest(new CppUnit::TestCaller<TimeUnitTest>("Test3 - Timestamp to string.",
 				&TimeUnitTest::test_timestampToString));
 
+		suiteOfTests->addTest(new CppUnit::TestCaller<TimeUnitTest>("Test4 - Tick scheduler notify.",
+				&TimeUnitTest::test_tickSchedulerNotify));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<TimeUnitTest>("Test5 - Tick scheduler catch-up.",
+				&TimeUnitTest::test_tickSchedulerCatchUp));
+
 		return suiteOfTests;
 	}
 
@@ -76,6 +83,42 @@ protected:
 		std::string ts_str = timestamp_to_string(1500000, false);
 		CPPUNIT_ASSERT(ts_str == "18/01/70 08:40");
 	}
+
+	void test_tickSchedulerNotify()
+	{
+		// 0 is clamped to one tick per second, the notification wakes up the thread before
+		TickScheduler scheduler(0);
+		CPPUNIT_ASSERT(scheduler.GetTickInterval() == 1.0f);
+
+		const auto start = std::chrono::steady_clock::now();
+		std::thread notifier([&scheduler] {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			scheduler.Notify();
+		});
+
+		CPPUNIT_ASSERT(scheduler.Wait() == 0);
+		CPPUNIT_ASSERT(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(900));
+		notifier.join();
+
+		// Notifications are not lost when nobody waits
+		scheduler.Notify();
+		CPPUNIT_ASSERT(scheduler.Wait() == 0);
+	}
+
+	void test_tickSchedulerCatchUp()
+	{
+		TickScheduler scheduler(100);
+		CPPUNIT_ASSERT(scheduler.Wait() == 1);
+
+		// Late ticks are run, up to the catch-up limit
+		std::this_thread::sleep_for(std::chrono::milliseconds(35));
+		const uint32_t ticks = scheduler.Wait();
+		CPPUNIT_ASSERT(ticks >= 3 && ticks <= TICK_SCHEDULER_MAX_CATCHUP_TICKS);
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		CPPUNIT_ASSERT(scheduler.Wait() == TICK_SCHEDULER_MAX_CATCHUP_TICKS);
+		CPPUNIT_ASSERT(scheduler.GetDroppedTicks() > 0);
+	}
 };
 
 }
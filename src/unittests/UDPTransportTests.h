@@ -0,0 +1,325 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "../common/engine/network/networkprotocol.h"
+#include "../common/engine/network/packetpool.h"
+#include "../common/engine/network/udptransport.h"
+
+namespace spacel {
+namespace unittests {
+
+class UDPTransportUnitTest : public CppUnit::TestFixture {
+private:
+public:
+	UDPTransportUnitTest() {}
+	virtual ~UDPTransportUnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("UDPTransport");
+		suiteOfTests->addTest(new CppUnit::TestCaller<UDPTransportUnitTest>("Test1 - Loopback clients.",
+				&UDPTransportUnitTest::test_loopback_clients));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<UDPTransportUnitTest>("Test2 - Big packets and expiration.",
+				&UDPTransportUnitTest::test_big_packets));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<UDPTransportUnitTest>("Test3 - Cookie challenge.",
+				&UDPTransportUnitTest::test_cookie_challenge));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp() {}
+
+	/// Teardown method
+	void tearDown() {}
+
+protected:
+	typedef std::vector<engine::network::NetworkPacket *> PacketList;
+
+	static engine::network::UDPTransport::PacketHandler collect(PacketList &received)
+	{
+		return [&received](engine::network::NetworkPacket *packet) {
+			received.push_back(packet);
+		};
+	}
+
+	// Poll until count packets are received, datagrams can't be lost on loopback
+	static void poll_until(engine::network::UDPTransport &transport, PacketList &received,
+		const size_t count)
+	{
+		for (uint32_t i = 0; i < 1000 && received.size() < count; i++) {
+			transport.Poll(10);
+		}
+	}
+
+	// Same, clients are polled to answer the server cookies
+	static void poll_until(engine::network::UDPTransport &transport, PacketList &received,
+		const size_t count, const std::vector<engine::network::UDPTransport *> &clients)
+	{
+		for (uint32_t i = 0; i < 1000 && received.size() < count; i++) {
+			transport.Poll(10);
+			for (engine::network::UDPTransport *client: clients) {
+				client->Poll(0);
+			}
+		}
+	}
+
+	static void release(PacketList &packets)
+	{
+		for (engine::network::NetworkPacket *packet: packets) {
+			engine::network::PacketPool::instance()->Release(packet);
+		}
+		packets.clear();
+	}
+
+	void test_loopback_clients()
+	{
+		static const uint32_t CLIENT_COUNT = 32, PACKETS_PER_CLIENT = 20;
+		PacketList server_received;
+		engine::network::UDPTransport server(collect(server_received));
+		CPPUNIT_ASSERT(server.Listen(0, true));
+		CPPUNIT_ASSERT(server.GetLocalPort() != 0);
+
+		std::vector<PacketList> client_received(CLIENT_COUNT);
+		std::vector<std::unique_ptr<engine::network::UDPTransport>> clients;
+		for (uint32_t c = 0; c < CLIENT_COUNT; c++) {
+			clients.emplace_back(new engine::network::UDPTransport(collect(client_received[c])));
+			CPPUNIT_ASSERT(clients[c]->Connect("127.0.0.1", server.GetLocalPort()));
+
+			engine::network::NetworkPacket *packets[PACKETS_PER_CLIENT];
+			for (uint32_t i = 0; i < PACKETS_PER_CLIENT; i++) {
+				packets[i] = engine::network::PacketPool::instance()->Acquire(
+					engine::network::CMSG_PLAYER_POSITION);
+				packets[i]->WriteUInt(c);
+				packets[i]->WriteUInt(i);
+			}
+
+			// Small packets share one datagram
+			CPPUNIT_ASSERT(clients[c]->Send(packets, PACKETS_PER_CLIENT) == 1);
+		}
+
+		std::vector<engine::network::UDPTransport *> client_list;
+		for (auto &client: clients) {
+			client_list.push_back(client.get());
+		}
+
+		// First datagrams are answered with a cookie, then sent again with it
+		poll_until(server, server_received, CLIENT_COUNT * PACKETS_PER_CLIENT, client_list);
+		CPPUNIT_ASSERT(server_received.size() == CLIENT_COUNT * PACKETS_PER_CLIENT);
+		CPPUNIT_ASSERT(server.GetSessionCount() == CLIENT_COUNT);
+		CPPUNIT_ASSERT(server.GetStats().challenges_sent == CLIENT_COUNT);
+		CPPUNIT_ASSERT(server.GetStats().datagrams_received == 2 * CLIENT_COUNT);
+		CPPUNIT_ASSERT(server.GetStats().recv_syscalls < CLIENT_COUNT);
+		for (engine::network::UDPTransport *client: client_list) {
+			CPPUNIT_ASSERT(client->HasCookie());
+		}
+
+		// Each client has its own session, packets of a datagram keep their order
+		std::vector<uint32_t> client_sessions(CLIENT_COUNT, 0);
+		std::vector<uint32_t> next_index(CLIENT_COUNT, 0);
+		for (engine::network::NetworkPacket *packet: server_received) {
+			CPPUNIT_ASSERT(packet->GetOpcode() == engine::network::CMSG_PLAYER_POSITION);
+			packet->Seek(2);
+			const uint32_t c = packet->ReadUInt();
+			CPPUNIT_ASSERT(c < CLIENT_COUNT && packet->ReadUInt() == next_index[c]++);
+			CPPUNIT_ASSERT(packet->IsEof());
+			CPPUNIT_ASSERT(client_sessions[c] == 0 ||
+				client_sessions[c] == packet->GetSessionId());
+			client_sessions[c] = packet->GetSessionId();
+		}
+		release(server_received);
+
+		// Answer every client in one call
+		std::vector<engine::network::NetworkPacket *> answers;
+		for (uint32_t c = 0; c < CLIENT_COUNT; c++) {
+			engine::network::NetworkPacket *packet =
+				engine::network::PacketPool::instance()->Acquire(engine::network::SMSG_CHAT);
+			packet->SetSessionId(client_sessions[c]);
+			packet->WriteUInt(c);
+			answers.push_back(packet);
+		}
+
+		const uint64_t send_syscalls = server.GetStats().send_syscalls;
+		CPPUNIT_ASSERT(server.Send(answers.data(), answers.size()) == CLIENT_COUNT);
+		CPPUNIT_ASSERT(server.GetStats().send_syscalls == send_syscalls + 1);
+		for (uint32_t c = 0; c < CLIENT_COUNT; c++) {
+			poll_until(*clients[c], client_received[c], 1);
+			CPPUNIT_ASSERT(client_received[c].size() == 1);
+			client_received[c][0]->Seek(2);
+			CPPUNIT_ASSERT(client_received[c][0]->GetOpcode() == engine::network::SMSG_CHAT);
+			CPPUNIT_ASSERT(client_received[c][0]->ReadUInt() == c);
+			release(client_received[c]);
+		}
+	}
+
+	void test_big_packets()
+	{
+		PacketList server_received, client_received;
+		engine::network::UDPTransport server(collect(server_received));
+		engine::network::UDPTransport client(collect(client_received));
+		CPPUNIT_ASSERT(server.Listen(0, true));
+		CPPUNIT_ASSERT(client.Connect("127.0.0.1", server.GetLocalPort()));
+
+		// Packets bigger than the coalescing size are sent alone, too big ones are dropped
+		engine::network::NetworkPacket *packets[4];
+		const uint32_t sizes[4] = { 8, 20000, 8, UDP_MAX_PACKET_SIZE + 1 };
+		for (uint32_t i = 0; i < 4; i++) {
+			packets[i] = engine::network::PacketPool::instance()->Acquire(
+				engine::network::SMSG_GALAXY_SYSTEMS);
+			const std::vector<uint8_t> payload(sizes[i] - 2, (uint8_t) i);
+			packets[i]->Write(payload.data(), payload.size());
+		}
+
+		CPPUNIT_ASSERT(client.Send(packets, 4) == 2);
+		CPPUNIT_ASSERT(client.GetStats().dropped == 1);
+		poll_until(server, server_received, 3, { &client });
+		CPPUNIT_ASSERT(server_received.size() == 3);
+		for (engine::network::NetworkPacket *packet: server_received) {
+			CPPUNIT_ASSERT(packet->GetSize() == 8 || packet->GetSize() == 20000);
+		}
+		release(server_received);
+
+		// The server is told about expired sessions
+		std::vector<uint32_t> closed_sessions;
+		server.SetSessionClosedHandler([&closed_sessions](const uint32_t session_id) {
+			closed_sessions.push_back(session_id);
+		});
+
+		CPPUNIT_ASSERT(server.GetSessionCount() == 1);
+		CPPUNIT_ASSERT(server.ExpireSessions(std::chrono::hours(1)) == 0);
+		CPPUNIT_ASSERT(closed_sessions.empty());
+		CPPUNIT_ASSERT(server.ExpireSessions(std::chrono::seconds(-1)) == 1);
+		CPPUNIT_ASSERT(server.GetSessionCount() == 0);
+		CPPUNIT_ASSERT(closed_sessions.size() == 1 && closed_sessions[0] == 1);
+
+		// Packets to expired sessions are dropped
+		engine::network::NetworkPacket *packet =
+			engine::network::PacketPool::instance()->Acquire(engine::network::SMSG_CHAT);
+		packet->SetSessionId(1);
+		CPPUNIT_ASSERT(server.Send(&packet, 1) == 0);
+		CPPUNIT_ASSERT(server.GetStats().dropped == 1);
+	}
+
+	// Raw datagram socket, sends whatever it is given to the server
+	static int open_raw_socket(const uint16_t port, sockaddr_in &server_address)
+	{
+		const int raw_socket = socket(AF_INET, SOCK_DGRAM, 0);
+		memset(&server_address, 0, sizeof(server_address));
+		server_address.sin_family = AF_INET;
+		server_address.sin_port = htons(port);
+		server_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		timeval timeout = { 0, 200000 };
+		setsockopt(raw_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		return raw_socket;
+	}
+
+	// Datagram of empty chat packets, the cookie follows the header of cookie datagrams
+	static std::vector<uint8_t> make_datagram(const uint16_t magic, const uint64_t cookie,
+		const uint32_t packet_count)
+	{
+		std::vector<uint8_t> datagram(UDP_DATAGRAM_HEADER_SIZE);
+		memcpy(datagram.data(), &magic, sizeof(magic));
+		if (magic == UDP_COOKIE_DATAGRAM_MAGIC) {
+			datagram.resize(UDP_DATAGRAM_HEADER_SIZE + UDP_COOKIE_SIZE);
+			memcpy(datagram.data() + UDP_DATAGRAM_HEADER_SIZE, &cookie, sizeof(cookie));
+		}
+
+		const uint16_t frame_size = 2, opcode = engine::network::CMSG_CHAT;
+		for (uint32_t i = 0; i < packet_count; i++) {
+			datagram.resize(datagram.size() + 4);
+			memcpy(datagram.data() + datagram.size() - 4, &frame_size, sizeof(frame_size));
+			memcpy(datagram.data() + datagram.size() - 2, &opcode, sizeof(opcode));
+		}
+
+		return datagram;
+	}
+
+	void test_cookie_challenge()
+	{
+		PacketList server_received;
+		engine::network::UDPTransport server(collect(server_received));
+		CPPUNIT_ASSERT(server.Listen(0, true));
+
+		sockaddr_in server_address;
+		const int raw_socket = open_raw_socket(server.GetLocalPort(), server_address);
+		auto send_raw = [&](const std::vector<uint8_t> &datagram) {
+			sendto(raw_socket, datagram.data(), datagram.size(), 0,
+				(const sockaddr *) &server_address, sizeof(server_address));
+			server.Poll(100);
+		};
+
+		// Datagrams smaller than the cookie answer are ignored
+		send_raw(make_datagram(UDP_DATAGRAM_MAGIC, 0, 1));
+		CPPUNIT_ASSERT(server.GetStats().challenges_sent == 0);
+
+		// Unknown addresses get a cookie, no session and no packet
+		send_raw(make_datagram(UDP_DATAGRAM_MAGIC, 0, 2));
+		CPPUNIT_ASSERT(server.GetStats().challenges_sent == 1);
+		send_raw(make_datagram(UDP_COOKIE_DATAGRAM_MAGIC, 1234, 1));
+		CPPUNIT_ASSERT(server.GetStats().challenges_sent == 2);
+		CPPUNIT_ASSERT(server.GetSessionCount() == 0);
+		CPPUNIT_ASSERT(server_received.empty());
+
+		uint8_t answer[64];
+		uint64_t cookies[2];
+		for (uint64_t &cookie: cookies) {
+			const ssize_t answer_size = recv(raw_socket, answer, sizeof(answer), 0);
+			CPPUNIT_ASSERT(answer_size == UDP_DATAGRAM_HEADER_SIZE + UDP_COOKIE_SIZE);
+			uint16_t answer_magic;
+			memcpy(&answer_magic, answer, sizeof(answer_magic));
+			CPPUNIT_ASSERT(answer_magic == UDP_CHALLENGE_MAGIC);
+			memcpy(&cookie, answer + UDP_DATAGRAM_HEADER_SIZE, sizeof(cookie));
+		}
+
+		// The cookie only depends on the address and the time
+		CPPUNIT_ASSERT(cookies[0] == cookies[1]);
+		send_raw(make_datagram(UDP_COOKIE_DATAGRAM_MAGIC, cookies[0], 1));
+		CPPUNIT_ASSERT(server.GetSessionCount() == 1);
+		CPPUNIT_ASSERT(server_received.size() == 1);
+		CPPUNIT_ASSERT(server_received[0]->GetOpcode() == engine::network::CMSG_CHAT);
+		release(server_received);
+
+		// Known sessions don't need the cookie anymore
+		send_raw(make_datagram(UDP_DATAGRAM_MAGIC, 0, 1));
+		CPPUNIT_ASSERT(server_received.size() == 1);
+		CPPUNIT_ASSERT(server.GetStats().challenges_sent == 2);
+		release(server_received);
+		close(raw_socket);
+	}
+};
+
+}
+}
@@ -0,0 +1,194 @@
+/*
+ * This file is part of Spacel game.
+ *
+ * Copyright 2016, Loic Blot <loic.blot@unix-experience.fr>
+ *
+ * Spacel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Spacel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Spacel.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCase.h>
+
+#include "../common/engine/generators.h"
+#include "../common/engine/space.h"
+
+namespace spacel {
+namespace unittests {
+
+class UniverseUnitTest : public CppUnit::TestFixture {
+private:
+public:
+	UniverseUnitTest() {}
+	virtual ~UniverseUnitTest() {}
+
+	static CppUnit::Test *suite()
+	{
+		CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("Universe");
+		suiteOfTests->addTest(new CppUnit::TestCaller<UniverseUnitTest>("Test1 - Create Galaxy.",
+				&UniverseUnitTest::test_create_galaxy));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<UniverseUnitTest>("Test2 - Parallel Galaxy Generation.",
+				&UniverseUnitTest::test_create_galaxy_parallel));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<UniverseUnitTest>("Test3 - Solar System Table.",
+				&UniverseUnitTest::test_solarsystem_table));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<UniverseUnitTest>("Test4 - Galaxy Arena.",
+				&UniverseUnitTest::test_galaxy_arena));
+
+		suiteOfTests->addTest(new CppUnit::TestCaller<UniverseUnitTest>("Test5 - Derived Names.",
+				&UniverseUnitTest::test_derived_names));
+
+		return suiteOfTests;
+	}
+
+	/// Setup method
+	void setUp() {}
+
+	/// Teardown method
+	void tearDown() {}
+
+protected:
+	void test_create_galaxy()
+	{
+		engine::UniverseGenerator::SetSeed(180);
+		engine::Universe universe;
+		engine::Galaxy *galaxy = universe.CreateGalaxy(1000);
+		CPPUNIT_ASSERT(galaxy);
+		CPPUNIT_ASSERT(galaxy->solar_systems.size() == 1000);
+		CPPUNIT_ASSERT(universe.GetGalaxy(galaxy->id) == galaxy);
+	}
+
+	void test_create_galaxy_parallel()
+	{
+		engine::UniverseGenerator::SetSeed(180);
+		engine::Universe universe_seq, universe_par;
+		engine::Galaxy *galaxy_seq = universe_seq.CreateGalaxy(5000, 1);
+		engine::Galaxy *galaxy_par = universe_par.CreateGalaxy(5000, 7);
+
+		CPPUNIT_ASSERT(galaxy_seq->name == galaxy_par->name);
+		CPPUNIT_ASSERT(galaxy_seq->solar_systems.size() == galaxy_par->solar_systems.size());
+		for (const auto &ss: galaxy_seq->solar_systems) {
+			uint32_t row;
+			CPPUNIT_ASSERT(galaxy_par->solar_systems.Find(ss.GetId(), row));
+
+			const engine::SolarSystemHandle ss_par = galaxy_par->solar_systems[row];
+			CPPUNIT_ASSERT(ss.GetName() == ss_par.GetName());
+			CPPUNIT_ASSERT(ss.GetType() == ss_par.GetType());
+			CPPUNIT_ASSERT(ss.GetRadius() == ss_par.GetRadius());
+			CPPUNIT_ASSERT(ss.GetPosX() == ss_par.GetPosX());
+			CPPUNIT_ASSERT(ss.GetPosY() == ss_par.GetPosY());
+			CPPUNIT_ASSERT(ss.GetPosZ() == ss_par.GetPosZ());
+		}
+	}
+
+	void test_solarsystem_table()
+	{
+		engine::SolarSystemTable table;
+		for (uint64_t id = 1; id <= 100; ++id) {
+			const uint32_t row = table.Add(id);
+			table.Set(row, engine::SOLAR_TYPE_CLASSIC, id, id, id * 2, id * 3);
+			table.SetName(row, "system " + std::to_string(id));
+		}
+
+		CPPUNIT_ASSERT(table.size() == 100);
+		CPPUNIT_ASSERT(!table.Remove(1000));
+
+		// Removing a row moves the last one in its place, ids must still be found
+		for (uint64_t id = 1; id <= 80; ++id) {
+			CPPUNIT_ASSERT(table.Remove(id));
+		}
+
+		CPPUNIT_ASSERT(table.size() == 20);
+		for (uint64_t id = 1; id <= 100; ++id) {
+			uint32_t row;
+			CPPUNIT_ASSERT(table.Find(id, row) == (id > 80));
+			if (id <= 80) {
+				continue;
+			}
+
+			const engine::SolarSystemHandle ss = table[row];
+			CPPUNIT_ASSERT(ss.GetId() == id);
+			CPPUNIT_ASSERT(ss.GetRadius() == id);
+			CPPUNIT_ASSERT(ss.GetPosZ() == id * 3);
+			CPPUNIT_ASSERT(ss.GetName() == "system " + std::to_string(id));
+		}
+
+		uint32_t count = 0;
+		for (const auto &ss: table) {
+			CPPUNIT_ASSERT(ss.GetId() > 80);
+			count++;
+		}
+		CPPUNIT_ASSERT(count == 20);
+	}
+
+	void test_galaxy_arena()
+	{
+		engine::UniverseGenerator::SetSeed(180);
+		engine::Universe universe;
+		engine::Galaxy *galaxy = universe.CreateGalaxy(100);
+
+		for (uint32_t row = 0; row < galaxy->solar_systems.size(); ++row) {
+			engine::SolarSystem *ss = galaxy->CreateSolarSystemObject(row);
+			CPPUNIT_ASSERT(ss->id == galaxy->solar_systems[row].GetId());
+			CPPUNIT_ASSERT(ss->name == galaxy->solar_systems[row].GetName());
+			CPPUNIT_ASSERT(ss->galaxy == galaxy);
+
+			universe.CreateSolarSystemPhase2(galaxy, ss);
+			for (const engine::Planet *planet: ss->planets) {
+				CPPUNIT_ASSERT(planet->type < engine::PLANET_TYPE_MAX);
+				CPPUNIT_ASSERT(((uintptr_t) planet % alignof(engine::Planet)) == 0);
+			}
+		}
+
+		CPPUNIT_ASSERT(galaxy->arena.GetAllocatedSize() > 0);
+
+		const uint64_t galaxy_id = galaxy->id;
+		CPPUNIT_ASSERT(universe.RemoveGalaxy(galaxy_id));
+		CPPUNIT_ASSERT(universe.GetGalaxy(galaxy_id) == nullptr);
+		CPPUNIT_ASSERT(!universe.RemoveGalaxy(galaxy_id));
+	}
+
+	void test_derived_names()
+	{
+		engine::UniverseGenerator::SetSeed(180);
+		engine::Universe stored_universe, derived_universe;
+		derived_universe.SetDerivedNames(true);
+		const engine::Galaxy *stored = stored_universe.CreateGalaxy(500, 2);
+		const engine::Galaxy *derived = derived_universe.CreateGalaxy(500, 4);
+
+		// Names only depend on the seed and the id, not on the generation order
+		for (uint32_t row = derived->solar_systems.size(); row-- > 0;) {
+			const engine::SolarSystemHandle ss = derived->solar_systems[row];
+			CPPUNIT_ASSERT(ss.GetStoredName().empty());
+			CPPUNIT_ASSERT(ss.GetName() == stored->solar_systems[row].GetName());
+			CPPUNIT_ASSERT(ss.GetName() == engine::UnivGen->generate_solarsystem_name(ss.GetId()));
+			CPPUNIT_ASSERT(!ss.GetName().empty());
+		}
+
+		engine::SolarSystem ss;
+		derived->solar_systems[42].ToSolarSystem(&ss);
+		CPPUNIT_ASSERT(ss.name == stored->solar_systems[42].GetName());
+	}
+};
+
+}
+}
+
@@ -7,9 +7,28 @@
 #include "TimeTests.h"
 #include "GeneratorsTests.h"
 #include "UIEventTests.h"
+#include "UniverseTests.h"
+#include "SolarSystemCacheTests.h"
+#include "DatabaseSQLite3Tests.h"
+#include "DatabaseWriterTests.h"
+#include "DatabaseReadPoolTests.h"
+#include "SpatialIndexTests.h"
+#include "GalaxyInterestTests.h"
+#include "QueueTests.h"
+#include "NetworkPacketTests.h"
+#include "PacketPoolTests.h"
+#include "PacketSchedulerTests.h"
+#include "UDPTransportTests.h"
+#include "JobSystemTests.h"
+#include "ShardTests.h"
+#include "ProfilerTests.h"
+#include "OpcodeMetricsTests.h"
 
+spacel::engine::Universe *spacel::engine::Universe::s_universe = nullptr;
 spacel::engine::UniverseGenerator *spacel::engine::UniverseGenerator::s_univgen = nullptr;
 uint64_t spacel::engine::UniverseGenerator::s_seed = 0;
+spacel::engine::UniverseGeneratorBackend spacel::engine::UniverseGenerator::s_backend =
+	spacel::engine::UNIVGEN_BACKEND_COUNTER;
 
 int main() {
 	CppUnit::TextUi::TestRunner runner;
@@ -19,6 +38,22 @@ int main() {
 	runner.addTest(spacel::unittests::SettingsTest::suite());
 	runner.addTest(spacel::unittests::GeneratorsUnitTest::suite());
 	runner.addTest(spacel::unittests::UIEventUnitTest::suite());
+	runner.addTest(spacel::unittests::UniverseUnitTest::suite());
+	runner.addTest(spacel::unittests::SolarSystemCacheUnitTest::suite());
+	runner.addTest(spacel::unittests::DatabaseSQLite3UnitTest::suite());
+	runner.addTest(spacel::unittests::DatabaseWriterUnitTest::suite());
+	runner.addTest(spacel::unittests::DatabaseReadPoolUnitTest::suite());
+	runner.addTest(spacel::unittests::SpatialIndexUnitTest::suite());
+	runner.addTest(spacel::unittests::GalaxyInterestUnitTest::suite());
+	runner.addTest(spacel::unittests::QueueUnitTest::suite());
+	runner.addTest(spacel::unittests::NetworkPacketUnitTest::suite());
+	runner.addTest(spacel::unittests::PacketPoolUnitTest::suite());
+	runner.addTest(spacel::unittests::PacketSchedulerUnitTest::suite());
+	runner.addTest(spacel::unittests::UDPTransportUnitTest::suite());
+	runner.addTest(spacel::unittests::JobSystemUnitTest::suite());
+	runner.addTest(spacel::unittests::ShardUnitTest::suite());
+	runner.addTest(spacel::unittests::ProfilerUnitTest::suite());
+	runner.addTest(spacel::unittests::OpcodeMetricsUnitTest::suite());
 	std::cout << "Running the unit tests." << std::endl;
 	return runner.run() ? 0 : 1;
 }